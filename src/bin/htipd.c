@@ -0,0 +1,395 @@
+/**
+ * @file htipd.c
+ * @brief A collector of HTIP frames.
+ *
+ * htipd is a deamon that receives HTIP frames sent by l2agent, l2switch and
+ * other HTIP devices, and keeps a neighbor database of them.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <err.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "datalink.h"
+#include "neighbor.h"
+#include "rxcache.h"
+#include "rxring.h"
+#include "timer.h"
+#include "tlv.h"
+#include "topology.h"
+
+/** A default interval to print neighbors in seconds */
+#define HTIPD_DEFAULT_PRINT_INTERVAL 10
+/** An interval to expire neighbors in milliseconds */
+#define HTIPD_EXPIRE_INTERVAL 1000
+/** The max number of frames read at once, so expiring isn't starved by a flood */
+#define HTIPD_MAX_READ_FRAMES 256
+/** The max number of receiving threads */
+#define HTIPD_MAX_RECEIVERS 16
+/** A number of records of a ring from receiving threads */
+#define HTIPD_RING_SIZE 1024
+/** An interval to read a ring from receiving threads in milliseconds */
+#define HTIPD_RING_INTERVAL 10
+/** A timeout of poll() of a receiving thread, it sees a stop after that in milliseconds */
+#define HTIPD_RECEIVER_POLL_TIMEOUT 100
+
+/** Set by a signal to leave the main loop */
+static volatile sig_atomic_t stopped = 0;
+
+/**
+ * @brief A receiving thread, it decodes frames and passes them to the main thread by a ring.
+ */
+struct htipd_receiver {
+        /** A thread */
+        pthread_t thread;
+        /** A socket shared by receiving threads */
+        int sock;
+        /** A ring to the main thread */
+        struct rxring *ring;
+        /** A cache of the last frames received by the thread */
+        struct rxcache *cache;
+        /** 1 if the thread was started */
+        int started;
+};
+
+void usage(char *argv0)
+{
+        printf("Usage: %s [-i {network_interface_name}] [-p {print_interval}] [-r {receivers}] [-t] [-v]\n"
+               "  network_interface_name: receive frames only on it (default: all network interfaces)\n"
+               "  print_interval: seconds between printing neighbors, 0 to disable it (default: %d)\n"
+               "  receivers: threads receiving and decoding frames, 0 to do it in the main thread (default: 0, max: %d)\n"
+               "  -t: print an estimated topology with neighbors\n"
+               "  -v: print received frames\n",
+               argv0, HTIPD_DEFAULT_PRINT_INTERVAL, HTIPD_MAX_RECEIVERS);
+}
+
+void signal_handler(int sig)
+{
+        (void) sig;
+
+        stopped = 1;
+}
+
+#ifdef __linux__
+/**
+ * @brief Update neighbors by frames on a socket.
+ */
+static void read_socket(int sock, struct neighbor_db *db, struct rxcache *cache, int verbose)
+{
+        static struct htip_lldpdu du;
+        static u_char buf[ETHER_MAX_LEN];
+        const struct rxcache_entry *e;
+        u_int32_t crc;
+        u_int64_t now;
+        int i, n, ifindex;
+
+        for (i = 0; i < HTIPD_MAX_READ_FRAMES && (n = read_frame(sock, buf, sizeof(buf), &ifindex)) > 0; i++) {
+                if (n < ETHER_HDR_LEN)
+                        continue;
+
+                /* a frame same as the last one from its source only extends the TTL */
+                now = get_monotonic_msec();
+                if ((e = find_rxcache(cache, buf, n, ifindex, now, &crc)) != NULL &&
+                    refresh_neighbor(db, buf + ETHER_HDR_LEN + e->chassis_id_off, e->chassis_id_len,
+                        buf + ETHER_HDR_LEN + e->port_id_off, e->port_id_len, e->ttl, crc, now) == 0)
+                        continue;
+
+                if (decode_htip_lldpdu(buf + ETHER_HDR_LEN, n - ETHER_HDR_LEN, &du) < 0) {
+                        if (verbose)
+                                fprintf(stderr, "malformed LLDPDU, len: %d\n", n);
+                        continue;
+                }
+                if (verbose)
+                        print_tlvs((char *) buf + ETHER_HDR_LEN, n - ETHER_HDR_LEN);
+                if (update_neighbor(db, &du, crc, now) < 0)
+                        fprintf(stderr, "update_neighbor() failed.\n");
+                else if (store_rxcache(cache, buf, n, ifindex, crc, &du, now) < 0)
+                        fprintf(stderr, "store_rxcache() failed.\n");
+        }
+}
+
+/**
+ * @brief A main loop of a receiving thread.
+ * @param p A pointer to a receiver.
+ * @return NULL
+ */
+static void *run_receiver(void *p)
+{
+        struct htipd_receiver *rx = p;
+        struct rxring_record *rec;
+        const struct rxcache_entry *e;
+        struct pollfd pfd;
+        u_char buf[ETHER_MAX_LEN];
+        u_int32_t crc;
+        u_int64_t now, next_expire = 0;
+        int n, ifindex;
+
+        pfd.fd = rx->sock;
+        pfd.events = POLLIN;
+
+        while (!stopped) {
+                if (poll(&pfd, 1, HTIPD_RECEIVER_POLL_TIMEOUT) < 0 && errno != EINTR) {
+                        perror("poll");
+                        break;
+                }
+
+                while ((n = read_frame(rx->sock, buf, sizeof(buf), &ifindex)) > 0) {
+                        if (n < ETHER_HDR_LEN)
+                                continue;
+
+                        now = get_monotonic_msec();
+                        e = find_rxcache(rx->cache, buf, n, ifindex, now, &crc);
+
+                        /* a full ring drops the frame and counts it, the thread never waits */
+                        if ((rec = claim_rxring(rx->ring)) == NULL)
+                                continue;
+
+                        if (e != NULL) {
+                                /* the main thread only extends the TTL by IDs in the frame */
+                                fill_rxring_record(rec, buf, n, ifindex, now, 0);
+                                rec->du.chassis_id = rec->frame + ETHER_HDR_LEN + e->chassis_id_off;
+                                rec->du.chassis_id_len = e->chassis_id_len;
+                                rec->du.port_id = rec->frame + ETHER_HDR_LEN + e->port_id_off;
+                                rec->du.port_id_len = e->port_id_len;
+                                rec->du.ttl = e->ttl;
+                        } else if (fill_rxring_record(rec, buf, n, ifindex, now, 1) == 0 &&
+                                   store_rxcache(rx->cache, rec->frame, rec->len, ifindex, crc, &rec->du, now) < 0) {
+                                fprintf(stderr, "store_rxcache() failed.\n");
+                        }
+                        /* caches are per thread, so the database tells whether the frame is its last one */
+                        rec->crc = crc;
+                        publish_rxring(rx->ring, rec);
+                }
+
+                now = get_monotonic_msec();
+                if (now >= next_expire) {
+                        expire_rxcache(rx->cache, now);
+                        next_expire = now + HTIPD_EXPIRE_INTERVAL;
+                }
+        }
+
+        return NULL;
+}
+
+/**
+ * @brief Update neighbors by frames from receiving threads.
+ */
+static void read_receivers(struct rxring *ring, struct neighbor_db *db, int verbose)
+{
+        struct rxring_record *records[HTIPD_MAX_READ_FRAMES], *rec;
+        int i, n, total = 0;
+
+        do {
+                n = read_rxring(ring, records, HTIPD_MAX_READ_FRAMES);
+                for (i = 0; i < n; i++) {
+                        rec = records[i];
+                        if (rec->status == RXRING_RECORD_RAW) {
+                                if (refresh_neighbor(db, rec->du.chassis_id, rec->du.chassis_id_len,
+                                        rec->du.port_id, rec->du.port_id_len, rec->du.ttl, rec->crc, rec->time) == 0)
+                                        continue;
+                                /* the neighbor is gone or changed since, the frame is decoded here */
+                                if (decode_htip_lldpdu(rec->frame + ETHER_HDR_LEN, rec->len - ETHER_HDR_LEN, &rec->du) < 0)
+                                        continue;
+                        }
+                        if (verbose)
+                                print_tlvs((char *) rec->frame + ETHER_HDR_LEN, rec->len - ETHER_HDR_LEN);
+                        if (update_neighbor(db, &rec->du, rec->crc, rec->time) < 0)
+                                fprintf(stderr, "update_neighbor() failed.\n");
+                }
+                release_rxring(ring);
+                total += n;
+        } while (n > 0 && total < HTIPD_RING_SIZE);
+}
+#endif /* __linux__ */
+
+int main(int argc, char **argv)
+{
+        char *argv0, *ifname = NULL;
+        int c, i, timeout, sock = -1, verbose = 0, topology = 0, print_interval = HTIPD_DEFAULT_PRINT_INTERVAL;
+        int receiver_num = 0, ret = EXIT_FAILURE;
+        u_int64_t now, next_expire, next_print;
+        struct pollfd pfd;
+        struct neighbor_db *db = NULL;
+        struct rxcache *cache = NULL;
+        struct rxring *ring = NULL;
+        struct rxring_stats stats;
+        struct htipd_receiver receivers[HTIPD_MAX_RECEIVERS];
+        struct topology *t = NULL;
+
+        argv0 = argv[0];
+        memset(receivers, 0, sizeof(receivers));
+
+        while ((c = getopt(argc, argv, "i:p:r:tv")) != -1) {
+                switch (c) {
+                case 'i':
+                        ifname = optarg;
+                        break;
+                case 'p':
+                        if ((print_interval = atoi(optarg)) < 0) {
+                                usage(argv0);
+                                exit(EXIT_FAILURE);
+                        }
+                        break;
+                case 'r':
+                        if ((receiver_num = atoi(optarg)) < 0 || receiver_num > HTIPD_MAX_RECEIVERS) {
+                                usage(argv0);
+                                exit(EXIT_FAILURE);
+                        }
+                        break;
+                case 't':
+                        topology = 1;
+                        break;
+                case 'v':
+                        verbose = 1;
+                        break;
+                case '?':
+                default:
+                        usage(argv0);
+                        exit(EXIT_SUCCESS);
+                }
+        }
+
+        argc -= optind;
+        argv += optind;
+
+        if (argc != 0) {
+                usage(argv0);
+                err(EXIT_FAILURE, "main");
+        }
+
+#ifdef __linux__
+        if (signal(SIGINT, signal_handler) == SIG_ERR || signal(SIGTERM, signal_handler) == SIG_ERR) {
+                perror("signal");
+                goto finalize;
+        }
+
+        if ((db = alloc_neighbor_db()) == NULL) {
+                fprintf(stderr, "alloc_neighbor_db() failed.\n");
+                goto finalize;
+        }
+
+        if ((cache = alloc_rxcache()) == NULL) {
+                fprintf(stderr, "alloc_rxcache() failed.\n");
+                goto finalize;
+        }
+
+        if (topology && (t = alloc_topology(db)) == NULL) {
+                fprintf(stderr, "alloc_topology() failed.\n");
+                goto finalize;
+        }
+
+        if ((sock = open_lldp_socket(ifname)) < 0) {
+                fprintf(stderr, "open_lldp_socket() failed.\n");
+                goto finalize;
+        }
+
+        /* receiving threads share the socket, each frame is read by one of them */
+        if (receiver_num > 0) {
+                if ((ring = alloc_rxring(HTIPD_RING_SIZE)) == NULL) {
+                        fprintf(stderr, "alloc_rxring() failed.\n");
+                        goto finalize;
+                }
+                for (i = 0; i < receiver_num; i++) {
+                        receivers[i].sock = sock;
+                        receivers[i].ring = ring;
+                        if ((receivers[i].cache = alloc_rxcache()) == NULL) {
+                                fprintf(stderr, "alloc_rxcache() failed.\n");
+                                goto finalize;
+                        }
+                        if ((errno = pthread_create(&receivers[i].thread, NULL, run_receiver, receivers + i)) != 0) {
+                                perror("pthread_create");
+                                goto finalize;
+                        }
+                        receivers[i].started = 1;
+                }
+        }
+
+        pfd.fd = sock;
+        pfd.events = POLLIN;
+
+        now = get_monotonic_msec();
+        next_expire = now + HTIPD_EXPIRE_INTERVAL;
+        next_print = now + (u_int64_t) print_interval * 1000;
+
+        /* main loop: update neighbors by received frames, and expire them every second */
+        while (!stopped) {
+                now = get_monotonic_msec();
+                timeout = next_expire > now ? (int) (next_expire - now) : 0;
+
+                if (ring != NULL) {
+                        poll(NULL, 0, timeout < HTIPD_RING_INTERVAL ? timeout : HTIPD_RING_INTERVAL);
+                        read_receivers(ring, db, verbose);
+                } else {
+                        if (poll(&pfd, 1, timeout) < 0 && !stopped) {
+                                perror("poll");
+                                continue;
+                        }
+                        read_socket(sock, db, cache, verbose);
+                }
+
+                now = get_monotonic_msec();
+                if (now >= next_expire) {
+                        expire_neighbor(db, now);
+                        expire_rxcache(cache, now);
+                        next_expire = now + HTIPD_EXPIRE_INTERVAL;
+                }
+
+                if (print_interval > 0 && now >= next_print) {
+                        print_neighbor_db(db, now);
+                        if (verbose)
+                                printf("neighbor database: %llu bytes\n", (unsigned long long) get_neighbor_db_bytes(db));
+                        if (verbose && ring != NULL) {
+                                get_rxring_stats(ring, &stats);
+                                printf("frames from receivers: %llu, dropped: %llu, malformed: %llu\n",
+                                        (unsigned long long) stats.written, (unsigned long long) stats.dropped,
+                                        (unsigned long long) stats.malformed);
+                        } else if (verbose) {
+                                printf("duplicate frames: %llu, other frames: %llu\n",
+                                        (unsigned long long) cache->hits, (unsigned long long) cache->misses);
+                        }
+                        if (t != NULL)
+                                print_topology(t);
+                        next_print = now + (u_int64_t) print_interval * 1000;
+                }
+        }
+
+        ret = EXIT_SUCCESS;
+#else
+        fprintf(stderr, "htipd is only supported on Linux.\n");
+        goto finalize;
+#endif /* __linux__ */
+
+finalize:
+        stopped = 1;
+        for (i = 0; i < receiver_num; i++) {
+                if (receivers[i].started)
+                        pthread_join(receivers[i].thread, NULL);
+                free_rxcache(receivers[i].cache);
+        }
+
+        if (sock >= 0)
+                close(sock);
+
+        free_rxring(ring);
+        free_topology(t);
+        free_rxcache(cache);
+        free_neighbor_db(db);
+
+        return ret;
+}
@@ -36,13 +36,23 @@
 #include "binary.h"
 #include "datalink.h"
 #include "fdb.h"
+#include "iffilter.h"
 #include "ifinfo.h"
 #include "tlv.h"
 #include "htip.h"
+#include "timer.h"
+#include "txsched.h"
 
 void usage(char *argv0)
 {
-        printf("Usage: %s -i {network_interface_name}\n", argv0);
+        printf("Usage: %s [-a] [-f [+|-]{field}={value}[,...]]... [-r {frames_per_second}] [-n {fast_frames}] [-m {max_interval}]\n"
+               "  -a: advertise MAC addresses of all network interfaces\n"
+               "  field: name (glob), kind, master, operstate\n"
+               "  frames_per_second: a cap of sent frames, 0 for no cap (default: %d)\n"
+               "  fast_frames: frames sent every second after startup or link-up, 0 to %d (default: %d)\n"
+               "  max_interval: seconds an interval is stretched to while nothing changes, %d disables it (default: %d)\n",
+               argv0, TXSCHED_DEFAULT_RATE, TXSCHED_MAX_FAST_COUNT, TXSCHED_DEFAULT_FAST_COUNT,
+               TXSCHED_DEFAULT_INTERVAL / 1000, TXSCHED_DEFAULT_MAX_INTERVAL / 1000);
 }
 
 void signal_handler(int sig)
@@ -53,6 +63,8 @@ void signal_handler(int sig)
 
         free_ifinfo_list();
 
+        free_iffilter();
+
         exit(EXIT_SUCCESS);
 }
 
@@ -94,7 +106,12 @@ u_char *get_model_number() {
 
 int main(int argc, char **argv) {
         char *argv0;
-        int c;
+        int c, i, n, monfd = -1, rate = TXSCHED_DEFAULT_RATE;
+        int fast = TXSCHED_DEFAULT_FAST_COUNT, sec, mac_list = 0;
+        u_int64_t now, deadline, wait, interval, max_interval = TXSCHED_DEFAULT_MAX_INTERVAL;
+        struct ifinfo *ifip;
+        struct txsched sched;
+        struct htip_ctx ctx;
         /** HTIP device category, 0 ~ 255 bytes */
         u_char *device_category = get_device_category();
         /** HTIP manufacturer code, 6 bytes */
@@ -106,10 +123,39 @@ int main(int argc, char **argv) {
 
         argv0 = argv[0];
 
-        while ((c = getopt(argc, argv, "i:l:")) != -1) {
+        while ((c = getopt(argc, argv, "af:i:l:m:n:r:")) != -1) {
                 switch (c) {
+                case 'a':
+                        mac_list = 1;
+                        break;
+                case 'f':
+                        if (add_iffilter_rule(optarg) < 0) {
+                                usage(argv0);
+                                exit(EXIT_FAILURE);
+                        }
+                        break;
                 case 'i':
                         break;
+                case 'm':
+                        sec = atoi(optarg);
+                        if (sec < TXSCHED_DEFAULT_INTERVAL / 1000 || sec > TTL_MAX / TTL_INTERVAL_MULTIPLIER) {
+                                usage(argv0);
+                                exit(EXIT_FAILURE);
+                        }
+                        max_interval = (u_int64_t) sec * 1000;
+                        break;
+                case 'n':
+                        if ((fast = atoi(optarg)) < 0 || fast > TXSCHED_MAX_FAST_COUNT) {
+                                usage(argv0);
+                                exit(EXIT_FAILURE);
+                        }
+                        break;
+                case 'r':
+                        if ((rate = atoi(optarg)) < 0) {
+                                usage(argv0);
+                                exit(EXIT_FAILURE);
+                        }
+                        break;
                 case '?':
                 default:
                         usage(argv0);
@@ -134,6 +180,9 @@ int main(int argc, char **argv) {
 	printf("model_name: %s\n", model_name);
 	printf("model_number: %s\n", model_number);
 
+        if (get_iffilter_rule_num() > 0)
+                print_iffilter();
+
         /* store network interface information */
         if (read_ifinfo() < 0) {
                 fprintf(stderr, "read_ifinfo() failed\n");
@@ -155,25 +204,126 @@ int main(int argc, char **argv) {
         /* check stored network interface list */
         print_ifinfo();
 
-        /* main loop: send HTIP frame every 30 seconds */
+        /* watch network interfaces to advertise new or changed ones at once */
+        if ((monfd = open_ifinfo_monitor()) < 0)
+                fprintf(stderr, "open_ifinfo_monitor() failed, network interface changes are ignored.\n");
+
+        if (init_txsched(&sched, TXSCHED_DEFAULT_INTERVAL, TXSCHED_DEFAULT_JITTER,
+                rate, TXSCHED_DEFAULT_BURST) < 0) {
+                fprintf(stderr, "init_txsched() failed.\n");
+                goto finalize;
+        }
+
+        if (set_txsched_fast(&sched, fast, TXSCHED_DEFAULT_FAST_INTERVAL) < 0) {
+                fprintf(stderr, "set_txsched_fast() failed.\n");
+                goto finalize;
+        }
+
+        if (set_txsched_max_interval(&sched, max_interval) < 0) {
+                fprintf(stderr, "set_txsched_max_interval() failed.\n");
+                goto finalize;
+        }
+
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.ifinfo = get_ifinfo_table();
+        ctx.device_category = device_category;
+        ctx.device_category_len = sizeof(device_category);
+        ctx.manufacturer_code = manufacturer_code;
+        ctx.model_name = model_name;
+        ctx.model_name_len = sizeof(model_name);
+        ctx.model_number = model_number;
+        ctx.model_number_len = sizeof(model_number);
+        ctx.mac_list = mac_list;
+
+        /* main loop: send HTIP frame of each interface every 30 seconds, spread over the interval,
+           and stretch the interval up to the max while the interface doesn't change */
         for (;;) {
-                if (send_htip_device_info(device_category,
-                        sizeof(device_category), manufacturer_code, model_name,
-                        sizeof(model_name), model_number, sizeof(model_number))
-                        < 0) {
-                        fprintf(stderr, "send_htip_device_info() failed\n");
-                        goto finalize;
+                now = get_monotonic_msec();
+                deadline = now + TXSCHED_DEFAULT_INTERVAL;
+
+                for (i = 0; i < get_ifinfo_list_num(); i++) {
+                        ifip = get_ifinfo_list() + i;
+                        if (ifip->fd < 0)
+                                continue;
+
+                        /* fast start after startup, otherwise a random phase */
+                        if (ifip->next_tx == 0) {
+                                ifip->tx_fast = get_txsched_fast_count(&sched);
+                                ifip->next_tx = ifip->tx_fast > 0 ? now : get_txsched_first(&sched, now);
+                        }
+
+                        if (ifip->next_tx > now) {
+                                if (ifip->next_tx < deadline)
+                                        deadline = ifip->next_tx;
+                                continue;
+                        }
+
+                        /* over the rate cap, due interfaces wait for a token */
+                        if ((wait = take_txsched_token(&sched, now)) > 0) {
+                                if (now + wait < deadline)
+                                        deadline = now + wait;
+                                break;
+                        }
+
+                        /* a frame advertises the interval until the next frame of the interface */
+                        interval = ifip->tx_fast > 0 || ifip->tx_interval == 0 ?
+                                get_txsched_interval(&sched) : ifip->tx_interval;
+                        ctx.interval = interval / 1000;
+
+                        if (send_htip_device_info_ifinfo_r(&ctx, ifip) < 0)
+                                fprintf(stderr, "send_htip_device_info_ifinfo() failed on ifname: %s\n", ifip->ifname);
+#ifdef DEBUG
+                        printf("sent htip device info on ifname: %s\n", ifip->ifname);
+#endif /* DEBUG */
+
+                        if (ifip->tx_fast > 1) {
+                                ifip->tx_fast -= 1;
+                                ifip->next_tx = get_txsched_fast_next(&sched, now);
+                        } else if (ifip->tx_fast == 1) {
+                                /* the last fast frame hands over to a random phase of the interval */
+                                ifip->tx_fast = 0;
+                                ifip->next_tx = get_txsched_first(&sched, now + TXSCHED_DEFAULT_FAST_INTERVAL);
+                        } else {
+                                ifip->next_tx = get_txsched_next_interval(&sched, interval, ifip->next_tx, now);
+                                /* nothing changed since the previous frame */
+                                ifip->tx_interval = stretch_txsched_interval(&sched, interval);
+                        }
+                        if (ifip->next_tx < deadline)
+                                deadline = ifip->next_tx;
+                }
+
+                if (wait_ifinfo_monitor(monfd, deadline > now ? deadline - now : 0) <= 0)
+                        continue;
+
+                if ((n = handle_ifinfo_monitor(monfd)) <= 0)
+                        continue;
+
+                print_ifinfo();
+
+                /* new or changed network interfaces don't wait for the next cycle, and start fast */
+                now = get_monotonic_msec();
+                for (i = 0; i < get_ifinfo_list_num(); i++) {
+                        ifip = get_ifinfo_list() + i;
+                        /* a link coming up reports the changed flag again */
+                        if (ifip->changed && (ifip->ifflags & IFF_RUNNING)) {
+                                ifip->tx_fast = get_txsched_fast_count(&sched);
+                                ifip->tx_interval = 0;
+                                ifip->next_tx = now;
+                        }
                 }
-                printf("sent htip device info\n");
-                sleep(30);
         }
 
         goto finalize;
 
 finalize:
+        if (monfd >= 0)
+                close(monfd);
+
         close_netif();
 
         free_ifinfo_list();
 
+        free_iffilter();
+
         return (EXIT_SUCCESS);
 }
@@ -21,22 +21,37 @@
 #include <err.h>
 
 #include "fdb.h"
+#include "fdbflap.h"
 #include "htip.h"
+#include "iffilter.h"
 #include "ifinfo.h"
+#include "timer.h"
+#include "tlv.h"
+#include "txpool.h"
+#include "txsched.h"
+
+/** FDB tables of bridges given by -i, one per bridge */
+static struct fdb_table **bridge_list = NULL;
+/** MAC address moves of bridges, in the same order as bridge_list */
+static struct fdb_flap_table *flap_list = NULL;
+/** A number of bridges */
+static int bridge_num = 0;
+/** A number of moves a MAC address is suppressed at, 0 to disable */
+static int flap_threshold = FDB_FLAP_DEFAULT_THRESHOLD;
+/** Set by a signal to leave the main loop */
+static volatile sig_atomic_t stopped = 0;
+/** Workers sending frames to ports given by -w, NULL to send on the main thread */
+static struct txpool *txpool = NULL;
 
 void usage(char *argv0)
 {
-        printf("Usage: %s -i {bridge_network_interface_name}\n", argv0);
-}
-
-void signal_handler(int sig)
-{
-        printf("Catch signal: %d\n", sig);
-
-        free_ifinfo_list();
-        free_fdb_entry();
-
-        return;
+        printf("Usage: %s -i {bridge_network_interface_name} [-i ...] [-f [+|-]{field}={value}[,...]]... [-w {workers}] [-m {max_interval}] [-F {flap_threshold}]\n"
+               "  field: name (glob), kind, master, operstate\n"
+               "  workers: threads sending frames to ports, 0 (default) to send on the main thread\n"
+               "  max_interval: seconds an interval is stretched to while nothing changes, %d disables it (default: %d)\n"
+               "  flap_threshold: moves between ports in %d seconds a MAC address is not advertised at, 0 disables it (default: %d)\n",
+               argv0, TXSCHED_DEFAULT_INTERVAL / 1000, TXSCHED_DEFAULT_MAX_INTERVAL / 1000,
+               FDB_FLAP_DEFAULT_HALF_LIFE, FDB_FLAP_DEFAULT_THRESHOLD);
 }
 
 const char *select_one(const char* first, const char *second) {
@@ -75,9 +90,138 @@ u_char *get_model_number() {
     return model_number;
 }
 
+/**
+ * @brief Add a bridge to be handled with its own FDB table.
+ * @param brifname A bridge network interface name.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int add_bridge(const char *brifname)
+{
+        struct fdb_table **p;
+        struct fdb_flap_table *f;
+        int i;
+
+        for (i = 0; i < bridge_num; i++) {
+                if (strncmp(bridge_list[i]->brname, brifname, FDB_BRNAME_LEN) == 0)
+                        return 0;
+        }
+
+        if ((p = realloc(bridge_list, sizeof(struct fdb_table *) * (bridge_num + 1))) == NULL) {
+                perror("realloc");
+                return -1;
+        }
+        bridge_list = p;
+
+        if ((f = realloc(flap_list, sizeof(struct fdb_flap_table) * (bridge_num + 1))) == NULL) {
+                perror("realloc");
+                return -1;
+        }
+        flap_list = f;
+
+        if ((bridge_list[bridge_num] = alloc_fdb_table(brifname)) == NULL) {
+                fprintf(stderr, "alloc_fdb_table() failed.\n");
+                return -1;
+        }
+
+        /* the threshold is set by main() after options are parsed */
+        if (init_fdb_flap_table(&flap_list[bridge_num], 0, FDB_FLAP_DEFAULT_HALF_LIFE) < 0) {
+                fprintf(stderr, "init_fdb_flap_table() failed.\n");
+                free_fdb_table(bridge_list[bridge_num]);
+                return -1;
+        }
+        bridge_num += 1;
+
+        return 0;
+}
+
+/**
+ * @brief Free FDB tables of all bridges.
+ */
+void free_bridge(void)
+{
+        int i;
+
+        for (i = 0; i < bridge_num; i++) {
+                free_fdb_table(bridge_list[i]);
+                destroy_fdb_flap_table(&flap_list[i]);
+        }
+
+        free(bridge_list);
+        free(flap_list);
+        flap_list = NULL;
+        bridge_list = NULL;
+        bridge_num = 0;
+}
+
+/**
+ * @brief Send HTIP link information of a bridge to its ports.
+ * @param fdb A FDB table of the bridge.
+ * @param flap MAC address moves of the bridge.
+ * @param interval A transmission interval in seconds until the next frame.
+ * @return If the FDB changed since the previous cycle, it returns 1. If not, it returns 0. If failed, it returns -1.
+ */
+int send_bridge_link_info(struct fdb_table *fdb, struct fdb_flap_table *flap, u_int16_t interval)
+{
+        struct htip_ctx ctx;
+        u_char *device_category = get_device_category();
+        u_char *model_name = get_model_name();
+        u_char *model_number = get_model_number();
+        u_int32_t digest = fdb->digest;
+        int ret;
+
+        if (load_fdb_r(fdb, fdb->brname, MAX_FDB_ENTRY_SIZE) == -1) {
+                fprintf(stderr, "load_fdb() failed on bridge: %s\n", fdb->brname);
+                return -1;
+        }
+
+        /* flapping MAC addresses are left out before the digest is compared, so their moves don't reset the interval */
+        if ((ret = update_fdb_flap(flap, fdb, get_monotonic_msec())) < 0)
+                fprintf(stderr, "update_fdb_flap() failed on bridge: %s\n", fdb->brname);
+        else if (ret > 0)
+                print_fdb_flap(flap, fdb->brname);
+        suppress_fdb_flap(flap, fdb);
+
+        ret = fdb->digest != digest;
+
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.ifinfo = get_ifinfo_table();
+        ctx.fdb = fdb;
+        ctx.device_category = device_category;
+        ctx.device_category_len = sizeof(device_category);
+        ctx.manufacturer_code = get_manufacturer_code();
+        ctx.model_name = model_name;
+        ctx.model_name_len = sizeof(model_name);
+        ctx.model_number = model_number;
+        ctx.model_number_len = sizeof(model_number);
+        ctx.srcaddr = alloc_brifaddr(fdb->brname);
+        ctx.txpool = txpool;
+        ctx.interval = interval;
+
+        if (send_htip_device_link_info_r(&ctx) < 0) {
+                fprintf(stderr, "send_htip_device_link_info() failed on bridge: %s\n", fdb->brname);
+                ret = -1;
+        }
+
+        free(ctx.srcaddr);
+
+        free_fdb_entry_r(fdb);
+
+        return ret;
+}
+
+void signal_handler(int sig)
+{
+        (void) sig;
+
+        /* tables are in use by the main loop and workers, they're freed after it */
+        stopped = 1;
+}
+
 int main(int argc, char** argv) {
-        char *argv0 = NULL, *brifname = NULL;
-        int c;
+        char *argv0 = NULL;
+        int c, i, n, ret, monfd = -1, workers = 0, sec, changed = 0;
+        u_int64_t now, deadline, interval, max_interval = TXSCHED_DEFAULT_MAX_INTERVAL;
+        struct txsched sched;
         /* 0 ~ 255 bytes */
         u_char *device_category = get_device_category();
         /* 6 bytes */
@@ -88,10 +232,40 @@ int main(int argc, char** argv) {
         u_char *model_number = get_model_number();
 
         argv0 = argv[0];
-        while ((c = getopt(argc, argv, "i:l:")) != -1) {
+        while ((c = getopt(argc, argv, "F:f:i:l:m:w:")) != -1) {
                 switch (c) {
+                        case 'F':
+                                flap_threshold = atoi(optarg);
+                                if (flap_threshold < 0 || flap_threshold >= 0xFFFF / FDB_FLAP_MOVE) {
+                                        usage(argv0);
+                                        exit(EXIT_FAILURE);
+                                }
+                                break;
+                        case 'f':
+                                if (add_iffilter_rule(optarg) < 0) {
+                                        usage(argv0);
+                                        exit(EXIT_FAILURE);
+                                }
+                                break;
                         case 'i':
-                                brifname = optarg;
+                                if (add_bridge(optarg) < 0)
+                                        exit(EXIT_FAILURE);
+                                break;
+                        case 'm':
+                                sec = atoi(optarg);
+                                if (sec < TXSCHED_DEFAULT_INTERVAL / 1000 || sec > TTL_MAX / TTL_INTERVAL_MULTIPLIER) {
+                                        usage(argv0);
+                                        exit(EXIT_FAILURE);
+                                }
+                                max_interval = (u_int64_t) sec * 1000;
+                                break;
+                        case 'w':
+                                workers = atoi(optarg);
+                                if (workers < 0 || workers > TXPOOL_MAX_WORKERS) {
+                                        fprintf(stderr, "workers must be 0 to %d.\n", TXPOOL_MAX_WORKERS);
+                                        usage(argv0);
+                                        exit(EXIT_FAILURE);
+                                }
                                 break;
                         case '?':
                         default:
@@ -107,13 +281,17 @@ int main(int argc, char** argv) {
                 err(EXIT_FAILURE, "main");
         }
 
-        if (brifname == NULL) {
+        if (bridge_num == 0) {
                 fprintf(stderr, "bridge network interface were not set.\n");
                 usage(argv0);
                 exit(EXIT_FAILURE);
         }
 
-        if (signal(SIGINT, signal_handler) == SIG_ERR) {
+        /* -F may follow -i, so tables take the threshold once all options are read */
+        for (i = 0; i < bridge_num; i++)
+                flap_list[i].threshold = flap_threshold;
+
+        if (signal(SIGINT, signal_handler) == SIG_ERR || signal(SIGTERM, signal_handler) == SIG_ERR) {
                 fprintf(stderr, "signal got SIG_ERR\n");
                 goto finalize;
         }
@@ -123,58 +301,119 @@ int main(int argc, char** argv) {
 	printf("model_name: %s\n", model_name);
 	printf("model_number: %s\n", model_number);
 
-        u_char *srcaddr = NULL;
+        if (get_iffilter_rule_num() > 0)
+                print_iffilter();
 
-        for (;;) {
-                /* store network interface information */
-                if (read_ifinfo() < 0) {
-                        fprintf(stderr, "read_ifinfo() failed\n");
-                        return (EXIT_FAILURE);
-                }
+        /* store network interface information */
+        if (read_ifinfo() < 0) {
+                fprintf(stderr, "read_ifinfo() failed\n");
+                return (EXIT_FAILURE);
+        }
 
-                /* store network interface type */
-                if (read_net_type() == -1) {
-                        fprintf(stderr, "read_net_type() failed.\n");
-                        goto finalize;
-                }
+        /* store network interface type */
+        if (read_net_type() == -1) {
+                fprintf(stderr, "read_net_type() failed.\n");
+                goto finalize;
+        }
 
-                /* get network interfaces */
-                if (open_netif() < 0) {
-                        fprintf(stderr, "get_netif_osx() failed\n");
-                        goto finalize;
-                }
+        /* get network interfaces */
+        if (open_netif() < 0) {
+                fprintf(stderr, "get_netif_osx() failed\n");
+                goto finalize;
+        }
 
-                /* check stored network interface list */
-                print_ifinfo();
+        /* check stored network interface list */
+        print_ifinfo();
 
-                /* main loop: send HTIP frame every 30 seconds */
-                if (load_fdb(brifname, MAX_FDB_ENTRY_SIZE) == -1) {
-                        fprintf(stderr, "load_fdb() failed.\n");
+        /* encode and send frames of ports in parallel on a switch with many ports */
+        if (workers > 0) {
+                if ((txpool = alloc_txpool(workers)) == NULL) {
+                        fprintf(stderr, "alloc_txpool() failed.\n");
                         goto finalize;
                 }
+                printf("txpool: %d workers\n", get_txpool_worker_num(txpool));
+        }
+
+        /* watch network interfaces instead of reading them every cycle */
+        if ((monfd = open_ifinfo_monitor()) < 0)
+                fprintf(stderr, "open_ifinfo_monitor() failed, fall back to polling.\n");
+
+        /* only the stretching of the interval is used, a cycle sends to all ports at once */
+        if (init_txsched(&sched, TXSCHED_DEFAULT_INTERVAL, 0, 0, 1) < 0 ||
+            set_txsched_max_interval(&sched, max_interval) < 0) {
+                fprintf(stderr, "init_txsched() failed.\n");
+                goto finalize;
+        }
+        interval = get_txsched_interval(&sched);
 
+        /* main loop: send HTIP frame every 30 seconds, stretched up to the max while nothing changes */
+        while (!stopped) {
+                /* all bridges share the interface table, a failed bridge doesn't stop the others */
+                for (i = 0, n = 0; i < bridge_num; i++) {
+                        if ((ret = send_bridge_link_info(bridge_list[i], &flap_list[i], interval / 1000)) < 0)
+                                continue;
+                        n += 1;
+                        changed |= ret;
+                }
 
-                srcaddr = alloc_brifaddr(brifname);
-                if (send_htip_device_link_info(device_category,
-                        sizeof(device_category), manufacturer_code, model_name,
-                        sizeof(model_name), model_number, sizeof(model_number), srcaddr)
-                        < 0) {
-                        fprintf(stderr, "send_htip_device_link_info() failed\n");
+                if (n == 0) {
+                        fprintf(stderr, "send_bridge_link_info() failed on all bridges.\n");
                         goto finalize;
                 }
 
-                free(srcaddr);
-                close_netif();
+                /* only appeared, disappeared or changed interfaces are updated */
+                if (monfd < 0) {
+                        /* a signal cuts the sleep short */
+                        sleep(interval / 1000);
+                        if (stopped)
+                                break;
+                        if ((n = refresh_ifinfo()) < 0) {
+                                fprintf(stderr, "refresh_ifinfo() failed.\n");
+                                goto finalize;
+                        }
+                        if (n > 0) {
+                                print_ifinfo();
+                                changed = 1;
+                        }
+                } else {
+                        /* a new or changed port is advertised without waiting for the next cycle */
+                        deadline = get_monotonic_msec() + interval;
+                        while (!stopped && (now = get_monotonic_msec()) < deadline) {
+                                if (wait_ifinfo_monitor(monfd, deadline - now) <= 0)
+                                        continue;
+
+                                if ((n = handle_ifinfo_monitor(monfd)) < 0) {
+                                        fprintf(stderr, "handle_ifinfo_monitor() failed.\n");
+                                        goto finalize;
+                                }
 
-                free_fdb_entry();
+                                if (n > 0) {
+                                        print_ifinfo();
+                                        changed = 1;
+                                        break;
+                                }
+                        }
+                }
 
-                sleep(30);
+                /* frames advertise the interval, so it changes only between cycles */
+                interval = changed ? get_txsched_interval(&sched) : stretch_txsched_interval(&sched, interval);
+                changed = 0;
         }
 
 finalize:
-        free_ifinfo_list();
+        if (stopped)
+                printf("Catch signal, stopping.\n");
+
+        if (monfd >= 0)
+                close(monfd);
+
+        free_txpool(txpool);
+
+        close_netif();
+
+        free_bridge();
 
-        free_fdb_entry();
+        free_iffilter();
 
         return (EXIT_SUCCESS);
 }
@@ -20,6 +20,8 @@
 extern "C" {
 #endif
 
+#include <sys/types.h>
+
 /**
  * @brief Print hex dump strings.
  * @param h A pointer to head to print.
@@ -40,6 +42,15 @@ void print_hexdump(const char *p, const int len);
  * @param len A length of strings.
  */
 void print_hexlstr(const char *p, const int len);
+
+/**
+ * @brief Calculate CRC32C (Castagnoli), by the CRC32 instruction if the CPU has SSE4.2.
+ * @param crc A CRC of preceding data to continue, 0 for the first call.
+ * @param buf A pointer to data.
+ * @param len A length of the data.
+ * @return A CRC of the preceding data and the data.
+ */
+u_int32_t crc32c(u_int32_t crc, const void *buf, size_t len);
 #ifdef __cplusplus
 }
 #endif
@@ -73,11 +73,81 @@ int set_promiscuous_mode(const char *interface_name);
 
 /**
  * @brief Get a network interface type from a network interface name.
+ *
+ * On Linux, a type is read from /sys/class/net once and cached by ifindex.
+ *
  * @param ifname A network interface name.
  * @return If succeeded, it returns a type value (such as HW_ETHER). If failed, it returns HW_INVALID.
  */
 u_int32_t get_iftype(const char *ifname);
 
+/**
+ * @brief Get a network interface type from a network interface name and its index.
+ * @param ifname A network interface name.
+ * @param ifindex An interface index of it, 0 if not known to read it from /sys/class/net.
+ * @return If succeeded, it returns a type value (such as HW_ETHER). If failed, it returns HW_INVALID.
+ */
+u_int32_t get_iftype_ifindex(const char *ifname, int ifindex);
+
+#define IFTYPE_CACHE_INIT_SIZE 64
+
+/**
+ * @brief Look up a cached network interface type.
+ * @param ifindex An interface index.
+ * @param ifname A network interface name.
+ * @return If cached, it returns an IANAifType value. If not cached, or the
+ * ifindex was cached with another ifname (a reused ifindex), it returns 0.
+ */
+u_int32_t lookup_iftype_cache(int ifindex, const char *ifname);
+
+/**
+ * @brief Store a network interface type to the cache.
+ * @param ifindex An interface index.
+ * @param ifname A network interface name.
+ * @param iftype An IANAifType value.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int store_iftype_cache(int ifindex, const char *ifname, u_int32_t iftype);
+
+/**
+ * @brief Forget a cached network interface type, call this on a link event.
+ * @param ifindex An interface index.
+ */
+void invalidate_iftype_cache(int ifindex);
+
+/**
+ * @brief Free the network interface type cache.
+ */
+void free_iftype_cache(void);
+
+#ifdef __linux__
+/**
+ * @brief Open a directory of a network interface under /sys/class/net.
+ *
+ * A directory handle of /sys/class/net is kept open, and the interface
+ * directory is opened by openat(2) relative to it.
+ *
+ * @param ifname A network interface name.
+ * @return If succeeded, it returns an opened directory. If failed, it returns -1.
+ */
+int open_sysfs_netif(const char *ifname);
+
+/**
+ * @brief Check whether an entry of a network interface directory is a directory.
+ * @param fd A directory opened by open_sysfs_netif().
+ * @param name An entry name such as "bridge" or "wireless".
+ * @return If it's a directory, it returns 1. If not, it returns 0.
+ */
+int is_sysfs_netif_dir(int fd, const char *name);
+#endif /* __linux__ */
+
+/**
+ * @brief Convert a data link type to an IANAifType value.
+ * @param dlt A data link type (such as HW_ETHER).
+ * @return An IANAifType value (such as IANAIFTYPE_ETHERNETCSMACD). If unsupported, it returns IANAIFTYPE_OTHER.
+ */
+u_int32_t get_ianaiftype(u_int32_t dlt);
+
 #ifdef __APPLE__
 /**
  * @brief Get a BPF buffer length.
@@ -188,6 +258,45 @@ int ether_addr_cmp(const u_int8_t a1[], const u_int8_t a2[]);
 int write_frame(int bpf, char *ifname, u_char *dst_mac, u_char *src_mac,
         u_char *payload, u_int payload_len);
 
+#ifdef __linux__
+/**
+ * @brief Open a socket to send frames by write_frame_ifindex().
+ * @return If succeeded, it returns an opened socket. If failed, it returns -1.
+ */
+int open_frame_socket(void);
+
+/**
+ * @brief Write a data to a network interface through an opened socket.
+ * @param sock A socket opened by open_frame_socket()
+ * @param ifindex An interface index of the network interface
+ * @param dst_mac Destination MAC address
+ * @param src_mac Source MAC address
+ * @param payload Sent payload content
+ * @param payload_len Length of payload
+ * @return Sent payload bytes. If failed, it returns -1.
+ * @detail Unlike write_frame(), it neither opens a socket nor looks up an interface index for each frame.
+ */
+int write_frame_ifindex(int sock, int ifindex, u_char *dst_mac, u_char *src_mac,
+        u_char *payload, u_int payload_len);
+
+/**
+ * @brief Open a socket to receive LLDP frames by read_frame().
+ * @param ifname A network interface name to receive frames from, NULL for all interfaces.
+ * @return If succeeded, it returns an opened socket. If failed, it returns -1.
+ */
+int open_lldp_socket(const char *ifname);
+
+/**
+ * @brief Read a frame from a socket opened by open_lldp_socket().
+ * @param sock A socket.
+ * @param buf A buffer to store a frame with its ethernet header.
+ * @param len A length of the buffer.
+ * @param ifindex A pointer to store an interface index the frame came from, NULL to ignore it.
+ * @return A length of the frame. If no frame is available, it returns 0. If failed, it returns -1.
+ */
+int read_frame(int sock, u_char *buf, u_int len, int *ifindex);
+#endif /* __linux__ */
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,8 @@ extern "C" {
 #include <sys/time.h>
 #include <net/ethernet.h>
 
+#include "macmap.h"
+
 #define SYSFS_CLASS_NET "/sys/class/net/"
 #define SYSFS_PATH_MAX 256
 #define MAX_FDB_ENTRY_SIZE 256
@@ -49,18 +51,117 @@ struct fdb_entry {
 };
 #define FDB_ENTRY_LEN sizeof(struct fdb_entry)
 
+#define FDB_BRNAME_LEN 16
+
+/** A mask of a MAC address in a FDB key */
+#define FDB_KEY_MASK 0xFFFFFFFFFFFFULL
+/** A shift of a port number above a MAC address in a key of an index of a FDB table */
+#define FDB_KEY_PORT_SHIFT 48
+/** A key of an index of a FDB table for a local entry, no port number takes it */
+#define FDB_KEY_LOCAL ((u_int64_t) FDB_ENTRY_PORT_INVALID << FDB_KEY_PORT_SHIFT)
+
+/**
+ * @brief A FDB entry list of a bridge.
+ *
+ * Fields of entries are kept in parallel arrays, so a scan reads only the
+ * field it needs, and a struct fdb_entry is built by get_fdb_entry_r() only
+ * when a whole entry is wanted.
+ *
+ * Functions taking a table (named *_r) only touch that table, so tables of
+ * different bridges can be loaded and looked up in parallel without locks.
+ * Functions without a table work on a current table set by set_fdb_entry_list().
+ */
+struct fdb_table {
+        /** A name of bridge network interface */
+        char brname[FDB_BRNAME_LEN];
+        /** MAC addresses of entries as 48-bit keys, packed for vectorized scans */
+        u_int64_t keys[MAX_FDB_ENTRY_SIZE];
+        /** MAC addresses of entries as octets, in the same order as keys */
+        u_int8_t macaddrs[MAX_FDB_ENTRY_SIZE][ETHER_ADDR_LEN];
+        /** Port numbers of entries, in the same order as keys */
+        u_int16_t ports[MAX_FDB_ENTRY_SIZE];
+        /** Flags whether entries are local ports or not, in the same order as keys */
+        u_int8_t flags[MAX_FDB_ENTRY_SIZE];
+        /** Ageing timers of entries in milliseconds, in the same order as keys */
+        u_int32_t ages[MAX_FDB_ENTRY_SIZE];
+        /** A number of FDB entry in the list */
+        int num;
+        /** A size of FDB entry list */
+        int size;
+        /** A digest of MAC addresses and port numbers of entries, updated by load_fdb_r() */
+        u_int32_t digest;
+        /** An index of entries, a MAC address with a port number, or with FDB_KEY_LOCAL for the first local entry */
+        struct macmap index;
+        /** A number of entries in index, it's used only if it equals to num */
+        int index_num;
+};
+
+/**
+ * @brief Convert a MAC address to a FDB key.
+ * @param macaddr A MAC address.
+ * @return A 48-bit key, the first octet is the lowest byte.
+ */
+u_int64_t get_fdb_key(const u_int8_t macaddr[]);
+
+/**
+ * @brief Find an entry with a MAC address in a FDB table.
+ *
+ * It scans packed keys with AVX2 or SSE2 if available, scalar otherwise.
+ *
+ * @param t A pointer to a FDB table.
+ * @param key A key by get_fdb_key().
+ * @param start An index to start from.
+ * @return If found, it returns an index of the entry. If not, it returns -1.
+ */
+int find_fdb_key_r(const struct fdb_table *t, u_int64_t key, int start);
+
 /**
- * @brief Get a pointer to a head of FDB entry list.
- * @return a pointer to a head of FDB entry list.
+ * @brief Find an entry with a port number in a FDB table.
+ * @param t A pointer to a FDB table.
+ * @param port_no A port number.
+ * @param start An index to start from.
+ * @return If found, it returns an index of the entry. If not, it returns -1.
  */
-struct fdb_entry *get_fdb_entry_list(void);
+int find_fdb_port_r(const struct fdb_table *t, u_int16_t port_no, int start);
 
 /**
- * @brief Set a pointer to a head of FDB entry list.
- * @param p A pointer to a head of FDB entry list.
+ * @brief Get an entry of a FDB table.
+ * @param t A pointer to a FDB table.
+ * @param i An index of the entry.
+ * @param fdbp A pointer to store the entry.
+ * @return If succeeded, it returns 0. If the index is out of the table, it returns -1.
+ */
+int get_fdb_entry_r(const struct fdb_table *t, int i, struct fdb_entry *fdbp);
+
+/**
+ * @brief Set a FDB table to be used as FDB entry list.
+ *
+ * FDB entry functions without a table work on the set table, so a process
+ * handling several bridges sets a table of each bridge before loading its FDB.
+ *
+ * @param p A pointer to a FDB table allocated by alloc_fdb_table(). If NULL, a default table is set.
  */
 void set_fdb_entry_list(void *p);
 
+/**
+ * @brief Get a current FDB table.
+ * @return A pointer to a current FDB table.
+ */
+struct fdb_table *get_fdb_table(void);
+
+/**
+ * @brief Allocate an empty FDB table for a bridge.
+ * @param brname A bridge network interface name.
+ * @return If succeeded, it returns an allocated pointer. If failed, it returns NULL.
+ */
+struct fdb_table *alloc_fdb_table(const char *brname);
+
+/**
+ * @brief Free a FDB table. If it's current, a default table is set.
+ * @param p A pointer to a FDB table.
+ */
+void free_fdb_table(struct fdb_table *p);
+
 /**
  * @brief Get a number of FDB entry.
  * @return a number of FDB entry.
@@ -88,16 +189,18 @@ int get_fdb_entry_size(void);
 int set_fdb_entry_size(int size);
 
 /**
- * @brief Allocate a memory with specified size of FDB entry.
+ * @brief Empty a FDB table for a specified size of FDB entry.
  * @param size A size of FDB entry.
- * @return a pointer to a head of FDB entry list.
+ * @return If succeeded, it returns a pointer to the table. If failed, it returns NULL.
  */
 void *malloc_fdb_entry(const int size);
+void *malloc_fdb_entry_r(struct fdb_table *t, const int size);
 
 /**
  * @brief Free a memory of FDB entry.
  */
 void free_fdb_entry(void);
+void free_fdb_entry_r(struct fdb_table *t);
 
 /**
  * @brief Add a new FDB entry to FDB entry list.
@@ -105,6 +208,7 @@ void free_fdb_entry(void);
  * @return If a new FDB entry is added to FDB entry list, it returns 0. If failed, it returns -1;
  */
 int add_fdb_entry(const struct fdb_entry *fdbp);
+int add_fdb_entry_r(struct fdb_table *t, const struct fdb_entry *fdbp);
 
 /**
  * @brief Check whether specified FDB entry exists in FDB entry list.
@@ -112,6 +216,7 @@ int add_fdb_entry(const struct fdb_entry *fdbp);
  * @return If same FDB entry exists in FDB entry list, it returns 1. If not, it returns 0;
  */
 int exist_fdb_entry(const struct fdb_entry *fdbp);
+int exist_fdb_entry_r(struct fdb_table *t, const struct fdb_entry *fdbp);
 
 /**
  * @brief Get a port number matching specified MAC address in FDB entry list.
@@ -119,6 +224,7 @@ int exist_fdb_entry(const struct fdb_entry *fdbp);
  * @return If found matched MAC address entry, it returns a port number. If not, it returns FDB_ENTRY_PORT_INVALID;
  */
 u_int16_t get_portno_by_macaddr(const u_int8_t macaddr[]);
+u_int16_t get_portno_by_macaddr_r(struct fdb_table *t, const u_int8_t macaddr[]);
 
 /**
  * @brief Count FDB entries matching with specified MAC address, store a pointer of matched MAC address to specified list.
@@ -126,6 +232,7 @@ u_int16_t get_portno_by_macaddr(const u_int8_t macaddr[]);
  * @return A number of counted FDB entries.
  */
 int get_remote_entry_num_by_macaddr(const u_int8_t macaddr[], u_int8_t *macaddrs[]);
+int get_remote_entry_num_by_macaddr_r(struct fdb_table *t, const u_int8_t macaddr[], u_int8_t *macaddrs[]);
 
 /**
  * @brief Count FDB entries matching with specified port number, store a pointer of matched MAC address to specified list.
@@ -133,6 +240,7 @@ int get_remote_entry_num_by_macaddr(const u_int8_t macaddr[], u_int8_t *macaddrs
  * @return A number of counted FDB entries.
  */
 int get_remote_entry_num_by_portno(const u_int16_t port_no, u_int8_t *macaddrs[]);
+int get_remote_entry_num_by_portno_r(struct fdb_table *t, const u_int16_t port_no, u_int8_t *macaddrs[]);
 
 /**
  * @brief Get current forwarding database entries and return the number of entries.
@@ -140,6 +248,7 @@ int get_remote_entry_num_by_portno(const u_int16_t port_no, u_int8_t *macaddrs[]
  * @return If succeed, it returns a number of read entries. If failed, it returns -1.
  */
 int read_fdb(const char *bridge_name);
+int read_fdb_r(struct fdb_table *t, const char *bridge_name);
 
 /**
  * @brief Load current forwarding database entries.
@@ -148,6 +257,16 @@ int read_fdb(const char *bridge_name);
  * @return If succeed, it returns 0. If failed, it returns -1.
  */
 int load_fdb(const char *brname, const int size);
+int load_fdb_r(struct fdb_table *t, const char *brname, const int size);
+
+/**
+ * @brief Remove entries from a FDB table, the index and the digest are updated.
+ * @param t A pointer to a FDB table.
+ * @param keep A function returning nonzero for an entry of the table at an index to be kept.
+ * @param arg An argument passed to keep.
+ * @return A number of removed entries.
+ */
+int filter_fdb_entry_r(struct fdb_table *t, int (*keep)(const struct fdb_table *, int, void *), void *arg);
 
 /**
  * @brief Print forwarding database entries from specified point.
@@ -162,6 +281,7 @@ void print_fdb(struct fdb_entry *fdbs, int n);
  * @brief Print all FDB list.
  */
 void print_fdb_entry(void);
+void print_fdb_entry_r(struct fdb_table *t);
 
 #ifdef __cplusplus
 }
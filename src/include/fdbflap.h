@@ -0,0 +1,140 @@
+/**
+ * @file   fdbflap.h
+ * @brief A library detecting MAC addresses moving between ports of a bridge.
+ *
+ * A header file of a library that keep the last port and a decaying counter of
+ * moves of each MAC address of a FDB, so a MAC address jumping between ports,
+ * like by a loop or a misconfiguration, is reported as flapping and left out
+ * of advertisements until it settles.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef FDBFLAP_H
+#define FDBFLAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#include "fdb.h"
+#include "macmap.h"
+
+/** A default number of moves a MAC address starts flapping at */
+#define FDB_FLAP_DEFAULT_THRESHOLD 4
+/** A default half-life of counters in seconds, the default ageing time of a bridge */
+#define FDB_FLAP_DEFAULT_HALF_LIFE 300
+/** An initial size of a list of MAC addresses */
+#define FDB_FLAP_INIT_SIZE 64
+/** A move in a counter, a counter keeps fractions of moves */
+#define FDB_FLAP_MOVE 256
+/** A flag of an entry seen by the last update */
+#define FDB_FLAP_FLAG_SEEN 0x01
+/** A flag of an entry flapping */
+#define FDB_FLAP_FLAG_FLAPPING 0x02
+
+/**
+ * @brief A MAC address tracked for moves, 16 bytes.
+ */
+struct fdb_flap_entry {
+        /** A MAC address by get_fdb_key(), with the last port number shifted by FDB_KEY_PORT_SHIFT */
+        u_int64_t key;
+        /** A time in seconds the counter decayed last */
+        u_int32_t stamp;
+        /** A decaying counter of moves, in FDB_FLAP_MOVE per move */
+        u_int16_t score;
+        /** Flags of FDB_FLAP_FLAG_* */
+        u_int8_t flags;
+        char pad[1];
+};
+
+/**
+ * @brief A table of MAC addresses of a bridge tracked for moves.
+ *
+ * A counter is halved each half-life, so it reads roughly as moves of the
+ * last half-life. A MAC address starts flapping when its counter reaches the
+ * threshold, and stops when it falls under a half of the threshold, so it
+ * doesn't toggle at the boundary. A MAC address absent from a FDB is forgotten
+ * once its counter decays to zero.
+ */
+struct fdb_flap_table {
+        /** MAC addresses */
+        struct fdb_flap_entry *list;
+        /** A number of MAC addresses */
+        int num;
+        /** A size of list */
+        int size;
+        /** An index from MAC addresses to entries of list */
+        struct macmap index;
+        /** A number of moves a MAC address starts flapping at, 0 to disable */
+        int threshold;
+        /** A half-life of counters in seconds */
+        u_int32_t half_life;
+        /** A number of flapping MAC addresses */
+        int flapping;
+        /** A total number of moves */
+        u_int64_t moves;
+        /** A total number of MAC addresses started flapping */
+        u_int64_t flaps;
+};
+
+/**
+ * @brief Initialize an empty table.
+ * @param f A pointer to a table.
+ * @param threshold A number of moves a MAC address starts flapping at, 0 to disable.
+ * @param half_life A half-life of counters in seconds, not 0.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int init_fdb_flap_table(struct fdb_flap_table *f, int threshold, u_int32_t half_life);
+
+/**
+ * @brief Free a table.
+ * @param f A pointer to a table.
+ */
+void destroy_fdb_flap_table(struct fdb_flap_table *f);
+
+/**
+ * @brief Count moves of remote entries of a loaded FDB table.
+ * @param f A pointer to a table.
+ * @param t A pointer to a FDB table loaded by load_fdb_r().
+ * @param now A current time by get_monotonic_msec().
+ * @return If succeeded, it returns a number of MAC addresses started or stopped flapping. If failed, it returns -1.
+ */
+int update_fdb_flap(struct fdb_flap_table *f, const struct fdb_table *t, u_int64_t now);
+
+/**
+ * @brief Check whether a MAC address is flapping.
+ * @param f A pointer to a table.
+ * @param macaddr A MAC address.
+ * @return If flapping, it returns 1. If not, it returns 0.
+ */
+int is_fdb_flapping(const struct fdb_flap_table *f, const u_int8_t macaddr[]);
+
+/**
+ * @brief Remove remote entries of flapping MAC addresses from a FDB table, not to advertise them.
+ * @param f A pointer to a table updated by update_fdb_flap().
+ * @param t A pointer to a FDB table.
+ * @return A number of removed entries.
+ */
+int suppress_fdb_flap(const struct fdb_flap_table *f, struct fdb_table *t);
+
+/**
+ * @brief Print flapping MAC addresses.
+ * @param f A pointer to a table.
+ * @param brname A bridge network interface name.
+ */
+void print_fdb_flap(const struct fdb_flap_table *f, const char *brname);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FDBFLAP_H */
@@ -22,8 +22,48 @@ extern "C" {
 
 #include <sys/types.h>
 
+#include "ifinfo.h"
+#include "fdb.h"
+#include "txpool.h"
+
 #define HTIP_L2AGENT_DST_MACADDR {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
 
+/**
+ * @brief A context of sending HTIP frames.
+ *
+ * The *_r functions send HTIP frames to interfaces of ifinfo with link
+ * information of fdb, so that one process can send them for several bridges.
+ * The other functions use the default ifinfo table and the current FDB table.
+ */
+struct htip_ctx {
+        /** A table of network interfaces to be sent to */
+        struct ifinfo_table *ifinfo;
+        /** A table of FDB entries for link information */
+        struct fdb_table *fdb;
+        /** A pointer to device category */
+        u_char *device_category;
+        /** A length of a device category, the max length is 255 */
+        int device_category_len;
+        /** A pointer to a manufacturer code, the length is 6 */
+        u_char *manufacturer_code;
+        /** A pointer to a model name */
+        u_char *model_name;
+        /** A length of a model name, the max length is 31 */
+        int model_name_len;
+        /** A pointer to a model number */
+        u_char *model_number;
+        /** A length of a model number, the max length is 31 */
+        int model_number_len;
+        /** Source address of the HTIP frame, NULL for a MAC address of each interface */
+        u_char *srcaddr;
+        /** A transmission interval in seconds advertised with a TTL of TTL_INTERVAL_MULTIPLIER times, 0 for TTL_DEFAULT without the interval */
+        u_int16_t interval;
+        /** 1 to add a MAC address list of interfaces of ifinfo and remote entries of fdb to device information */
+        int mac_list;
+        /** Workers encoding and sending frames of ports, NULL to do it on the calling thread */
+        struct txpool *txpool;
+};
+
 /**
  * @brief Send a HTIP device information with specified parameters.
  * @param device_category A pointer to device category
@@ -39,12 +79,51 @@ int send_htip_device_info(u_char *device_category, int device_category_len,
         u_char *manufacturer_code, u_char *model_name, int model_name_len,
         u_char *model_number, int model_number_len);
 
+/**
+ * @brief Send a HTIP device information to all interfaces of a context.
+ * @param ctx A pointer to a HTIP context
+ * @return If succeed, it returns 0. If failed, it returns -1.
+ */
+int send_htip_device_info_r(struct htip_ctx *ctx);
+
+/**
+ * @brief Send a HTIP device information to a specified network interface.
+ * @param ifip A pointer to ifinfo of the network interface
+ * @param device_category A pointer to device category
+ * @param device_category_len A length of a device category, the max length is 255
+ * @param manufacturer_code A pointer to a manufacturer code, the length is 6
+ * @param model_name A pointer to a model name
+ * @param model_name_len A length of a model name, the max length is 31
+ * @param mdoel_number A pointer to a model number
+ * @param model_number_len A length of a model number, the max length is 31
+ * @return If succeed, it returns 0. If failed, it returns -1.
+ */
+int send_htip_device_info_ifinfo(struct ifinfo *ifip,
+        u_char *device_category, int device_category_len,
+        u_char *manufacturer_code, u_char *model_name, int model_name_len,
+        u_char *model_number, int model_number_len);
+
+/**
+ * @brief Send a HTIP device information of a context to a specified network interface.
+ * @param ctx A pointer to a HTIP context
+ * @param ifip A pointer to ifinfo of the network interface
+ * @return If succeed, it returns 0. If failed, it returns -1.
+ */
+int send_htip_device_info_ifinfo_r(struct htip_ctx *ctx, struct ifinfo *ifip);
+
 /**
  * @brief Send a HTIP link information.
  * @return If succeed, it returns 0. If failed, it returns -1.
  */
 int send_htip_link_info(void);
 
+/**
+ * @brief Send a HTIP link information of a context.
+ * @param ctx A pointer to a HTIP context
+ * @return If succeed, it returns 0. If failed, it returns -1.
+ */
+int send_htip_link_info_r(struct htip_ctx *ctx);
+
 /**
  * @brief Send a HTIP device information and HTIP link information at once.
  * @param device_category A pointer to device category
@@ -60,6 +139,14 @@ int send_htip_link_info(void);
 int send_htip_device_link_info(u_char *device_category,
         int device_category_len, u_char *manufacturer_code, u_char *model_name,
         int model_name_len, u_char *model_number, int model_number_len, u_char *srcaddr);
+
+/**
+ * @brief Send a HTIP device information and HTIP link information of a context at once.
+ * @param ctx A pointer to a HTIP context
+ * @return If succeed, it returns 0. If failed, it returns -1.
+ */
+int send_htip_device_link_info_r(struct htip_ctx *ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,151 @@
+/**
+ * @file   iffilter.h
+ * @brief A library filtering network interfaces to be advertised.
+ *
+ * A header file of a library that compile include and exclude rules of
+ * network interfaces and match interfaces reported by the kernel against them.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef IFFILTER_H
+#define IFFILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#define IFFILTER_KIND_LEN 16
+#define IFFILTER_VALUE_LEN 64
+
+/** A network interface name, a glob pattern such as "eth*" */
+#define IFFILTER_FIELD_NAME 1
+/** A link kind such as "veth", "none" for physical devices */
+#define IFFILTER_FIELD_KIND 2
+/** A network interface name of the master bridge, "none" for no master */
+#define IFFILTER_FIELD_MASTER 3
+/** An operational state such as "up" or "down" (RFC 2863) */
+#define IFFILTER_FIELD_OPERSTATE 4
+
+/** A value is compared as a whole string */
+#define IFFILTER_MATCH_EXACT 1
+/** A value ends with a single '*' and is compared as a prefix */
+#define IFFILTER_MATCH_PREFIX 2
+/** A value is a glob pattern passed to fnmatch(3) */
+#define IFFILTER_MATCH_GLOB 3
+
+/* operational states, same as IF_OPER_* of <linux/if.h> */
+#define IFFILTER_OPER_UNKNOWN 0
+#define IFFILTER_OPER_NOTPRESENT 1
+#define IFFILTER_OPER_DOWN 2
+#define IFFILTER_OPER_LOWERLAYERDOWN 3
+#define IFFILTER_OPER_TESTING 4
+#define IFFILTER_OPER_DORMANT 5
+#define IFFILTER_OPER_UP 6
+
+/**
+ * @brief A network interface to be matched, filled without any syscall.
+ */
+struct iffilter_link {
+        /** A name of network interface */
+        const char *ifname;
+        /** A link kind, empty for physical devices */
+        const char *kind;
+        /** An interface index of the master bridge, 0 if none */
+        int master_ifindex;
+        /** An operational state (IF_OPER_*) */
+        u_char operstate;
+};
+
+/**
+ * @brief A compiled condition of a rule.
+ */
+struct iffilter_cond {
+        /** A field to be compared (IFFILTER_FIELD_*) */
+        int field;
+        /** How to compare a string value (IFFILTER_MATCH_*) */
+        int match;
+        /** A string value, a prefix has no trailing '*' */
+        char value[IFFILTER_VALUE_LEN];
+        /** A length of value */
+        size_t len;
+        /** A resolved operational state, or an interface index of the master, 0 if not resolved */
+        int num;
+};
+
+/**
+ * @brief A compiled rule, all conditions must match.
+ */
+struct iffilter_rule {
+        /** 1 for an include rule, 0 for an exclude rule */
+        int include;
+        /** A number of conditions */
+        int num;
+        /** Conditions of the rule */
+        struct iffilter_cond *conds;
+};
+
+/**
+ * @brief Add a rule to the interface filter.
+ *
+ * A rule is "[+|-]field=value[,field=value...]". '+' (default) includes and
+ * '-' excludes matched interfaces, and field is one of name, kind, master and
+ * operstate. An interface matched by any exclude rule is not advertised. If
+ * there are include rules, an interface must also match one of them.
+ *
+ * @param spec A rule string.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int add_iffilter_rule(const char *spec);
+
+/**
+ * @brief Get a number of rules of the interface filter.
+ * @return A number of rules.
+ */
+int get_iffilter_rule_num(void);
+
+/**
+ * @brief Check whether a network interface passes the interface filter.
+ * @param link A pointer to a network interface to be matched.
+ * @return If it passes, it returns 0. If not, it returns -1.
+ */
+int match_iffilter(const struct iffilter_link *link);
+
+/**
+ * @brief Tell the interface filter an interface index of a network interface.
+ *
+ * master conditions naming the interface are bound to ifindex.
+ *
+ * @param ifname A name of network interface.
+ * @param ifindex An interface index, 0 if the interface was removed.
+ */
+void learn_iffilter_master(const char *ifname, int ifindex);
+
+/**
+ * @brief Resolve interface indexes of all master conditions.
+ */
+void resolve_iffilter_master(void);
+
+/**
+ * @brief Free all rules of the interface filter.
+ */
+void free_iffilter(void);
+
+/**
+ * @brief Print rules of the interface filter.
+ */
+void print_iffilter(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IFFILTER_H */
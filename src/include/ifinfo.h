@@ -39,6 +39,10 @@ extern "C" {
 struct ifinfo {
         /** A file descriptor */
         int fd;
+        /** An interface index */
+        int ifindex;
+        /** An interface index of the master bridge, 0 if none */
+        int master_ifindex;
         /** A name of network interface */
         char ifname[IFNAMSIZ];
         /** An ip address */
@@ -49,14 +53,72 @@ struct ifinfo {
         u_char macaddr[ETHER_ADDR_LEN];
         /** A network interface type */
         u_int32_t iftype;
+        /** Interface flags, only IFF_UP and IFF_RUNNING are kept */
+        u_int32_t ifflags;
         /** A port number of network interface */
         u_int16_t port_no;
+        /** A flag whether the interface appeared or changed since it was advertised */
+        u_char changed;
+        /** A time to send the next frame by get_monotonic_msec(), 0 if not scheduled yet */
+        u_int64_t next_tx;
+        /** A number of frames left to be sent at the fast interval */
+        u_char tx_fast;
+        /** A current transmission interval in milliseconds, 0 for the base interval */
+        u_int32_t tx_interval;
 };
 
 #define IFINFO_LEN sizeof(struct ifinfo)
-#define IFINFO_LIST_MAX_SIZE 20
+#define IFINFO_LIST_INIT_SIZE 32
 #define IFINFO_LIST_INVALID -1
 
+#define IFINFO_FLAGS_MASK (IFF_UP | IFF_RUNNING)
+
+/**
+ * @brief A table of network interface information.
+ *
+ * Functions taking a table (named *_r) only touch that table, so different
+ * tables can be looked up, printed and sent to from different threads without
+ * locks. Functions without a table work on a default table returned by
+ * get_ifinfo_table(). Still process wide are the interface type cache and the
+ * sysfs directory of datalink, and rules and learned masters of the interface
+ * filter, so reading, refreshing and monitoring interfaces aren't run in
+ * parallel even on different tables. Netlink dumps themselves are safe on
+ * different sockets.
+ */
+struct ifinfo_table {
+        /** A list of network interface information */
+        struct ifinfo *list;
+        /** A number of stored ifinfo */
+        int num;
+        /** A size how many ifinfo can be stored in the list */
+        int size;
+        /** A hash table from a network interface name to an index of the list + 1, 0 is empty */
+        int *name_hash;
+        /** A hash table from an interface index to an index of the list + 1, 0 is empty */
+        int *index_hash;
+        /** A size of hash tables, a power of two and at least twice of the list size */
+        int hash_size;
+};
+
+/**
+ * @brief Get a default ifinfo table.
+ * @return A pointer to a default ifinfo table.
+ */
+struct ifinfo_table *get_ifinfo_table(void);
+
+/**
+ * @brief Allocate an empty ifinfo table.
+ * @param size An initial size of ifinfo list(number of struct ifinfo).
+ * @return If succeeded, it returns an allocated pointer. If failed, it returns NULL.
+ */
+struct ifinfo_table *alloc_ifinfo_table(int size);
+
+/**
+ * @brief Free an ifinfo table allocated by alloc_ifinfo_table().
+ * @param t A pointer to ifinfo table.
+ */
+void free_ifinfo_table(struct ifinfo_table *t);
+
 /**
  * @brief Get a pointer to a head of ifinfo list.
  * @return a pointer to a head of ifinfo list.
@@ -100,17 +162,46 @@ int get_ifinfo_list_size(void);
  */
 int set_ifinfo_list_size(int size);
 
+/**
+ * @brief Grow ifinfo list to store more ifinfo.
+ *
+ * ifinfo list is reallocated, so pointers to ifinfo got before are invalid after this.
+ *
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int grow_ifinfo_list(void);
+int grow_ifinfo_list_r(struct ifinfo_table *t);
+
 /**
  * @brief Get a pointer to ifinfo specified type by ifname.
+ *
+ * ifinfo is searched through a hash table by a network interface name.
+ *
  * @return If succeeded, it returns a pointer to a ifinfo specified type by ifname. If failed, it returns NULL.
  */
 struct ifinfo *search_ifinfo_by_ifname(const char *ifname);
+struct ifinfo *search_ifinfo_by_ifname_r(struct ifinfo_table *t, const char *ifname);
+
+/**
+ * @brief Get a pointer to ifinfo specified by an interface index.
+ *
+ * ifinfo is searched through a hash table by an interface index.
+ *
+ * @param ifindex An interface index.
+ * @return If succeeded, it returns a pointer to a ifinfo specified by ifindex. If failed, it returns NULL.
+ */
+struct ifinfo *search_ifinfo_by_ifindex(int ifindex);
+struct ifinfo *search_ifinfo_by_ifindex_r(struct ifinfo_table *t, int ifindex);
 
 /**
  * @brief Get a pointer to an empty ifinfo .
+ *
+ * If ifinfo list is full, it is grown by grow_ifinfo_list().
+ *
  * @return If succeeded, it returns a pointer to an empty ifinfo. If failed, it returns NULL.
  */
 struct ifinfo *get_empty_ifinfo(void);
+struct ifinfo *get_empty_ifinfo_r(struct ifinfo_table *t);
 
 /**
  * @brief Add a new ifinfo with a network interface name.
@@ -118,6 +209,25 @@ struct ifinfo *get_empty_ifinfo(void);
  * @return If succeeded, it returns 0. If failed, it returns -1.
  */
 int set_ifinfo_list_ifname(char *ifname);
+int set_ifinfo_list_ifname_r(struct ifinfo_table *t, char *ifname);
+
+/**
+ * @brief Rebuild hash tables of ifinfo list.
+ *
+ * Call this after a network interface name or an interface index in ifinfo list is changed directly.
+ *
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int rebuild_ifinfo_hash(void);
+int rebuild_ifinfo_hash_r(struct ifinfo_table *t);
+
+/**
+ * @brief Add a copy of a specified ifinfo to ifinfo list.
+ * @param ifi A pointer to ifinfo to be added.
+ * @return If succeeded, it returns a pointer to the added ifinfo. If failed, it returns NULL.
+ */
+struct ifinfo *add_ifinfo(const struct ifinfo *ifi);
+struct ifinfo *add_ifinfo_r(struct ifinfo_table *t, const struct ifinfo *ifi);
 
 /**
  * @brief Set an IP address and netmask to ifinfo with ifname.
@@ -127,6 +237,7 @@ int set_ifinfo_list_ifname(char *ifname);
  * @return If succeeded, it returns 0. If failed, it returns -1.
  */
 int set_ifinfo_addr(char *ifname, char *ipaddr, char *netmask);
+int set_ifinfo_addr_r(struct ifinfo_table *t, char *ifname, char *ipaddr, char *netmask);
 
 /**
  * @brief Set a MAC address to ifinfo with ifname.
@@ -135,6 +246,7 @@ int set_ifinfo_addr(char *ifname, char *ipaddr, char *netmask);
  * @return If succeeded, it returns 0. If failed, it returns -1.
  */
 int set_ifinfo_hwaddr(char *ifname, u_char *macaddr);
+int set_ifinfo_hwaddr_r(struct ifinfo_table *t, char *ifname, u_char *macaddr);
 
 /**
  * @brief Set a network interface type to ifinfo with ifname.
@@ -144,6 +256,7 @@ int set_ifinfo_hwaddr(char *ifname, u_char *macaddr);
  * @pre iftype is a value described in <net/if_arp.h>. For example, if a network interface is ethernet, iftype is 1 (ARPHRD_ETHER).
  */
 int set_ifinfo_iftype(char *ifname, int iftype);
+int set_ifinfo_iftype_r(struct ifinfo_table *t, char *ifname, int iftype);
 
 /**
  * @brief Set a port number of FDB to ifinfo with ifname.
@@ -152,6 +265,7 @@ int set_ifinfo_iftype(char *ifname, int iftype);
  * @return If succeeded, it returns 0. If failed, it returns -1.
  */
 int set_ifinfo_portno(char *ifname, u_int16_t port_no);
+int set_ifinfo_portno_r(struct ifinfo_table *t, char *ifname, u_int16_t port_no);
 
 /**
  * @brief Allocate a memory of ifinfo list.
@@ -170,16 +284,21 @@ void free_ifinfo_list(void);
  * @retrun If succeeded, it returns 0. If failed, it returns -1.
  */
 int open_netif(void);
+int open_netif_r(struct ifinfo_table *t);
 
 /**
  * @brief Close all opened file descripters and free a memory of ifinfo list.
+ *
+ * close_netif() also frees the interface type cache, close_netif_r() doesn't.
  */
 void close_netif(void);
+void close_netif_r(struct ifinfo_table *t);
 
 /**
  * @brief Print ifinfo list.
  */
 void print_ifinfo(void);
+void print_ifinfo_r(struct ifinfo_table *t);
 
 #ifdef __linux__
 #define IFNAME_LOOPBACK "lo"
@@ -190,6 +309,54 @@ void print_ifinfo(void);
  * @return If succeeded, it returns 0. If failed, it returns 0.
  */
 int read_ifinfo(void);
+int read_ifinfo_r(struct ifinfo_table *t);
+
+/**
+ * @brief Reconcile ifinfo list with current network interfaces.
+ *
+ * Only interfaces which appeared, disappeared or changed their addresses are
+ * touched. A new interface is classified and opened, a removed interface is
+ * closed, and the other interfaces keep their opened file descriptors.
+ *
+ * @return If succeeded, it returns a number of changed interfaces. If failed, it returns -1.
+ * @pre ifinfo list is already read by read_ifinfo() and opened by open_netif().
+ */
+int refresh_ifinfo(void);
+int refresh_ifinfo_r(struct ifinfo_table *t);
+
+/**
+ * @brief Remove ifinfo specified by an interface index and close its file descriptor.
+ * @param ifindex An interface index.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int remove_ifinfo_by_ifindex(int ifindex);
+int remove_ifinfo_by_ifindex_r(struct ifinfo_table *t, int ifindex);
+
+/**
+ * @brief Open a rtnetlink socket subscribed to link, IPv4 address and IPv6 address changes.
+ * @return If succeeded, it returns a non-blocking socket to be polled. If failed, it returns -1.
+ */
+int open_ifinfo_monitor(void);
+
+/**
+ * @brief Apply pending link and address change events to ifinfo list.
+ *
+ * A new interface is classified and opened, a removed interface is closed,
+ * and the changed flag is set for each appeared or changed interface.
+ *
+ * @param fd A socket opened by open_ifinfo_monitor().
+ * @return If succeeded, it returns a number of changed interfaces. If failed, it returns -1.
+ */
+int handle_ifinfo_monitor(int fd);
+int handle_ifinfo_monitor_r(struct ifinfo_table *t, int fd);
+
+/**
+ * @brief Wait for link and address change events.
+ * @param fd A socket opened by open_ifinfo_monitor(). If it's negative, it only sleeps.
+ * @param timeout A timeout in milliseconds.
+ * @return If events arrived, it returns 1. If timed out, it returns 0. If failed, it returns -1.
+ */
+int wait_ifinfo_monitor(int fd, int timeout);
 
 void print_netif(struct ifreq *ifr, struct ifconf *ifc);
 
@@ -226,6 +393,7 @@ int is_valid_ifaddr(struct ifaddrs *ifa);
  * @return If succeeded, it returns 0. If failed, it returns 0.
  */
 int read_net_type(void);
+int read_net_type_r(struct ifinfo_table *t);
 
 #ifdef __APPLE__
 /**
@@ -233,6 +401,7 @@ int read_net_type(void);
  * @return If succeed, it returns 0. If failed, it returns -1.
  */
 int read_ifinfo(void);
+int read_ifinfo_r(struct ifinfo_table *t);
 
 /**
  * @brief Print network interface information using getifaddrs().
@@ -0,0 +1,112 @@
+/**
+ * @file   intern.h
+ * @brief A library interning immutable strings.
+ *
+ * A header file of a library that keep one reference counted copy of each
+ * distinct string, so strings repeated by many objects, like a model name of
+ * thousands of devices, take memory once.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#include "slab.h"
+
+/** An initial size of a hash table of interned strings, a power of two */
+#define INTERN_TABLE_INIT_SIZE 64
+
+/** Arguments of printf() of an interned string by "%.*s", NULL is printed as empty */
+#define INTERN_STRING_ARG(s) ((s) != NULL ? (int) (s)->len : 0), ((s) != NULL ? (const char *) (s)->data : "")
+
+/**
+ * @brief An interned string, it must not be modified.
+ */
+struct intern_string {
+        /** A hash of the string */
+        u_int32_t hash;
+        /** A number of references */
+        u_int refcnt;
+        /** A length of the string */
+        u_int len;
+        /** The string, not terminated by NUL */
+        u_char data[];
+};
+
+/**
+ * @brief A table of interned strings.
+ */
+struct intern_table {
+        /** An open addressing hash table of strings */
+        struct intern_string **table;
+        /** A size of table, a power of two */
+        int size;
+        /** A number of strings */
+        int num;
+        /** Slabs of strings */
+        struct slab_classes slabs;
+};
+
+/**
+ * @brief Initialize an empty table of interned strings.
+ * @param t A pointer to a table.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int init_intern_table(struct intern_table *t);
+
+/**
+ * @brief Free a table and all its strings.
+ * @param t A pointer to a table.
+ */
+void destroy_intern_table(struct intern_table *t);
+
+/**
+ * @brief Get an interned string, it's added if not found.
+ * @param t A pointer to a table.
+ * @param data A string.
+ * @param len A length of the string.
+ * @return If succeeded, it returns a string with a new reference. If failed, it returns NULL.
+ */
+const struct intern_string *intern_string(struct intern_table *t, const u_char *data, u_int len);
+
+/**
+ * @brief Drop a reference of an interned string, it's removed by its last reference.
+ * @param t A pointer to a table.
+ * @param s A pointer to a string, NULL is ignored.
+ */
+void release_intern_string(struct intern_table *t, const struct intern_string *s);
+
+/**
+ * @brief Check whether an interned string equals to a string.
+ * @param s A pointer to a string, NULL equals to nothing.
+ * @param data A string.
+ * @param len A length of the string.
+ * @return If equal, it returns 1. If not, it returns 0.
+ */
+int match_intern_string(const struct intern_string *s, const u_char *data, u_int len);
+
+/**
+ * @brief Get a number of bytes of strings and the hash table of a table.
+ * @param t A pointer to a table.
+ * @return A number of bytes.
+ */
+size_t get_intern_table_bytes(const struct intern_table *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INTERN_H */
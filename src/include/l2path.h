@@ -0,0 +1,148 @@
+/**
+ * @file   l2path.h
+ * @brief A library answering path queries over an estimated layer 2 topology.
+ *
+ * A header file of a library that index a tree of a topology by an Euler tour
+ * and a sparse table, so the lowest common ancestor of two nodes is found in
+ * constant time and a path between them in time linear in its length. The
+ * index is built again only when the topology changes.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef L2PATH_H
+#define L2PATH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#include "topology.h"
+
+/**
+ * @brief A node on a path, with ports traffic enters and leaves it by.
+ */
+struct l2path_hop {
+        /** An index of a node of the topology */
+        int node;
+        /** An index of a port traffic enters by, -1 for an end or a node without ports */
+        int in_port;
+        /** An index of a port traffic leaves by, -1 for an end or a node without ports */
+        int out_port;
+};
+
+/**
+ * @brief An index of paths of a topology.
+ *
+ * Nodes without a parent, like the root and devices not attached anywhere,
+ * hang from a virtual root, so trees of a forest share one tour. Nodes under
+ * the virtual root only are not connected.
+ */
+struct l2path {
+        /** A topology */
+        struct topology *topology;
+        /** A generation of the topology the index was built at */
+        u_int64_t generation;
+        /** 1 if the index is built */
+        int built;
+        /** A number of nodes, the virtual root is the node of this index */
+        int node_num;
+        /** A size of arrays of nodes */
+        int node_size;
+        /** Parents of nodes, -1 for the virtual root */
+        int *parent;
+        /** Ports of parents nodes are attached to, -1 for a segment or the virtual root */
+        int *parent_port;
+        /** Ports of nodes toward their parents, -1 if not a switch port */
+        int *uplink;
+        /** Depths of nodes, the virtual root is 0 */
+        int *depth;
+        /** First positions of nodes in the tour */
+        int *first;
+        /** First children of nodes, -1 if none */
+        int *child;
+        /** Next siblings of nodes, -1 if none */
+        int *sibling;
+        /** Nodes in the order of an Euler tour */
+        int *tour;
+        /** A number of positions of the tour */
+        int tour_num;
+        /** Levels of a sparse table, a level k keeps a shallowest node of 2^k positions */
+        int *sparse;
+        /** A number of levels of the sparse table */
+        int levels;
+};
+
+/**
+ * @brief Allocate an empty index of paths of a topology, it's built on the first query.
+ * @param t A pointer to a topology, it must outlive the index.
+ * @return If succeeded, it returns an allocated pointer. If failed, it returns NULL.
+ */
+struct l2path *alloc_l2path(struct topology *t);
+
+/**
+ * @brief Free an index of paths.
+ * @param p A pointer to an index, NULL is ignored.
+ */
+void free_l2path(struct l2path *p);
+
+/**
+ * @brief Refresh a topology, and build the index again if the topology changed.
+ * @param p A pointer to an index.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int refresh_l2path(struct l2path *p);
+
+/**
+ * @brief Find the lowest common ancestor of two nodes in constant time.
+ * @param p A pointer to an index refreshed by refresh_l2path().
+ * @param a An index of a node.
+ * @param b An index of a node.
+ * @return If connected, it returns an index of the ancestor. If not, it returns -1.
+ */
+int find_l2path_ancestor(struct l2path *p, int a, int b);
+
+/**
+ * @brief Get a path between two nodes, in time linear in its length.
+ * @param p A pointer to an index refreshed by refresh_l2path().
+ * @param a An index of a node the path starts at.
+ * @param b An index of a node the path ends at.
+ * @param hops Hops of the path from a to b.
+ * @param max A size of hops.
+ * @return If connected, it returns a number of hops, it may be larger than max. If not, it returns -1.
+ */
+int get_l2path(struct l2path *p, int a, int b, struct l2path_hop *hops, int max);
+
+/**
+ * @brief Get a path between two MAC addresses, the index is refreshed first.
+ * @param p A pointer to an index.
+ * @param a A MAC address the path starts at.
+ * @param b A MAC address the path ends at.
+ * @param hops Hops of the path from a to b.
+ * @param max A size of hops.
+ * @return If connected, it returns a number of hops, it may be larger than max. If not or unknown, it returns -1.
+ */
+int get_l2path_by_macaddr(struct l2path *p, const u_int8_t a[], const u_int8_t b[],
+        struct l2path_hop *hops, int max);
+
+/**
+ * @brief Print hops of a path.
+ * @param p A pointer to an index.
+ * @param hops Hops by get_l2path().
+ * @param num A number of hops.
+ */
+void print_l2path(struct l2path *p, const struct l2path_hop *hops, int num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* L2PATH_H */
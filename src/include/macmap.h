@@ -0,0 +1,157 @@
+/**
+ * @file   macmap.h
+ * @brief A library of a hash map keyed by MAC addresses.
+ *
+ * A header file of a library that map 64-bit keys, like a MAC address packed
+ * by get_fdb_key(), to indexes by an open addressing hash table probed by
+ * groups of slots. A table is changed by one writer, and read by other threads
+ * at the same time if they register as readers.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef MACMAP_H
+#define MACMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+/** A number of slots of a group, matched at once */
+#define MACMAP_GROUP_SIZE 16
+/** The max number of readers of a map */
+#define MACMAP_MAX_READERS 64
+
+struct macmap_table;
+struct macmap_reader;
+
+/**
+ * @brief A hash map from 64-bit keys to non-negative values.
+ *
+ * A slot has a control byte, empty, deleted, or 7 bits of a hash of its key,
+ * so a probe compares control bytes of a group by a vector instruction and
+ * looks at keys only for matched bytes. A deleted slot isn't used again
+ * until the table is rehashed, and a replaced table is freed after all
+ * readers leave it, so a reader never sees a slot changing under it.
+ */
+struct macmap {
+        /** A current table */
+        struct macmap_table *table;
+        /** A number of keys */
+        int num;
+        /** A number of used slots, keys and deleted slots */
+        int used;
+        /** An epoch, incremented when a table is replaced */
+        u_int64_t epoch;
+        /** Replaced tables waiting for readers */
+        struct macmap_table *retired;
+        /** Readers, NULL if the map has no readers */
+        struct macmap_reader *readers;
+        /** A number of readers */
+        int reader_num;
+};
+
+/**
+ * @brief Initialize an empty map.
+ * @param m A pointer to a map.
+ * @param readers The max number of readers other than the writer, 0 to MACMAP_MAX_READERS.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int init_macmap(struct macmap *m, int readers);
+
+/**
+ * @brief Free tables of a map, no reader may be in it.
+ * @param m A pointer to a map, a map not initialized and zero filled is ignored.
+ */
+void destroy_macmap(struct macmap *m);
+
+/**
+ * @brief Check whether a map is initialized.
+ * @param m A pointer to a map.
+ * @return If initialized, it returns 1. If not, it returns 0.
+ */
+int is_macmap_initialized(const struct macmap *m);
+
+/**
+ * @brief Find a value of a key, by the writer or a reader in enter_macmap().
+ * @param m A pointer to a map, a map not initialized and zero filled has no keys.
+ * @param key A key.
+ * @return If found, it returns the value. If not, it returns -1.
+ */
+int find_macmap(const struct macmap *m, u_int64_t key);
+
+/**
+ * @brief Add a key unless it's already in a map, by the writer.
+ * @param m A pointer to a map.
+ * @param key A key.
+ * @param value A value, not negative.
+ * @return If added, it returns 0. If already in the map, it returns 1 and the value is kept. If failed, it returns -1.
+ */
+int add_macmap(struct macmap *m, u_int64_t key, int value);
+
+/**
+ * @brief Remove a key from a map, by the writer.
+ * @param m A pointer to a map.
+ * @param key A key.
+ * @return If removed, it returns 0. If not found, it returns -1.
+ */
+int remove_macmap(struct macmap *m, u_int64_t key);
+
+/**
+ * @brief Remove all keys from a map, by the writer.
+ * @param m A pointer to a map.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int clear_macmap(struct macmap *m);
+
+/**
+ * @brief Register a reader of a map.
+ * @param m A pointer to a map.
+ * @return If succeeded, it returns an ID of the reader. If no room, it returns -1.
+ */
+int register_macmap_reader(struct macmap *m);
+
+/**
+ * @brief Unregister a reader of a map, it must not be in the map.
+ * @param m A pointer to a map.
+ * @param reader An ID of the reader.
+ */
+void unregister_macmap_reader(struct macmap *m, int reader);
+
+/**
+ * @brief Start reading a map by a reader, tables it sees are kept until it leaves.
+ * @param m A pointer to a map.
+ * @param reader An ID of the reader.
+ */
+void enter_macmap(struct macmap *m, int reader);
+
+/**
+ * @brief Stop reading a map by a reader.
+ * @param m A pointer to a map.
+ * @param reader An ID of the reader.
+ */
+void leave_macmap(struct macmap *m, int reader);
+
+/**
+ * @brief Free replaced tables no reader is in, by the writer.
+ *
+ * It's also done when a table is replaced.
+ *
+ * @param m A pointer to a map.
+ * @return A number of tables still waiting for readers.
+ */
+int reclaim_macmap(struct macmap *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MACMAP_H */
@@ -0,0 +1,300 @@
+/**
+ * @file   neighbor.h
+ * @brief A library of a neighbor database collected from HTIP frames.
+ *
+ * A header file of a library that keep HTIP devices by chassis ID and port ID
+ * with their device information and link information until their TTL expire.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef NEIGHBOR_H
+#define NEIGHBOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#include "intern.h"
+#include "slab.h"
+#include "timer.h"
+#include "tlv.h"
+
+/** An initial size of a neighbor hash table, a power of two */
+#define NEIGHBOR_DB_INIT_SIZE 64
+/** The max number of MAC addresses of a link, a frame can't take more memory */
+#define NEIGHBOR_MAX_MACADDR_NUM 1024
+/** The max number of links of a neighbor, every port number a link information can carry */
+#define NEIGHBOR_MAX_LINK_NUM 65536
+/** A length of a tick of a timing wheel expiring neighbors in milliseconds */
+#define NEIGHBOR_TIMER_RESOLUTION 100
+/** The max length of a device category */
+#define NEIGHBOR_DEVICE_CATEGORY_LEN 255
+/** The max length of a manufacturer code */
+#define NEIGHBOR_MANUFACTURER_CODE_LEN HTIP_DEVICE_INFO_MANUFACTURER_CODE_LEN
+/** The max length of a model name */
+#define NEIGHBOR_MODEL_NAME_LEN 31
+/** The max length of a model number */
+#define NEIGHBOR_MODEL_NUMBER_LEN 31
+
+/* changes by update_neighbor() and expire_neighbor() */
+/** A neighbor was added */
+#define NEIGHBOR_ADDED                  0x01
+/** A device information changed */
+#define NEIGHBOR_DEVICE_CHANGED         0x02
+/** A link was added */
+#define NEIGHBOR_LINK_ADDED             0x04
+/** MAC addresses of a link changed, its changed is the frame number of the change */
+#define NEIGHBOR_LINK_CHANGED           0x08
+/** A link expired */
+#define NEIGHBOR_LINK_REMOVED           0x10
+/** MAC addresses in MAC address list TLVs changed */
+#define NEIGHBOR_MAC_LIST_CHANGED       0x20
+
+/**
+ * @brief A set of MAC addresses with its expiring time.
+ */
+struct neighbor_macset {
+        /** A time when the set expires by get_monotonic_msec() */
+        u_int64_t expire;
+        /** A frame number the set was replaced, fragments of the same frame are appended */
+        u_int64_t frame;
+        /** A frame number the set changed last */
+        u_int64_t changed;
+        /** A digest of MAC addresses independent of their order */
+        u_int32_t digest;
+        /** A digest before the current frame */
+        u_int32_t prev_digest;
+        /** A number of MAC addresses before the current frame */
+        int prev_num;
+        /** A number of MAC addresses */
+        int macaddr_num;
+        /** A size of macaddrs in MAC addresses */
+        int macaddr_size;
+        /** MAC addresses, ETHER_ADDR_LEN bytes each */
+        u_int8_t *macaddrs;
+};
+
+/**
+ * @brief A link information of a neighbor, a port and MAC addresses beyond it.
+ */
+struct neighbor_link {
+        /** A port number */
+        u_int16_t port_no;
+        /** A network interface type (IANAifType) */
+        u_int32_t iftype;
+        /** MAC addresses */
+        struct neighbor_macset macset;
+};
+
+/**
+ * @brief A neighbor, a network interface of a HTIP device.
+ */
+struct neighbor {
+        /** A hash of chassis ID and port ID */
+        u_int32_t hash;
+        /** A time when the neighbor expires by get_monotonic_msec() */
+        u_int64_t expire;
+        /** A timer at the earliest expiring time of the neighbor, its links and its MAC address list */
+        struct timer_node timer;
+        /** A TTL in the last frame in seconds */
+        u_int16_t ttl;
+        /** A transmission interval in the last frame in seconds, 0 if not advertised */
+        u_int16_t interval;
+        /** A CRC32C of the LLDPDU of the last frame applied fully, 0 if not known */
+        u_int32_t crc;
+        /** A device category, NULL if not advertised */
+        const struct intern_string *device_category;
+        /** A manufacturer code, NULL if not advertised */
+        const struct intern_string *manufacturer_code;
+        /** A model name, NULL if not advertised */
+        const struct intern_string *model_name;
+        /** A model number, NULL if not advertised */
+        const struct intern_string *model_number;
+        /** Links */
+        struct neighbor_link *links;
+        /** A number of links */
+        int link_num;
+        /** A size of links */
+        int link_size;
+        /** MAC addresses in MAC address list TLVs */
+        struct neighbor_macset mac_list;
+        /** A chassis ID with its subtype */
+        const struct intern_string *chassis_id;
+        /** A port ID with its subtype */
+        const struct intern_string *port_id;
+};
+
+/**
+ * @brief Functions called on changes of a neighbor database.
+ */
+struct neighbor_hook {
+        /**
+         * @brief Called after a neighbor is added or changed, not for a frame without changes.
+         * @param arg An argument of the hook.
+         * @param n A pointer to the neighbor.
+         * @param flags Changes, NEIGHBOR_ADDED and so on.
+         */
+        void (*updated)(void *arg, struct neighbor *n, int flags);
+        /**
+         * @brief Called before a neighbor is removed by TTL 0 or its expiry.
+         * @param arg An argument of the hook.
+         * @param n A pointer to the neighbor.
+         */
+        void (*removed)(void *arg, struct neighbor *n);
+        /** An argument of the hook */
+        void *arg;
+};
+
+/**
+ * @brief A neighbor database.
+ *
+ * IDs and device information are interned, so a string repeated by many
+ * devices, like a model name, is kept once. Neighbors, links and MAC addresses
+ * are allocated from slabs, so a frame doesn't call malloc() once enough pages
+ * are allocated.
+ */
+struct neighbor_db {
+        /** An open addressing hash table of neighbors keyed by chassis ID and port ID */
+        struct neighbor **table;
+        /** A size of table, a power of two */
+        int size;
+        /** A number of neighbors */
+        int num;
+        /** A number of updated frames */
+        u_int64_t frame;
+        /** Incremented for each change of neighbors */
+        u_int64_t generation;
+        /** Functions called on changes */
+        struct neighbor_hook hook;
+        /** A timing wheel expiring neighbors */
+        struct timer_wheel wheel;
+        /** Interned IDs and device information */
+        struct intern_table strings;
+        /** A slab of neighbors */
+        struct slab neighbors;
+        /** Slabs of arrays of links and MAC addresses */
+        struct slab_classes arrays;
+};
+
+/**
+ * @brief Allocate an empty neighbor database.
+ * @return If succeeded, it returns an allocated pointer. If failed, it returns NULL.
+ */
+struct neighbor_db *alloc_neighbor_db(void);
+
+/**
+ * @brief Free a neighbor database and its neighbors.
+ * @param db A pointer to a neighbor database, NULL is ignored.
+ */
+void free_neighbor_db(struct neighbor_db *db);
+
+/**
+ * @brief Set functions called on changes of a neighbor database.
+ * @param db A pointer to a neighbor database.
+ * @param hook A pointer to functions, NULL to clear them.
+ */
+void set_neighbor_hook(struct neighbor_db *db, const struct neighbor_hook *hook);
+
+/**
+ * @brief Get a number of neighbors.
+ * @param db A pointer to a neighbor database.
+ * @return A number of neighbors.
+ */
+int get_neighbor_num(struct neighbor_db *db);
+
+/**
+ * @brief Get a number of bytes of neighbors, their arrays and interned strings.
+ * @param db A pointer to a neighbor database.
+ * @return A number of bytes.
+ */
+size_t get_neighbor_db_bytes(struct neighbor_db *db);
+
+/**
+ * @brief Find a neighbor.
+ * @param db A pointer to a neighbor database.
+ * @param chassis_id A chassis ID with its subtype.
+ * @param chassis_id_len A length of the chassis ID.
+ * @param port_id A port ID with its subtype.
+ * @param port_id_len A length of the port ID.
+ * @return If found, it returns a pointer to the neighbor. If not, it returns NULL.
+ */
+struct neighbor *find_neighbor(struct neighbor_db *db, const u_char *chassis_id, u_int chassis_id_len,
+        const u_char *port_id, u_int port_id_len);
+
+/**
+ * @brief Add or update a neighbor by a decoded LLDPDU.
+ *
+ * A neighbor is found by a hash of chassis ID and port ID, so the cost doesn't
+ * grow with the number of neighbors. A TTL of 0 removes the neighbor. MAC
+ * addresses of a link are compared by a digest, so a repeated frame is found
+ * unchanged without sorting them.
+ *
+ * @param db A pointer to a neighbor database.
+ * @param du A pointer to a decoded LLDPDU.
+ * @param crc A CRC32C of the LLDPDU for refresh_neighbor(), 0 if not known.
+ * @param now A current time by get_monotonic_msec().
+ * @return If succeeded, it returns changes, NEIGHBOR_ADDED and so on, 0 if nothing changed. If failed, it returns -1,
+ * the rest of the frame is still applied and its changes are passed to the hook.
+ */
+int update_neighbor(struct neighbor_db *db, const struct htip_lldpdu *du, u_int32_t crc, u_int64_t now);
+
+/**
+ * @brief Extend a TTL of a neighbor by a frame same as the last one, without decoding it.
+ *
+ * A frame is the same only if its CRC32C is the one of the last frame given to
+ * update_neighbor(), so a cache of another thread which saw an older frame
+ * from the neighbor doesn't bring it back.
+ *
+ * @param db A pointer to a neighbor database.
+ * @param chassis_id A chassis ID with its subtype.
+ * @param chassis_id_len A length of the chassis ID.
+ * @param port_id A port ID with its subtype.
+ * @param port_id_len A length of the port ID.
+ * @param ttl A TTL in the frame in seconds.
+ * @param crc A CRC32C of the LLDPDU of the frame.
+ * @param now A current time by get_monotonic_msec().
+ * @return If succeeded, it returns 0. If the neighbor isn't found, the frame differs or the TTL is 0, it returns -1.
+ */
+int refresh_neighbor(struct neighbor_db *db, const u_char *chassis_id, u_int chassis_id_len,
+        const u_char *port_id, u_int port_id_len, u_int16_t ttl, u_int32_t crc, u_int64_t now);
+
+/**
+ * @brief Remove expired neighbors, links and MAC address lists.
+ *
+ * Only neighbors whose timers expire are visited, so the cost doesn't grow
+ * with the number of neighbors.
+ *
+ * @param db A pointer to a neighbor database.
+ * @param now A current time by get_monotonic_msec().
+ * @return A number of removed neighbors.
+ */
+int expire_neighbor(struct neighbor_db *db, u_int64_t now);
+
+/**
+ * @brief Print a neighbor.
+ * @param n A pointer to a neighbor.
+ * @param now A current time by get_monotonic_msec().
+ */
+void print_neighbor(const struct neighbor *n, u_int64_t now);
+
+/**
+ * @brief Print all neighbors.
+ * @param db A pointer to a neighbor database.
+ * @param now A current time by get_monotonic_msec().
+ */
+void print_neighbor_db(struct neighbor_db *db, u_int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NEIGHBOR_H */
@@ -0,0 +1,139 @@
+/**
+ * @file   netlink.h
+ * @brief A library handling rtnetlink messages.
+ *
+ * A header file of a library that read network interface information
+ * from the kernel through rtnetlink.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __linux__
+#include <sys/types.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <linux/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#define RTNL_BUF_SIZE 32768
+#define RTNL_KIND_LEN 16
+
+/**
+ * @brief A network interface reported by RTM_NEWLINK or RTM_DELLINK.
+ */
+struct rtnl_link {
+        /** An interface index */
+        int ifindex;
+        /** A name of network interface */
+        char ifname[IFNAMSIZ];
+        /** A MAC address */
+        u_char macaddr[ETHER_ADDR_LEN];
+        /** A hardware type described in <net/if_arp.h> */
+        u_int16_t hwtype;
+        /** Interface flags (IFF_*) */
+        u_int32_t flags;
+        /** An interface index of the master (bridge) device, 0 if none */
+        int master;
+        /** An operational state (IF_OPER_*) */
+        u_char operstate;
+        /** A link kind such as "bridge" or "veth", empty for physical devices */
+        char kind[RTNL_KIND_LEN];
+};
+
+/**
+ * @brief An interface address reported by RTM_NEWADDR or RTM_DELADDR.
+ */
+struct rtnl_addr {
+        /** An interface index */
+        int ifindex;
+        /** An address family (AF_INET or AF_INET6) */
+        u_char family;
+        /** A prefix length */
+        u_char prefixlen;
+        /** Address flags (IFA_F_*) */
+        u_int32_t flags;
+        /** An ip address */
+        char ipaddr[INET6_ADDRSTRLEN];
+        /** A netmask */
+        char netmask[INET6_ADDRSTRLEN];
+};
+
+/**
+ * @brief Open a rtnetlink socket.
+ * @param groups A bit mask of multicast groups (RTMGRP_*) to subscribe, 0 for none.
+ * A socket subscribing any group is non-blocking.
+ * @return If succeeded, it returns an opened socket. If failed, it returns -1.
+ */
+int rtnl_open(u_int32_t groups);
+
+/**
+ * @brief Request a dump of all objects of a specified type.
+ * @param fd A rtnetlink socket.
+ * @param type A request type such as RTM_GETLINK or RTM_GETADDR.
+ * @param family An address family, AF_UNSPEC for all.
+ * @param seq A sequence number of the request.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int rtnl_dump_request(int fd, u_int16_t type, u_char family, u_int32_t seq);
+
+/**
+ * @brief Receive a batch of rtnetlink messages.
+ * @param fd A rtnetlink socket.
+ * @param buf A receive buffer, RTNL_BUF_SIZE bytes are recommended.
+ * @param len A length of the buffer.
+ * @return If succeeded, it returns received bytes. If nothing to read on a non-blocking socket, it returns 0. If failed, it returns -1 and errno is set (ENOBUFS if events were dropped).
+ */
+int rtnl_recv(int fd, void *buf, size_t len);
+
+/**
+ * @brief Request a dump and pass each received message to a handler.
+ *
+ * Each dump takes a new sequence number atomically, so dumps on different
+ * sockets may run on different threads.
+ *
+ * @param fd A rtnetlink socket.
+ * @param type A request type such as RTM_GETLINK or RTM_GETADDR.
+ * @param family An address family, AF_UNSPEC for all.
+ * @param handler A function called for each message with arg.
+ * @param arg An argument passed to handler.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int rtnl_dump(int fd, u_int16_t type, u_char family,
+        int (*handler)(const struct nlmsghdr *nh, void *arg), void *arg);
+
+/**
+ * @brief Parse a link message.
+ * @param nh A pointer to a RTM_NEWLINK or RTM_DELLINK message.
+ * @param link A pointer to store the parsed link.
+ * @return If succeeded, it returns 0. If the message is not a link message, it returns -1.
+ */
+int rtnl_parse_link(const struct nlmsghdr *nh, struct rtnl_link *link);
+
+/**
+ * @brief Parse an address message.
+ * @param nh A pointer to a RTM_NEWADDR or RTM_DELADDR message.
+ * @param addr A pointer to store the parsed address.
+ * @return If succeeded, it returns 0. If the message is not an address message, it returns -1.
+ */
+int rtnl_parse_addr(const struct nlmsghdr *nh, struct rtnl_addr *addr);
+#endif /* __linux__ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NETLINK_H */
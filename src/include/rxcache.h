@@ -0,0 +1,130 @@
+/**
+ * @file   rxcache.h
+ * @brief A library of a cache of received LLDPDUs.
+ *
+ * A header file of a library that keep a CRC32C of the last LLDPDU from each
+ * source MAC address and network interface, so a frame same as the last one is
+ * found without decoding it.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef RXCACHE_H
+#define RXCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "tlv.h"
+
+/** An initial size of a cache, a power of two */
+#define RXCACHE_INIT_SIZE 64
+
+/**
+ * @brief An entry of a cache, the last LLDPDU from a source.
+ */
+struct rxcache_entry {
+        /** A source MAC address by get_fdb_key() */
+        u_int64_t key;
+        /** An interface index the LLDPDU came from, 0 is empty */
+        int ifindex;
+        /** A CRC32C of the LLDPDU */
+        u_int32_t crc;
+        /** A length of the LLDPDU */
+        u_int len;
+        /** A time when the entry expires by get_monotonic_msec() */
+        u_int64_t expire;
+        /** A TTL in the LLDPDU in seconds */
+        u_int16_t ttl;
+        /** An offset of the chassis ID with its subtype in the LLDPDU */
+        u_int16_t chassis_id_off;
+        /** A length of the chassis ID */
+        u_int16_t chassis_id_len;
+        /** An offset of the port ID with its subtype in the LLDPDU */
+        u_int16_t port_id_off;
+        /** A length of the port ID */
+        u_int16_t port_id_len;
+};
+
+/**
+ * @brief A cache of received LLDPDUs.
+ */
+struct rxcache {
+        /** An open addressing hash table keyed by a source MAC address and an interface index */
+        struct rxcache_entry *entries;
+        /** A size of entries, a power of two */
+        int size;
+        /** A number of entries */
+        int num;
+        /** A number of LLDPDUs same as the last one */
+        u_int64_t hits;
+        /** A number of other LLDPDUs */
+        u_int64_t misses;
+};
+
+/**
+ * @brief Allocate an empty cache.
+ * @return If succeeded, it returns an allocated pointer. If failed, it returns NULL.
+ */
+struct rxcache *alloc_rxcache(void);
+
+/**
+ * @brief Free a cache.
+ * @param c A pointer to a cache, NULL is ignored.
+ */
+void free_rxcache(struct rxcache *c);
+
+/**
+ * @brief Find a frame same as the last one from its source.
+ *
+ * It costs a CRC32C of the LLDPDU and a lookup of the source. The entry of a
+ * found frame is extended by its TTL.
+ *
+ * @param c A pointer to a cache.
+ * @param frame A frame with its ethernet header.
+ * @param len A length of the frame.
+ * @param ifindex An interface index the frame came from.
+ * @param now A current time by get_monotonic_msec().
+ * @param crc A pointer to store a CRC32C of the LLDPDU for store_rxcache().
+ * @return If found, it returns a pointer to the entry. If not, it returns NULL.
+ */
+const struct rxcache_entry *find_rxcache(struct rxcache *c, const u_char *frame, u_int len,
+        int ifindex, u_int64_t now, u_int32_t *crc);
+
+/**
+ * @brief Store a decoded frame as the last one from its source, a TTL of 0 removes it.
+ * @param c A pointer to a cache.
+ * @param frame A frame with its ethernet header.
+ * @param len A length of the frame.
+ * @param ifindex An interface index the frame came from, a frame is ignored if it's not positive.
+ * @param crc A CRC32C of the LLDPDU by find_rxcache().
+ * @param du A pointer to the LLDPDU decoded from the frame.
+ * @param now A current time by get_monotonic_msec().
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int store_rxcache(struct rxcache *c, const u_char *frame, u_int len, int ifindex, u_int32_t crc,
+        const struct htip_lldpdu *du, u_int64_t now);
+
+/**
+ * @brief Remove expired entries.
+ * @param c A pointer to a cache.
+ * @param now A current time by get_monotonic_msec().
+ * @return A number of removed entries.
+ */
+int expire_rxcache(struct rxcache *c, u_int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RXCACHE_H */
@@ -0,0 +1,158 @@
+/**
+ * @file   rxring.h
+ * @brief A library of a ring passing received LLDPDUs between threads.
+ *
+ * A header file of a library that pass frames decoded by receiving threads to
+ * a single thread owning a neighbor database, through a bounded lock-free ring
+ * of fixed-size records. A producer never blocks, a frame is dropped if the
+ * ring is full.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef RXRING_H
+#define RXRING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "tlv.h"
+
+/** A record with a decoded LLDPDU */
+#define RXRING_RECORD_DECODED 1
+/** A record with a frame not decoded, like a frame same as the last one from its source */
+#define RXRING_RECORD_RAW 2
+/** A record with a malformed LLDPDU, skipped by read_rxring() */
+#define RXRING_RECORD_MALFORMED 3
+
+/**
+ * @brief A ring, its members are private to rxring.c.
+ */
+struct rxring;
+
+/**
+ * @brief A record of a received frame, owned by a producer until published and by the consumer until released.
+ */
+struct rxring_record {
+        /** A state, RXRING_RECORD_* */
+        int status;
+        /** A source MAC address */
+        u_int8_t macaddr[ETHER_ADDR_LEN];
+        /** An interface index the frame came from */
+        int ifindex;
+        /** A time the frame was received by get_monotonic_msec() */
+        u_int64_t time;
+        /** A frame with its ethernet header, in a slab slot of the record */
+        u_char *frame;
+        /** A length of the frame */
+        u_int len;
+        /** A CRC32C of the LLDPDU, 0 if not computed */
+        u_int32_t crc;
+        /** A decoded LLDPDU, pointers point into frame */
+        struct htip_lldpdu du;
+};
+
+/**
+ * @brief Counters of a ring.
+ */
+struct rxring_stats {
+        /** A number of published records */
+        u_int64_t written;
+        /** A number of frames dropped because the ring was full */
+        u_int64_t dropped;
+        /** A number of malformed LLDPDUs */
+        u_int64_t malformed;
+};
+
+/**
+ * @brief Allocate a ring.
+ * @param size A number of records, rounded up to a power of two.
+ * @return If succeeded, it returns an allocated pointer. If failed, it returns NULL.
+ */
+struct rxring *alloc_rxring(int size);
+
+/**
+ * @brief Free a ring, no thread may use it.
+ * @param r A pointer to a ring, NULL is ignored.
+ */
+void free_rxring(struct rxring *r);
+
+/**
+ * @brief Claim a record to write, called by any producer.
+ * @param r A pointer to a ring.
+ * @return If succeeded, it returns a record to be published. If the ring is full, it returns NULL and counts a drop.
+ */
+struct rxring_record *claim_rxring(struct rxring *r);
+
+/**
+ * @brief Copy a frame into a claimed record.
+ * @param rec A pointer to a claimed record.
+ * @param frame A frame with its ethernet header.
+ * @param len A length of the frame, longer frames are truncated to ETHER_MAX_LEN.
+ * @param ifindex An interface index the frame came from.
+ * @param now A current time by get_monotonic_msec().
+ * @param decode 1 to decode the LLDPDU, 0 to leave it raw.
+ * @return If succeeded, it returns 0. If the LLDPDU is malformed, it returns -1 and the record is marked malformed.
+ */
+int fill_rxring_record(struct rxring_record *rec, const u_char *frame, u_int len, int ifindex,
+        u_int64_t now, int decode);
+
+/**
+ * @brief Publish a claimed record to the consumer, a claimed record must be published.
+ * @param r A pointer to a ring.
+ * @param rec A pointer to a record by claim_rxring().
+ */
+void publish_rxring(struct rxring *r, struct rxring_record *rec);
+
+/**
+ * @brief Claim, decode and publish a frame.
+ * @param r A pointer to a ring.
+ * @param frame A frame with its ethernet header.
+ * @param len A length of the frame.
+ * @param ifindex An interface index the frame came from.
+ * @param now A current time by get_monotonic_msec().
+ * @return If succeeded, it returns 0. If dropped or malformed, it returns -1.
+ */
+int write_rxring(struct rxring *r, const u_char *frame, u_int len, int ifindex, u_int64_t now);
+
+/**
+ * @brief Read published records in order, called by the single consumer.
+ *
+ * Records stay valid until release_rxring(). A record not published yet stops
+ * the batch, so it never waits for a producer.
+ *
+ * @param r A pointer to a ring.
+ * @param records An array to store pointers to records.
+ * @param max A size of the array.
+ * @return A number of stored records, malformed records are skipped.
+ */
+int read_rxring(struct rxring *r, struct rxring_record **records, int max);
+
+/**
+ * @brief Give records by the last read_rxring() back to producers.
+ * @param r A pointer to a ring.
+ */
+void release_rxring(struct rxring *r);
+
+/**
+ * @brief Get counters of a ring.
+ * @param r A pointer to a ring.
+ * @param stats A pointer to store counters.
+ */
+void get_rxring_stats(struct rxring *r, struct rxring_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RXRING_H */
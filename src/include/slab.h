@@ -0,0 +1,147 @@
+/**
+ * @file   slab.h
+ * @brief A library of slab allocators of fixed-size objects.
+ *
+ * A header file of a library that carve fixed-size objects out of large pages
+ * and keep freed objects on a free list, so allocating and freeing an object
+ * don't call malloc() once enough pages are allocated.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stddef.h>
+
+/** A size of a page of a slab in bytes, a page has one object at least */
+#define SLAB_PAGE_SIZE 16384
+/** A shift of the size of the smallest class of slabs */
+#define SLAB_CLASS_MIN_SHIFT 4
+/** A number of classes of slabs, sizes are powers of two from 16 bytes to 64 KB */
+#define SLAB_CLASS_NUM 13
+
+/**
+ * @brief A slab allocator of fixed-size objects.
+ *
+ * Pages are kept until the slab is destroyed, a freed object is reused by the
+ * next allocation.
+ */
+struct slab {
+        /** A size of an object, aligned to a pointer */
+        size_t object_size;
+        /** A number of objects of a page */
+        int page_objects;
+        /** A free list of objects, linked by their first word */
+        void *free;
+        /** A list of pages, linked by their first word */
+        void *pages;
+        /** A number of pages */
+        int page_num;
+        /** A number of allocated objects */
+        int num;
+};
+
+/**
+ * @brief Slab allocators of objects whose sizes are powers of two.
+ */
+struct slab_classes {
+        /** Slabs from the smallest class */
+        struct slab slabs[SLAB_CLASS_NUM];
+};
+
+/**
+ * @brief Initialize an empty slab.
+ * @param s A pointer to a slab.
+ * @param object_size A size of an object.
+ */
+void init_slab(struct slab *s, size_t object_size);
+
+/**
+ * @brief Free all pages of a slab, objects of it can't be used after that.
+ * @param s A pointer to a slab.
+ */
+void destroy_slab(struct slab *s);
+
+/**
+ * @brief Allocate an object from a slab.
+ * @param s A pointer to a slab.
+ * @return If succeeded, it returns a pointer to an uninitialized object. If failed, it returns NULL.
+ */
+void *alloc_slab_object(struct slab *s);
+
+/**
+ * @brief Return an object to a slab.
+ * @param s A pointer to a slab the object was allocated from.
+ * @param p A pointer to an object, NULL is ignored.
+ */
+void free_slab_object(struct slab *s, void *p);
+
+/**
+ * @brief Get a number of bytes of pages of a slab.
+ * @param s A pointer to a slab.
+ * @return A number of bytes.
+ */
+size_t get_slab_bytes(const struct slab *s);
+
+/**
+ * @brief Initialize empty slabs of all classes.
+ * @param c A pointer to slab classes.
+ */
+void init_slab_classes(struct slab_classes *c);
+
+/**
+ * @brief Free all pages of slabs of all classes.
+ * @param c A pointer to slab classes.
+ */
+void destroy_slab_classes(struct slab_classes *c);
+
+/**
+ * @brief Allocate an object from the smallest class not smaller than a size.
+ *
+ * A size larger than the largest class is allocated by malloc().
+ *
+ * @param c A pointer to slab classes.
+ * @param size A size of an object.
+ * @return If succeeded, it returns a pointer to an uninitialized object. If failed, it returns NULL.
+ */
+void *alloc_slab_size(struct slab_classes *c, size_t size);
+
+/**
+ * @brief Return an object allocated by alloc_slab_size().
+ * @param c A pointer to slab classes.
+ * @param p A pointer to an object, NULL is ignored.
+ * @param size A size passed to alloc_slab_size().
+ */
+void free_slab_size(struct slab_classes *c, void *p, size_t size);
+
+/**
+ * @brief Get a size of the class an object of a size is allocated from.
+ * @param size A size of an object.
+ * @return A size of the class, or the size itself if it's larger than the largest class.
+ */
+size_t get_slab_class_size(size_t size);
+
+/**
+ * @brief Get a number of bytes of pages of slabs of all classes.
+ * @param c A pointer to slab classes.
+ * @return A number of bytes.
+ */
+size_t get_slab_classes_bytes(const struct slab_classes *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SLAB_H */
@@ -20,6 +20,99 @@
 extern "C" {
 #endif
 
+#include <sys/types.h>
+
+/** A number of bits of a slot index of a timing wheel level */
+#define TIMER_WHEEL_BITS 6
+/** A number of slots of a timing wheel level */
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+/** A number of timing wheel levels, a wheel covers TIMER_WHEEL_SLOTS ^ TIMER_WHEEL_LEVELS ticks */
+#define TIMER_WHEEL_LEVELS 4
+
+/**
+ * @brief A timer, embedded in an object expiring by a timing wheel.
+ */
+struct timer_node {
+        /** A next timer in a slot, NULL if not pending */
+        struct timer_node *next;
+        /** A previous timer in a slot, NULL if not pending */
+        struct timer_node *prev;
+        /** A time when the timer expires in milliseconds */
+        u_int64_t expire;
+};
+
+/**
+ * @brief A hierarchical timing wheel.
+ *
+ * A level has TIMER_WHEEL_SLOTS slots, and a slot of a level covers all slots
+ * of the level below. A timer is put into the lowest level covering its
+ * expiring time, and moved down when its slot comes, so adding, deleting and
+ * expiring a timer cost constant time.
+ */
+struct timer_wheel {
+        /** A length of a tick in milliseconds */
+        u_int64_t resolution;
+        /** A next tick to expire */
+        u_int64_t tick;
+        /** A number of pending timers */
+        int num;
+        /** Heads of circular lists of timers */
+        struct timer_node slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+/**
+ * @brief Get a current time of a monotonic clock.
+ * @return A current time in milliseconds.
+ */
+u_int64_t get_monotonic_msec(void);
+
+/**
+ * @brief Initialize a timing wheel, it must not be moved after that.
+ * @param w A pointer to a timing wheel.
+ * @param resolution A length of a tick in milliseconds, timers expire at the end of their tick.
+ */
+void init_timer_wheel(struct timer_wheel *w, u_int64_t resolution);
+
+/**
+ * @brief Initialize a timer as not pending.
+ * @param t A pointer to a timer.
+ */
+void init_timer(struct timer_node *t);
+
+/**
+ * @brief Check whether a timer is pending.
+ * @param t A pointer to a timer.
+ * @return If pending, it returns 1. If not, it returns 0.
+ */
+int is_timer_pending(const struct timer_node *t);
+
+/**
+ * @brief Add a timer, or move it if pending.
+ * @param w A pointer to a timing wheel.
+ * @param t A pointer to a timer.
+ * @param expire A time when the timer expires in milliseconds.
+ * @param now A current time in milliseconds, an idle wheel skips to it.
+ */
+void add_timer(struct timer_wheel *w, struct timer_node *t, u_int64_t expire, u_int64_t now);
+
+/**
+ * @brief Delete a timer, a timer not pending is ignored.
+ * @param w A pointer to a timing wheel.
+ * @param t A pointer to a timer.
+ */
+void del_timer(struct timer_wheel *w, struct timer_node *t);
+
+/**
+ * @brief Expire timers until a current time.
+ * @param w A pointer to a timing wheel.
+ * @param now A current time in milliseconds.
+ * @param expired A function called with an expired timer, it may add the timer again or free it.
+ * @param arg An argument of the function.
+ * @return A number of expired timers.
+ */
+int run_timer_wheel(struct timer_wheel *w, u_int64_t now,
+        void (*expired)(struct timer_node *t, void *arg), void *arg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -82,6 +82,86 @@ struct htip_link_info_header {
         u_char macaddr_num;
 };
 #define HTIP_LINK_INFO_HEADER_LEN sizeof(struct htip_link_info_header)
+/** A port number is 1 byte up to 255 and 2 bytes (network byte order) above */
+#define HTIP_LINK_INFO_PORTNO_LEN_MAX sizeof(u_int16_t)
+/** A header length with a specified length of a port number */
+#define HTIP_LINK_INFO_HEADER_LEN_PORTNO(portno_len) (HTIP_LINK_INFO_HEADER_LEN - HTIP_LINK_INFO_PORTNO_LEN + (portno_len))
+
+/**
+ * @brief A decoded HTIP link information.
+ */
+struct htip_link_info {
+        /** A network interface type (IANAifType) */
+        u_int32_t iftype;
+        /** A length of a port number, 1 or 2 */
+        u_int portno_len;
+        /** A port number */
+        u_int16_t port_no;
+        /** A number of MAC addresses */
+        int macaddr_num;
+        /** MAC addresses, ETHER_ADDR_LEN bytes each, pointing into the decoded buffer */
+        const u_int8_t *macaddrs;
+};
+
+/** A MAC address list is a number of MAC addresses followed by them */
+#define HTIP_MAC_ADDRESS_LIST_HEADER_LEN sizeof(u_int8_t)
+
+/**
+ * @brief A decoded HTIP MAC address list.
+ */
+struct htip_mac_address_list {
+        /** A number of MAC addresses */
+        int macaddr_num;
+        /** MAC addresses, ETHER_ADDR_LEN bytes each, pointing into the decoded buffer */
+        const u_int8_t *macaddrs;
+};
+
+/** The max number of link information TLVs kept by decode_htip_lldpdu() */
+#define HTIP_LLDPDU_MAX_LINK_INFO 128
+/** The max number of MAC address list TLVs kept by decode_htip_lldpdu() */
+#define HTIP_LLDPDU_MAX_MAC_ADDRESS_LIST 8
+
+/**
+ * @brief A decoded LLDPDU with HTIP TLVs, pointers point into the decoded buffer.
+ */
+struct htip_lldpdu {
+        /** A chassis ID with its subtype */
+        const u_char *chassis_id;
+        /** A length of the chassis ID with its subtype */
+        u_int chassis_id_len;
+        /** A port ID with its subtype */
+        const u_char *port_id;
+        /** A length of the port ID with its subtype */
+        u_int port_id_len;
+        /** A time to live in seconds, 0 if the agent is shutting down */
+        u_int16_t ttl;
+        /** A device category, NULL if absent */
+        const u_char *device_category;
+        /** A length of the device category */
+        u_int device_category_len;
+        /** A manufacturer code, NULL if absent */
+        const u_char *manufacturer_code;
+        /** A length of the manufacturer code */
+        u_int manufacturer_code_len;
+        /** A model name, NULL if absent */
+        const u_char *model_name;
+        /** A length of the model name */
+        u_int model_name_len;
+        /** A model number, NULL if absent */
+        const u_char *model_number;
+        /** A length of the model number */
+        u_int model_number_len;
+        /** A LLDPDU transmission interval in seconds, 0 if absent */
+        u_int16_t interval;
+        /** A number of link information */
+        int link_info_num;
+        /** Link information */
+        struct htip_link_info link_info[HTIP_LLDPDU_MAX_LINK_INFO];
+        /** A number of MAC address lists */
+        int mac_address_list_num;
+        /** MAC address lists */
+        struct htip_mac_address_list mac_address_list[HTIP_LLDPDU_MAX_MAC_ADDRESS_LIST];
+};
 
 /* Mandatory TLV */
 #define END_OF_LLDPDU_TLV               0
@@ -135,6 +215,12 @@ struct htip_link_info_header {
 #define HTIP_DEVICE_INFO_VENDOR_SPECIFIC_EXTENSION_FIELD        255
 
 #define TTL_DEFAULT     60
+/** TTL is twice of a transmission interval, same as TTL_DEFAULT for 30 seconds */
+#define TTL_INTERVAL_MULTIPLIER 2
+#define TTL_MAX         65534
+
+/** A length of LLDPDU transmission interval in seconds */
+#define HTIP_DEVICE_INFO_LLDPDU_TRANSMISSION_INTERVAL_LEN       2
 
 /**
  * @brief Get a length of specified TLV header.
@@ -211,8 +297,47 @@ void print_htip_device_info(char *p);
 /**
  * @brief Print a HTIP link information.
  * @param p A pointer to a head of a header.
+ * @param len A length of the link information after the HTIP TLV header.
+ */
+void print_htip_link_info(char *p, u_int len);
+
+/**
+ * @brief Decode a HTIP link information with a 1 or 2 bytes port number.
+ * @param p A pointer to a head of a header.
+ * @param len A length of the link information after the HTIP TLV header.
+ * @param info A pointer to store the decoded link information.
+ * @return If succeeded, it returns 0. If the link information is malformed, it returns -1.
+ */
+int decode_htip_link_info(const u_char *p, u_int len, struct htip_link_info *info);
+
+/**
+ * @brief Print a HTIP MAC address list.
+ * @param p A pointer to a head of a header.
+ * @param len A length of the MAC address list after the HTIP TLV header.
  */
-void print_htip_link_info(char *p);
+void print_htip_mac_address_list(char *p, u_int len);
+
+/**
+ * @brief Decode a HTIP MAC address list.
+ * @param p A pointer to a head of a header.
+ * @param len A length of the MAC address list after the HTIP TLV header.
+ * @param list A pointer to store the decoded MAC address list.
+ * @return If succeeded, it returns 0. If the MAC address list is malformed, it returns -1.
+ */
+int decode_htip_mac_address_list(const u_char *p, u_int len, struct htip_mac_address_list *list);
+
+/**
+ * @brief Decode a LLDPDU with HTIP TLVs.
+ *
+ * Every TLV is checked against the buffer, so a frame from the network can be
+ * decoded as is. Unknown TLVs are skipped.
+ *
+ * @param buf A pointer to a head of the LLDPDU after the ethernet header.
+ * @param len A length of the LLDPDU.
+ * @param du A pointer to store the decoded LLDPDU.
+ * @return If succeeded, it returns 0. If the mandatory TLVs are missing or a TLV is malformed, it returns -1.
+ */
+int decode_htip_lldpdu(const u_char *buf, size_t len, struct htip_lldpdu *du);
 
 /**
  * @brief Check whether a specified TLV is HTIP TLV or not.
@@ -281,6 +406,19 @@ int create_port_description_tlv(u_char *p, u_char *ifname, u_int ifname_len);
 int create_lldp_tlv(u_char *p, u_char *macaddr, u_int macaddr_len,
         u_char *ifname, u_int ifname_len);
 
+/**
+ * @brief Create LLDP TLVs(chassis ID, port ID, ttl, port description) with a specified TTL.
+ * @param p A head pointer to create TLV.
+ * @param macaddr A pointer to a MAC address.
+ * @param macaddr_len A length of a MAC address.
+ * @param ifname A pointer to a network interface name.
+ * @param ifname_len A length of a network interface name.
+ * @param ttl Time to live seconds.
+ * @return Bytes of created TLV.
+ */
+int create_lldp_tlv_ttl(u_char *p, u_char *macaddr, u_int macaddr_len,
+        u_char *ifname, u_int ifname_len, u_int16_t ttl);
+
 /**
  * @brief Get a TLV length that includes LLDP TLVs(chassis ID, port ID, ttl, port description).
  * @param macaddr_len A length of MAC address.
@@ -315,6 +453,20 @@ int create_htip_tlv_header(u_char *p, u_char ttc_subtype);
  */
 int create_htip_device_info_tlv(u_char *p, u_char device_info_id, u_char *device_info, u_int device_info_len);
 
+/**
+ * @brief Create HTIP LLDPDU transmission interval TLV in a specified pointer.
+ * @param p A head pointer to create TLV.
+ * @param interval A transmission interval in seconds.
+ * @return Bytes of created TLV.
+ */
+int create_htip_transmission_interval_tlv(u_char *p, u_int16_t interval);
+
+/**
+ * @brief Get a TLV length of HTIP LLDPDU transmission interval TLV.
+ * @return A TLV length of HTIP LLDPDU transmission interval TLV.
+ */
+int get_htip_transmission_interval_tlv_len(void);
+
 /**
  * @brief Create HTIP device information TLV in a specified pointer.
  * @param p A head pointer to create TLV.
@@ -365,6 +517,30 @@ int get_basic_htip_device_info_len(u_int macaddr_len, u_int ifname_len,
 int create_htip_link_info_tlv(u_char *p, u_int32_t iftype, u_int16_t port_no,
         u_int8_t *macaddrs[], int macaddr_num);
 
+/**
+ * @brief Get a length of a port number of HTIP link information.
+ *
+ * All link information TLVs of a frame should use the same length, so a
+ * caller passes the largest port number of the frame.
+ *
+ * @param port_no A port number.
+ * @return 1 if port_no fits in a byte, otherwise 2.
+ */
+u_int get_htip_link_info_portno_len(u_int16_t port_no);
+
+/**
+ * @brief Create HTIP link information TLV with a specified length of a port number.
+ * @param p A head pointer to create TLV.
+ * @param iftype A network interface type(described in IANAifType).
+ * @param port_no A port number in FDB.
+ * @param portno_len A length of a port number, 1 or 2.
+ * @param macaddrs A pointer list of MAC address of FDB entries.
+ * @param macaddr_num A number of MAC address for specified port number.
+ * @return Bytes of created TLV. If port_no doesn't fit in portno_len, it returns 0.
+ */
+int create_htip_link_info_tlv_portno_len(u_char *p, u_int32_t iftype, u_int16_t port_no,
+        u_int portno_len, u_int8_t *macaddrs[], int macaddr_num);
+
 /**
  * @brief Create basic LLDP and HTIP TLVs in a specified pointer.
  *
@@ -405,6 +581,42 @@ int get_basic_htip_link_info_len(u_int macaddr_len, u_int ifname_len,
  * @return A TLV length of basic LLDP and HTIP TLVs.
  */
 int get_htip_link_info_tlv_len(u_int macaddr_len, int macaddr_num);
+
+/**
+ * @brief Get a TLV length of HTIP link information TLVs with a specified length of a port number.
+ * @param macaddr_len A length of MAC address.
+ * @param macaddr_num A number of MAC address contained in a link information.
+ * @param portno_len A length of a port number, 1 or 2.
+ * @return A TLV length of HTIP link information TLVs.
+ */
+int get_htip_link_info_tlv_len_portno_len(u_int macaddr_len, int macaddr_num, u_int portno_len);
+
+/**
+ * @brief Create HTIP MAC address list TLVs in a specified pointer.
+ *
+ * MAC addresses are fragmented into several TLVs like link information, if they don't fit in a TLV.
+ *
+ * @param p A head pointer to create TLV.
+ * @param macaddrs A pointer list of MAC address.
+ * @param macaddr_num A number of MAC address.
+ * @return Bytes of created TLV.
+ */
+int create_htip_mac_address_list_tlv(u_char *p, u_int8_t *macaddrs[], int macaddr_num);
+
+/**
+ * @brief Get a TLV length of HTIP MAC address list TLVs.
+ * @param macaddr_len A length of MAC address.
+ * @param macaddr_num A number of MAC address.
+ * @return A TLV length of HTIP MAC address list TLVs.
+ */
+int get_htip_mac_address_list_tlv_len(u_int macaddr_len, int macaddr_num);
+
+/**
+ * @brief Get the max number of MAC addresses of HTIP MAC address list TLVs fitting in a specified length.
+ * @param len A length available for the TLVs.
+ * @return The max number of MAC addresses, 0 if even an empty list doesn't fit.
+ */
+int get_htip_mac_address_list_max_num(u_int len);
 #ifdef __cplusplus
 }
 #endif
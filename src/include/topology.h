@@ -0,0 +1,214 @@
+/**
+ * @file   topology.h
+ * @brief A library estimating a layer 2 topology from HTIP information.
+ *
+ * A header file of a library that build a graph of switches, ports and end
+ * devices from link information and device information in a neighbor
+ * database, and infer unmanaged segments hidden behind a port. A topology can
+ * follow changes of the database, updating only ports whose link information
+ * changed.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "macmap.h"
+#include "neighbor.h"
+
+/** A HTIP device without link information */
+#define TOPOLOGY_NODE_DEVICE 1
+/** A HTIP device with link information */
+#define TOPOLOGY_NODE_SWITCH 2
+/** A MAC address only seen in link information */
+#define TOPOLOGY_NODE_UNKNOWN 3
+/** An inferred unmanaged segment, like a hub or an unmanaged switch */
+#define TOPOLOGY_NODE_SEGMENT 4
+
+/** An initial size of arrays of a topology */
+#define TOPOLOGY_INIT_SIZE 256
+
+/**
+ * @brief A node of a topology.
+ */
+struct topology_node {
+        /** A type, TOPOLOGY_NODE_* */
+        int type;
+        /** A neighbor of a HTIP device, NULL for other types */
+        const struct neighbor *neighbor;
+        /** A MAC address of the node, zero for a segment */
+        u_int8_t macaddr[ETHER_ADDR_LEN];
+        /** An index of the first port of a switch, -1 if none */
+        int first_port;
+        /** An index of the port toward the root of a switch, -1 if none */
+        int uplink;
+        /** An index of a port the node is attached to, -1 if none */
+        int parent;
+};
+
+/**
+ * @brief A port of a switch.
+ */
+struct topology_port {
+        /** An index of the switch */
+        int node;
+        /** A port number */
+        u_int16_t port_no;
+        /** An index of the next port of the switch, -1 if none */
+        int next;
+        /** A bitset of nodes beyond the port by node index */
+        u_int64_t *macset;
+        /** A number of nodes in macset */
+        int macset_num;
+        /** A bitset of nodes directly attached to the port, a subset of macset */
+        u_int64_t *attached;
+        /** A number of nodes in attached */
+        int attached_num;
+};
+
+/**
+ * @brief A link between nodes.
+ */
+struct topology_edge {
+        /** An index of a node */
+        int node1;
+        /** An index of a port of node1, -1 if not a switch port */
+        int port1;
+        /** An index of a node */
+        int node2;
+        /** An index of a port of node2, -1 if not a switch port */
+        int port2;
+};
+
+/**
+ * @brief A layer 2 topology.
+ */
+struct topology {
+        /** Nodes */
+        struct topology_node *nodes;
+        /** A number of nodes */
+        int node_num;
+        /** A size of nodes */
+        int node_size;
+        /** A number of nodes except segments, segments follow them */
+        int base_num;
+        /** Ports of switches */
+        struct topology_port *ports;
+        /** A number of ports */
+        int port_num;
+        /** A size of ports */
+        int port_size;
+        /** Links */
+        struct topology_edge *edges;
+        /** A number of links */
+        int edge_num;
+        /** A size of edges */
+        int edge_size;
+        /** A number of 64-bit words of a bitset, with room for nodes added later */
+        int words;
+        /** Storage of all bitsets */
+        u_int64_t *bits;
+        /** A bitset of switches */
+        u_int64_t *switches;
+        /** A bitset to keep a macset while a port is updated */
+        u_int64_t *scratch;
+        /** An index of the root switch, -1 if no switch */
+        int root;
+        /** MAC addresses by get_fdb_key() to nodes */
+        struct macmap macs;
+        /** Hashes of chassis IDs to nodes */
+        struct macmap chassis;
+        /** A neighbor database the topology follows, NULL if not */
+        struct neighbor_db *db;
+        /** Incremented for each change of the topology */
+        u_int64_t generation;
+        /** A generation of edges, edges are added again if it's behind */
+        u_int64_t edge_generation;
+        /** Set if a change can't be applied in place and the topology must be built again */
+        int stale;
+};
+
+/**
+ * @brief Build a topology from a neighbor database.
+ *
+ * A node is given a dense index, and a set of MAC addresses beyond a port is a
+ * bitset by the index. A node is attached to a port if it's beyond the port
+ * but not beyond a downlink of a switch attached to the port. A port with
+ * several attached nodes has a hidden unmanaged segment. The cost is linear in
+ * the total size of link information plus a bitset scan per port.
+ *
+ * @param db A pointer to a neighbor database, it must not change while the topology is used.
+ * @return If succeeded, it returns an allocated topology. If failed, it returns NULL.
+ */
+struct topology *build_topology(struct neighbor_db *db);
+
+/**
+ * @brief Build a topology that follows changes of a neighbor database.
+ *
+ * The topology sets the hook of the database. A frame without changes costs
+ * nothing. A changed port is updated in place with switches moved by it and
+ * ports they're attached to, the root is kept until the topology is built
+ * again. A new device is added in place. Other changes,
+ * like a new switch or an expired neighbor, build the topology again on the
+ * next refresh_topology(). Links are added again on the next query after a
+ * change.
+ *
+ * @param db A pointer to a neighbor database.
+ * @return If succeeded, it returns an allocated topology. If failed, it returns NULL.
+ */
+struct topology *alloc_topology(struct neighbor_db *db);
+
+/**
+ * @brief Apply pending changes to a topology, called by print_topology().
+ * @param t A pointer to a topology.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int refresh_topology(struct topology *t);
+
+/**
+ * @brief Free a topology, and clear the hook of its database.
+ * @param t A pointer to a topology, NULL is ignored.
+ */
+void free_topology(struct topology *t);
+
+/**
+ * @brief Find a node by a MAC address.
+ * @param t A pointer to a topology.
+ * @param macaddr A MAC address.
+ * @return If found, it returns an index of the node. If not, it returns -1.
+ */
+int find_topology_node(struct topology *t, const u_int8_t macaddr[]);
+
+/**
+ * @brief Print a node, like an end of a link, without a newline.
+ * @param t A pointer to a topology.
+ * @param node An index of a node.
+ * @param port An index of a port of the node, -1 not to print a port.
+ */
+void print_topology_node(struct topology *t, int node, int port);
+
+/**
+ * @brief Print a topology.
+ * @param t A pointer to a topology.
+ */
+void print_topology(struct topology *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOPOLOGY_H */
@@ -0,0 +1,80 @@
+/**
+ * @file   txpool.h
+ * @brief A library of worker threads sending frames to ports.
+ *
+ * A header file of a library that split per-port frame encoding and sending
+ * across worker threads, each of which has its own socket.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef TXPOOL_H
+#define TXPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#define TXPOOL_MAX_WORKERS 64
+
+/**
+ * @brief A pool of worker threads, its members are private to txpool.c.
+ */
+struct txpool;
+
+/**
+ * @brief A job run for each port.
+ * @param arg An argument passed to run_txpool().
+ * @param index An index of the port, from 0 to num - 1 of run_txpool().
+ * @param sock A socket of the worker opened by open_frame_socket(), -1 if not available.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+typedef int (*txpool_job)(void *arg, int index, int sock);
+
+/**
+ * @brief Start worker threads.
+ * @param num A number of worker threads, the max number is TXPOOL_MAX_WORKERS.
+ * @return If succeeded, it returns a pointer to a pool. If failed, it returns NULL.
+ */
+struct txpool *alloc_txpool(int num);
+
+/**
+ * @brief Stop worker threads and free a pool.
+ * @param pool A pointer to a pool, NULL is ignored.
+ */
+void free_txpool(struct txpool *pool);
+
+/**
+ * @brief Get a number of worker threads.
+ * @param pool A pointer to a pool.
+ * @return A number of worker threads.
+ */
+int get_txpool_worker_num(struct txpool *pool);
+
+/**
+ * @brief Run a job for each port on worker threads and wait for all of them.
+ *
+ * Ports are handed to idle workers one by one, so a slow port doesn't hold
+ * others. It returns after every job has finished.
+ *
+ * @param pool A pointer to a pool.
+ * @param num A number of ports.
+ * @param job A function called for each port.
+ * @param arg An argument passed to job.
+ * @return If all jobs succeeded, it returns 0. If any job failed, it returns -1.
+ */
+int run_txpool(struct txpool *pool, int num, txpool_job job, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TXPOOL_H */
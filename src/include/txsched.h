@@ -0,0 +1,188 @@
+/**
+ * @file   txsched.h
+ * @brief A library scheduling frame transmissions.
+ *
+ * A header file of a library that spread transmissions of network interfaces
+ * across an interval with random jitter, and cap frames per second of a host
+ * by a token bucket.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#ifndef TXSCHED_H
+#define TXSCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+/** A default interval between frames of an interface in milliseconds */
+#define TXSCHED_DEFAULT_INTERVAL 30000
+/** A default max interval stretched while nothing changes in milliseconds */
+#define TXSCHED_DEFAULT_MAX_INTERVAL 300000
+/** A default jitter, a percentage of the interval */
+#define TXSCHED_DEFAULT_JITTER 10
+/** A default cap of frames per second, 0 for no cap */
+#define TXSCHED_DEFAULT_RATE 10
+/** A default number of frames sent at once */
+#define TXSCHED_DEFAULT_BURST 5
+/** A default number of frames sent at the fast interval after startup or link-up (LLDP txFastInit) */
+#define TXSCHED_DEFAULT_FAST_COUNT 4
+/** A default fast interval in milliseconds (LLDP msgFastTx) */
+#define TXSCHED_DEFAULT_FAST_INTERVAL 1000
+/** The max number of fast frames */
+#define TXSCHED_MAX_FAST_COUNT 8
+
+/**
+ * @brief A transmission scheduler of a host.
+ */
+struct txsched {
+        /** An interval between frames of an interface in milliseconds */
+        u_int64_t interval;
+        /** The max deviation from the interval in milliseconds */
+        u_int64_t jitter;
+        /** A cap of frames per second, 0 for no cap */
+        u_int rate;
+        /** The max number of tokens */
+        u_int burst;
+        /** Available tokens in 1/1000 tokens */
+        u_int64_t tokens;
+        /** A time when tokens were added last */
+        u_int64_t refilled;
+        /** A seed of rand_r(3) */
+        unsigned int seed;
+        /** A number of frames sent at the fast interval, 0 to disable fast start */
+        u_int fast_count;
+        /** A fast interval in milliseconds */
+        u_int64_t fast_interval;
+        /** The max interval stretched while nothing changes, same as interval if not adaptive */
+        u_int64_t max_interval;
+};
+
+/**
+ * @brief Initialize a transmission scheduler.
+ * @param sched A pointer to a scheduler.
+ * @param interval An interval between frames of an interface in milliseconds.
+ * @param jitter The max deviation from the interval, a percentage of the interval from 0 to 50.
+ * @param rate A cap of frames per second of the host, 0 for no cap.
+ * @param burst The max number of frames sent at once, at least 1.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ * @detail Fast start is set to TXSCHED_DEFAULT_FAST_COUNT and TXSCHED_DEFAULT_FAST_INTERVAL, and the interval is not adaptive.
+ */
+int init_txsched(struct txsched *sched, u_int64_t interval, u_int jitter,
+        u_int rate, u_int burst);
+
+/**
+ * @brief Set fast start of a transmission scheduler.
+ *
+ * Like LLDP txFast, an interface sends count frames at the fast interval
+ * after startup or link-up, so a frame lost during link negotiation doesn't
+ * delay discovery by a full interval.
+ *
+ * @param sched A pointer to a scheduler.
+ * @param count A number of fast frames from 0 to TXSCHED_MAX_FAST_COUNT, 0 to disable.
+ * @param interval A fast interval in milliseconds, shorter than the interval.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int set_txsched_fast(struct txsched *sched, u_int count, u_int64_t interval);
+
+/**
+ * @brief Get a number of fast frames of a transmission scheduler.
+ * @param sched A pointer to a scheduler.
+ * @return A number of fast frames.
+ */
+u_int get_txsched_fast_count(struct txsched *sched);
+
+/**
+ * @brief Get a time to send the next fast frame of an interface.
+ * @param sched A pointer to a scheduler.
+ * @param now A current time by get_monotonic_msec().
+ * @return A time to send the frame, the fast interval with jitter later.
+ */
+u_int64_t get_txsched_fast_next(struct txsched *sched, u_int64_t now);
+
+/**
+ * @brief Set the max interval of a transmission scheduler.
+ *
+ * An interval is doubled by stretch_txsched_interval() up to the max while
+ * nothing changes, and a caller resets it to the interval after a change.
+ *
+ * @param sched A pointer to a scheduler.
+ * @param max_interval The max interval in milliseconds, the interval disables stretching.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+int set_txsched_max_interval(struct txsched *sched, u_int64_t max_interval);
+
+/**
+ * @brief Get a base interval of a transmission scheduler.
+ * @param sched A pointer to a scheduler.
+ * @return An interval in milliseconds.
+ */
+u_int64_t get_txsched_interval(struct txsched *sched);
+
+/**
+ * @brief Stretch an interval after a quiet period.
+ * @param sched A pointer to a scheduler.
+ * @param interval A current interval in milliseconds, 0 for the base interval.
+ * @return A doubled interval up to the max interval.
+ */
+u_int64_t stretch_txsched_interval(struct txsched *sched, u_int64_t interval);
+
+/**
+ * @brief Get a time to send the first frame of an interface.
+ *
+ * A random phase within the interval keeps hosts booted together from
+ * sending at the same time.
+ *
+ * @param sched A pointer to a scheduler.
+ * @param now A current time by get_monotonic_msec().
+ * @return A time to send the frame.
+ */
+u_int64_t get_txsched_first(struct txsched *sched, u_int64_t now);
+
+/**
+ * @brief Get a time to send the next frame of an interface.
+ *
+ * It's the previous time plus the interval and a random jitter, so the phase
+ * drifts instead of being locked to other hosts. If the interface is far
+ * behind, for example after a suspend, it's rescheduled from now.
+ *
+ * @param sched A pointer to a scheduler.
+ * @param prev A time when the previous frame was due.
+ * @param now A current time by get_monotonic_msec().
+ * @return A time to send the next frame.
+ */
+u_int64_t get_txsched_next(struct txsched *sched, u_int64_t prev, u_int64_t now);
+
+/**
+ * @brief Get a time to send the next frame of an interface at a specified interval.
+ * @param sched A pointer to a scheduler.
+ * @param interval An interval in milliseconds, jitter is scaled to it.
+ * @param prev A time when the previous frame was due.
+ * @param now A current time by get_monotonic_msec().
+ * @return A time to send the next frame.
+ */
+u_int64_t get_txsched_next_interval(struct txsched *sched, u_int64_t interval,
+        u_int64_t prev, u_int64_t now);
+
+/**
+ * @brief Take a token to send a frame.
+ * @param sched A pointer to a scheduler.
+ * @param now A current time by get_monotonic_msec().
+ * @return If a token was taken, it returns 0. If not, it returns milliseconds until a token is available.
+ */
+u_int64_t take_txsched_token(struct txsched *sched, u_int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TXSCHED_H */
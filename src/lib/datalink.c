@@ -104,39 +104,284 @@ int set_promiscuous_mode(const char *interface_name)
         return sock;
 }
 
-u_int32_t get_iftype(const char *ifname)
+/**
+ * @brief An entry of interface type cache.
+ */
+struct iftype_cache_entry {
+        /** An interface index, 0 is empty */
+        int ifindex;
+        /** A name of network interface when it's classified */
+        char ifname[IFNAMSIZ];
+        /** An IANAifType value */
+        u_int32_t iftype;
+};
+
+/** An open addressing hash table of interface types keyed by ifindex */
+static struct iftype_cache_entry *iftype_cache = NULL;
+/** A size of iftype_cache, a power of two */
+static int iftype_cache_size = 0;
+/** A number of stored entries */
+static int iftype_cache_num = 0;
+#ifdef __linux__
+/** A directory handle of /sys/class/net */
+static int sysfs_net_fd = -1;
+#endif /* __linux__ */
+
+static u_int32_t hash_iftype_cache(int ifindex)
 {
-        int sock;
-        u_int32_t dlt = IANAIFTYPE_OTHER;
-        char path[SYSFS_PATH_MAX];
-        struct stat sbuf;
+        return (u_int32_t) ifindex * 2654435761U;
+}
+
+u_int32_t lookup_iftype_cache(int ifindex, const char *ifname)
+{
+        struct iftype_cache_entry *e;
+        u_int32_t h, mask = iftype_cache_size - 1;
+
+        if (iftype_cache == NULL || ifindex <= 0)
+                return 0;
+
+        for (h = hash_iftype_cache(ifindex) & mask; (e = iftype_cache + h)->ifindex != 0; h = (h + 1) & mask) {
+                if (e->ifindex != ifindex)
+                        continue;
+                /* a reused ifindex or a renamed interface is classified again */
+                if (strncmp(e->ifname, ifname, IFNAMSIZ) != 0)
+                        return 0;
+                return e->iftype;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Double interface type cache and rehash all entries.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int grow_iftype_cache(void)
+{
+        struct iftype_cache_entry *old = iftype_cache, *e;
+        int i, old_size = iftype_cache_size;
+        u_int32_t h, mask;
+
+        iftype_cache_size = old_size ? old_size * 2 : IFTYPE_CACHE_INIT_SIZE;
+        if ((iftype_cache = calloc(iftype_cache_size, sizeof(struct iftype_cache_entry))) == NULL) {
+                perror("calloc");
+                iftype_cache = old;
+                iftype_cache_size = old_size;
+                return -1;
+        }
+
+        mask = iftype_cache_size - 1;
+        for (i = 0; i < old_size; i++) {
+                e = old + i;
+                if (e->ifindex == 0)
+                        continue;
+                for (h = hash_iftype_cache(e->ifindex) & mask; iftype_cache[h].ifindex != 0; h = (h + 1) & mask)
+                        ;
+                iftype_cache[h] = *e;
+        }
+
+        free(old);
+
+        return 0;
+}
+
+int store_iftype_cache(int ifindex, const char *ifname, u_int32_t iftype)
+{
+        struct iftype_cache_entry *e;
+        u_int32_t h, mask;
+
+        if (ifindex <= 0)
+                return -1;
+
+        /* keep the load factor under 1/2 */
+        if ((iftype_cache_num + 1) * 2 > iftype_cache_size && grow_iftype_cache() < 0)
+                return -1;
+
+        mask = iftype_cache_size - 1;
+        for (h = hash_iftype_cache(ifindex) & mask; (e = iftype_cache + h)->ifindex != 0; h = (h + 1) & mask) {
+                if (e->ifindex == ifindex)
+                        break;
+        }
+
+        if (e->ifindex == 0)
+                iftype_cache_num += 1;
+
+        e->ifindex = ifindex;
+        strncpy(e->ifname, ifname, IFNAMSIZ - 1);
+        e->ifname[IFNAMSIZ - 1] = '\0';
+        e->iftype = iftype;
+
+        return 0;
+}
+
+void invalidate_iftype_cache(int ifindex)
+{
+        struct iftype_cache_entry *e;
+        u_int32_t h, i, j, mask = iftype_cache_size - 1;
+
+        if (iftype_cache == NULL || ifindex <= 0)
+                return;
+
+        for (h = hash_iftype_cache(ifindex) & mask; iftype_cache[h].ifindex != ifindex; h = (h + 1) & mask) {
+                if (iftype_cache[h].ifindex == 0)
+                        return;
+        }
+
+        /* shift following entries back instead of leaving a tombstone */
+        for (i = h, j = (h + 1) & mask; (e = iftype_cache + j)->ifindex != 0; j = (j + 1) & mask) {
+                h = hash_iftype_cache(e->ifindex) & mask;
+                if (((j - h) & mask) >= ((j - i) & mask)) {
+                        iftype_cache[i] = *e;
+                        i = j;
+                }
+        }
+        memset(iftype_cache + i, 0, sizeof(struct iftype_cache_entry));
+        iftype_cache_num -= 1;
+}
+
+void free_iftype_cache(void)
+{
+        free(iftype_cache);
+        iftype_cache = NULL;
+        iftype_cache_size = 0;
+        iftype_cache_num = 0;
 #ifdef __linux__
-        struct ifreq ifr;
+        if (sysfs_net_fd >= 0 && close(sysfs_net_fd) < 0)
+                perror("close");
+        sysfs_net_fd = -1;
+#endif /* __linux__ */
+}
 
-        if ((sock = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
-                perror("socket");
-                dlt = HW_INVALID;
-                goto switch_dlt;
+#ifdef __linux__
+int open_sysfs_netif(const char *ifname)
+{
+        int fd;
+
+        /* every interface is resolved relative to one directory handle */
+        if (sysfs_net_fd < 0 &&
+            (sysfs_net_fd = open(SYSFS_CLASS_NET, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+                perror("open(" SYSFS_CLASS_NET ")");
+                return -1;
         }
 
-        strncpy(ifr.ifr_name, ifname, IFNAMSIZ);
-        if (ioctl(sock, SIOCGIFHWADDR, &ifr) == -1) {
-                perror("ioctl(SIOCGIFHWADDR");
-                dlt = HW_INVALID;
-                goto switch_dlt;
+        if ((fd = openat(sysfs_net_fd, ifname, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+                return -1;
+
+        return fd;
+}
+
+int is_sysfs_netif_dir(int fd, const char *name)
+{
+        struct stat sbuf;
+
+        return fstatat(fd, name, &sbuf, 0) == 0 && S_ISDIR(sbuf.st_mode);
+}
+
+/**
+ * @brief Classify a network interface by /sys/class/net/<ifname>/{type,bridge,wireless}.
+ * @param ifname A network interface name.
+ * @return If succeeded, it returns an IANAifType value. If failed, it returns IANAIFTYPE_OTHER.
+ */
+static u_int32_t read_sysfs_iftype(const char *ifname)
+{
+        char buf[16];
+        int dfd, fd;
+        ssize_t n;
+        u_int32_t dlt = HW_INVALID;
+
+        if ((dfd = open_sysfs_netif(ifname)) < 0) {
+                fprintf(stderr, "open_sysfs_netif() failed on net ifname: %s\n", ifname);
+                return IANAIFTYPE_OTHER;
         }
-        dlt = ifr.ifr_hwaddr.sa_family;
 
-        if (ioctl(sock, SIOCGIWNAME, &ifr) == 0) {
+        if ((fd = openat(dfd, "type", O_RDONLY | O_CLOEXEC)) >= 0) {
+                if ((n = read(fd, buf, sizeof(buf) - 1)) > 0) {
+                        buf[n] = '\0';
+                        dlt = strtoul(buf, NULL, 10);
+                }
+                if (close(fd) < 0)
+                        perror("close");
+        }
+
+        /* ignore bridge interface */
+        if (is_sysfs_netif_dir(dfd, "bridge"))
+                dlt = HW_INVALID;
+        else if (dlt == HW_ETHER && (is_sysfs_netif_dir(dfd, "wireless") || is_sysfs_netif_dir(dfd, "phy80211")))
                 dlt = HW_IEEE80211;
+
+        if (close(dfd) < 0)
+                perror("close");
+
+        if (get_ianaiftype(dlt) == IANAIFTYPE_OTHER)
+                fprintf(stderr, "Unsupported datalink type:%u\n", dlt);
+
+        return get_ianaiftype(dlt);
+}
+#endif /* __linux__ */
+
+#ifdef __linux__
+/**
+ * @brief Read an interface index of a network interface from sysfs.
+ * @param ifname A network interface name.
+ * @return If succeeded, it returns an interface index. If failed, it returns 0.
+ */
+static int read_sysfs_ifindex(const char *ifname)
+{
+        char buf[16];
+        int dfd, fd, ifindex = 0;
+        ssize_t n;
+
+        if ((dfd = open_sysfs_netif(ifname)) < 0)
+                return 0;
+
+        if ((fd = openat(dfd, "ifindex", O_RDONLY | O_CLOEXEC)) >= 0) {
+                if ((n = read(fd, buf, sizeof(buf) - 1)) > 0) {
+                        buf[n] = '\0';
+                        ifindex = atoi(buf);
+                }
+                if (close(fd) < 0)
+                        perror("close");
         }
-        if (snprintf(path, SYSFS_PATH_MAX, SYSFS_CLASS_NET "%s/bridge", ifr.ifr_name) < 0) {
-                fprintf(stderr, "snprintf() failed.\n");
-                return -1;
+
+        if (close(dfd) < 0)
+                perror("close");
+
+        return ifindex;
+}
+#endif /* __linux__ */
+
+u_int32_t get_iftype(const char *ifname)
+{
+        return get_iftype_ifindex(ifname, 0);
+}
+
+u_int32_t get_iftype_ifindex(const char *ifname, int ifindex)
+{
+#ifdef __linux__
+        u_int32_t iftype;
+
+        /* a caller holding the index saves reading it */
+        if (ifindex <= 0 && (ifindex = read_sysfs_ifindex(ifname)) == 0) {
+                fprintf(stderr, "read_sysfs_ifindex() failed on net ifname: %s\n", ifname);
+                return IANAIFTYPE_OTHER;
         }
+
+        if ((iftype = lookup_iftype_cache(ifindex, ifname)) != 0)
+                return iftype;
+
+        iftype = read_sysfs_iftype(ifname);
+        if (store_iftype_cache(ifindex, ifname, iftype) < 0)
+                fprintf(stderr, "store_iftype_cache() failed on net ifname: %s\n", ifname);
+
+        return iftype;
 #endif /* __linux__ */
 #ifdef __APPLE__
+        int sock;
+        u_int32_t dlt = IANAIFTYPE_OTHER;
+        char path[SYSFS_PATH_MAX];
+        struct stat sbuf;
         struct ifmediareq ifmr = {};
+
         if ((sock = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
                 perror("socket");
                 dlt = HW_INVALID;
@@ -159,7 +404,6 @@ u_int32_t get_iftype(const char *ifname)
                 fprintf(stderr, "snprintf() failed.\n");
                 return -1;
         }
-#endif /* __APPLE__ */
         /* ignore bridge interface */
         if (stat(path, &sbuf) == 0) {
                 if (S_ISDIR(sbuf.st_mode)) {
@@ -171,6 +415,15 @@ switch_dlt:
                 perror("close");
         }
 
+        if (get_ianaiftype(dlt) == IANAIFTYPE_OTHER)
+                fprintf(stderr, "Unsupported datalink type:%u\n", dlt);
+
+        return get_ianaiftype(dlt);
+#endif /* __APPLE__ */
+}
+
+u_int32_t get_ianaiftype(u_int32_t dlt)
+{
         switch (dlt) {
                 /* Currently support only ethernet and IEEE 802.11 */
                 case HW_ETHER:
@@ -178,7 +431,6 @@ switch_dlt:
                 case HW_IEEE80211:
                         return IANAIFTYPE_IEEE80211;
                 default:
-                        fprintf(stderr, "Unsupported datalink type:%u\n", dlt);
                         return IANAIFTYPE_OTHER;
         }
 }
@@ -476,3 +728,103 @@ int write_frame(int fd, char *ifname, u_char *dst_mac, u_char *src_mac,
 
         return n;
 }
+
+#ifdef __linux__
+int open_frame_socket(void)
+{
+        int sock;
+
+        if ((sock = socket(AF_PACKET, SOCK_RAW, IPPROTO_RAW)) == -1) {
+                perror("socket");
+                return -1;
+        }
+
+        return sock;
+}
+
+int write_frame_ifindex(int sock, int ifindex, u_char *dst_mac, u_char *src_mac,
+        u_char *payload, u_int payload_len)
+{
+        struct ether_frame_t ef;
+        struct sockaddr_ll addr;
+        ssize_t n;
+
+        memcpy(ef.eth_header.ether_dhost, dst_mac, ETHER_ADDR_LEN);
+        memcpy(ef.eth_header.ether_shost, src_mac, ETHER_ADDR_LEN);
+        memcpy(ef.payload, payload, payload_len);
+        ef.eth_header.ether_type = htons(0x88cc);
+        ef.len = ETHER_HDR_LEN + payload_len;
+
+        memset(&addr, 0, sizeof(struct sockaddr_ll));
+        addr.sll_family = AF_PACKET;
+        addr.sll_ifindex = ifindex;
+        addr.sll_halen = ETH_ALEN;
+        addr.sll_protocol = htons(0x88cc);
+        memcpy(addr.sll_addr, dst_mac, ETHER_ADDR_LEN);
+
+        if ((n = sendto(sock, &ef, ef.len, 0, (struct sockaddr *) &addr, sizeof(struct sockaddr_ll))) < 0) {
+                fprintf(stderr, "sendto() failed\n");
+                return -1;
+        }
+
+        return n;
+}
+
+int open_lldp_socket(const char *ifname)
+{
+        int sock;
+        struct ifreq ifr;
+        struct sockaddr_ll addr;
+
+        if ((sock = socket(AF_PACKET, SOCK_RAW, htons(0x88cc))) == -1) {
+                perror("socket");
+                return -1;
+        }
+
+        memset(&addr, 0, sizeof(struct sockaddr_ll));
+        addr.sll_family = AF_PACKET;
+        addr.sll_protocol = htons(0x88cc);
+
+        if (ifname != NULL) {
+                memset(&ifr, 0, sizeof(struct ifreq));
+                strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+                if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0) {
+                        perror("ioctl SIOCGIFINDEX");
+                        close(sock);
+                        return -1;
+                }
+                addr.sll_ifindex = ifr.ifr_ifindex;
+        }
+
+        if (bind(sock, (struct sockaddr *) &addr, sizeof(struct sockaddr_ll)) == -1) {
+                perror("bind");
+                close(sock);
+                return -1;
+        }
+
+        return sock;
+}
+
+int read_frame(int sock, u_char *buf, u_int len, int *ifindex)
+{
+        struct sockaddr_ll addr;
+        socklen_t addr_len;
+        ssize_t n;
+
+        do {
+                addr_len = sizeof(struct sockaddr_ll);
+                if ((n = recvfrom(sock, buf, len, MSG_DONTWAIT, (struct sockaddr *) &addr, &addr_len)) == -1) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                                return 0;
+                        perror("recvfrom");
+                        return -1;
+                }
+        /* frames sent by this host are looped back */
+        } while (addr.sll_pkttype == PACKET_OUTGOING);
+
+        if (ifindex != NULL)
+                *ifindex = addr.sll_ifindex;
+
+        return n;
+}
+#endif /* __linux__ */
@@ -41,29 +41,241 @@
 #include <dirent.h>
 #include <unistd.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define FDB_SCAN_X86
+#include <immintrin.h>
+#endif
+
 #include "datalink.h"
 #include "fdb.h"
+#include "macmap.h"
 
 /* global variables */
-/** A list of FDB entry, currently the size is fixed. */
-struct fdb_entry fdb_entry_list[MAX_FDB_ENTRY_SIZE];
-/** A number of FDB entry in current FDB entry list */
-int fdb_entry_num = FDB_ENTRY_LIST_INVALID;
-/** A size of FDB entry list */
-int fdb_entry_size = FDB_ENTRY_LIST_INVALID;
+/** A default FDB table, used unless another table is set */
+static struct fdb_table default_fdb_table = {
+        .num = FDB_ENTRY_LIST_INVALID,
+        .size = FDB_ENTRY_LIST_INVALID,
+};
+/** A current FDB table, FDB entry functions without a table argument work on it */
+static struct fdb_table *current_fdb_table = &default_fdb_table;
+
+u_int64_t get_fdb_key(const u_int8_t macaddr[])
+{
+        return (u_int64_t) macaddr[0] | (u_int64_t) macaddr[1] << 8 |
+                (u_int64_t) macaddr[2] << 16 | (u_int64_t) macaddr[3] << 24 |
+                (u_int64_t) macaddr[4] << 32 | (u_int64_t) macaddr[5] << 40;
+}
+
+#ifdef FDB_SCAN_X86
+/**
+ * @brief Find a key by AVX2, 8 keys per loop.
+ */
+__attribute__((target("avx2")))
+static int find_fdb_key_avx2(const u_int64_t *keys, int n, u_int64_t key, int i)
+{
+        const __m256i k = _mm256_set1_epi64x((long long) key);
+        __m256i a, b;
+        int m;
+
+        for (; i + 8 <= n; i += 8) {
+                a = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (keys + i)), k);
+                b = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (keys + i + 4)), k);
+                m = _mm256_movemask_pd(_mm256_castsi256_pd(a)) |
+                        _mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4;
+                if (m != 0)
+                        return i + __builtin_ctz(m);
+        }
+
+        for (; i < n; i++)
+                if (keys[i] == key)
+                        return i;
+
+        return -1;
+}
+
+/**
+ * @brief Find a key by SSE2, 4 keys per loop.
+ */
+static int find_fdb_key_sse2(const u_int64_t *keys, int n, u_int64_t key, int i)
+{
+        const __m128i k = _mm_set1_epi64x((long long) key);
+        __m128i a, b;
+        int m;
+
+        for (; i + 4 <= n; i += 4) {
+                /* SSE2 has no 64-bit compare, so both 32-bit halves have to match */
+                a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (keys + i)), k);
+                b = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (keys + i + 2)), k);
+                a = _mm_and_si128(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+                b = _mm_and_si128(b, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1)));
+                m = _mm_movemask_pd(_mm_castsi128_pd(a)) |
+                        _mm_movemask_pd(_mm_castsi128_pd(b)) << 2;
+                if (m != 0)
+                        return i + __builtin_ctz(m);
+        }
+
+        for (; i < n; i++)
+                if (keys[i] == key)
+                        return i;
+
+        return -1;
+}
+
+/**
+ * @brief Match port numbers by AVX2.
+ */
+__attribute__((target("avx2")))
+static u_int32_t get_fdb_port_mask_avx2(const u_int16_t *ports, u_int16_t port_no)
+{
+        return (u_int32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi16(
+                _mm256_loadu_si256((const __m256i *) ports), _mm256_set1_epi16((short) port_no)));
+}
+
+/**
+ * @brief Match port numbers by SSE2.
+ */
+static u_int32_t get_fdb_port_mask_sse2(const u_int16_t *ports, u_int16_t port_no)
+{
+        const __m128i k = _mm_set1_epi16((short) port_no);
+
+        return (u_int32_t) _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *) ports), k)) |
+                (u_int32_t) _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *) (ports + 8)), k)) << 16;
+}
+#endif /* FDB_SCAN_X86 */
+
+int find_fdb_key_r(const struct fdb_table *t, u_int64_t key, int start)
+{
+        int i;
+
+        if (start < 0)
+                start = 0;
+
+#ifdef FDB_SCAN_X86
+        if (__builtin_cpu_supports("avx2"))
+                return find_fdb_key_avx2(t->keys, t->num, key, start);
+        return find_fdb_key_sse2(t->keys, t->num, key, start);
+#endif /* FDB_SCAN_X86 */
+
+        for (i = start; i < t->num; i++)
+                if (t->keys[i] == key)
+                        return i;
+
+        return -1;
+}
+
+/**
+ * @brief Match port numbers in a block.
+ * @param ports A pointer to FDB_PORT_BLOCK port numbers.
+ * @param port_no A port number.
+ * @return A mask with 2 bits per matched port number, like _mm_movemask_epi8().
+ */
+typedef u_int32_t (*fdb_port_mask)(const u_int16_t *ports, u_int16_t port_no);
+
+/** A number of port numbers matched at once */
+#define FDB_PORT_BLOCK 16
+
+/**
+ * @brief Match port numbers without vector instructions.
+ */
+static u_int32_t get_fdb_port_mask_scalar(const u_int16_t *ports, u_int16_t port_no)
+{
+        u_int32_t m = 0;
+        int i;
+
+        for (i = 0; i < FDB_PORT_BLOCK; i++)
+                if (ports[i] == port_no)
+                        m |= 3U << (i * 2);
+
+        return m;
+}
+
+/**
+ * @brief Get the fastest function to match port numbers on this CPU.
+ */
+static fdb_port_mask get_fdb_port_mask_func(void)
+{
+#ifdef FDB_SCAN_X86
+        if (__builtin_cpu_supports("avx2"))
+                return get_fdb_port_mask_avx2;
+        return get_fdb_port_mask_sse2;
+#endif /* FDB_SCAN_X86 */
+        return get_fdb_port_mask_scalar;
+}
 
-struct fdb_entry *get_fdb_entry_list(void)
+int find_fdb_port_r(const struct fdb_table *t, u_int16_t port_no, int start)
 {
-        return fdb_entry_list;
+        const fdb_port_mask f = get_fdb_port_mask_func();
+        u_int32_t m;
+        int i;
+
+        for (i = start < 0 ? 0 : start; i + FDB_PORT_BLOCK <= t->num; i += FDB_PORT_BLOCK)
+                if ((m = f(t->ports + i, port_no)) != 0)
+                        return i + __builtin_ctz(m) / 2;
+
+        for (; i < t->num; i++)
+                if (t->ports[i] == port_no)
+                        return i;
+
+        return -1;
+}
+
+int get_fdb_entry_r(const struct fdb_table *t, int i, struct fdb_entry *fdbp)
+{
+        if (i < 0 || i >= t->num)
+                return -1;
+
+        memset(fdbp, 0, FDB_ENTRY_LEN);
+        memcpy(fdbp->macaddr, t->macaddrs[i], ETHER_ADDR_LEN);
+        fdbp->port_no = t->ports[i];
+        fdbp->is_local = t->flags[i];
+        fdbp->ageing_timer_value.tv_sec = t->ages[i] / 1000;
+        fdbp->ageing_timer_value.tv_usec = t->ages[i] % 1000 * 1000;
+
+        return 0;
 }
 
 void set_fdb_entry_list(void *p)
 {
+        current_fdb_table = (p != NULL) ? (struct fdb_table *) p : &default_fdb_table;
+}
+
+struct fdb_table *get_fdb_table(void)
+{
+        return current_fdb_table;
+}
+
+struct fdb_table *alloc_fdb_table(const char *brname)
+{
+        struct fdb_table *p;
+
+        if ((p = malloc(sizeof(struct fdb_table))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+
+        memset(p, 0, sizeof(struct fdb_table));
+        strncpy(p->brname, brname, FDB_BRNAME_LEN - 1);
+        p->num = FDB_ENTRY_LIST_INVALID;
+        p->size = FDB_ENTRY_LIST_INVALID;
+
+        return p;
+}
+
+void free_fdb_table(struct fdb_table *p)
+{
+        if (p == NULL || p == &default_fdb_table)
+                return;
+
+        if (current_fdb_table == p)
+                current_fdb_table = &default_fdb_table;
+
+        destroy_macmap(&p->index);
+        free(p);
 }
 
 int get_fdb_entry_num(void)
 {
-        return fdb_entry_num;
+        return current_fdb_table->num;
 }
 
 int set_fdb_entry_num(int num)
@@ -73,14 +285,14 @@ int set_fdb_entry_num(int num)
                 return -1;
         }
 
-        fdb_entry_num = num;
+        current_fdb_table->num = num;
 
         return 0;
 }
 
 int get_fdb_entry_size(void)
 {
-        return fdb_entry_size;
+        return current_fdb_table->size;
 }
 
 int set_fdb_entry_size(int size)
@@ -90,117 +302,176 @@ int set_fdb_entry_size(int size)
                 return -1;
         }
 
-        fdb_entry_size = size;
+        current_fdb_table->size = size;
 
         return 0;
 }
 
-void *malloc_fdb_entry(const int size)
+void *malloc_fdb_entry_r(struct fdb_table *t, const int size)
 {
-        void *p = (void *) fdb_entry_list;
-
         if ((size < 1) || (size > MAX_FDB_ENTRY_SIZE)) {
                 fprintf(stderr, "invalid FDB entry size: %d\n", size);
                 return NULL;
         }
 
-        memset(fdb_entry_list, 0, MAX_FDB_ENTRY_SIZE * FDB_ENTRY_LEN);
-
-        if (set_fdb_entry_num(0) == -1) {
-                fprintf(stderr, "set_fdb_entry_num() failed.\n");
+        if (is_macmap_initialized(&t->index) ? clear_macmap(&t->index) < 0 : init_macmap(&t->index, 0) < 0)
                 return NULL;
-        }
+        t->index_num = 0;
 
-        if (set_fdb_entry_size(size) == -1) {
-                fprintf(stderr, "set_fdb_entry_size() failed.\n");
-                return NULL;
-        }
+        memset(t->keys, 0, sizeof(t->keys));
+        memset(t->macaddrs, 0, sizeof(t->macaddrs));
+        memset(t->ports, 0, sizeof(t->ports));
+        memset(t->flags, 0, sizeof(t->flags));
+        memset(t->ages, 0, sizeof(t->ages));
+        t->num = 0;
+        t->size = size;
 
-        return p;
+        return (void *) t;
+}
+
+void *malloc_fdb_entry(const int size)
+{
+        return malloc_fdb_entry_r(current_fdb_table, size);
+}
+
+void free_fdb_entry_r(struct fdb_table *t)
+{
+        memset(t->keys, 0, sizeof(t->keys));
+        memset(t->macaddrs, 0, sizeof(t->macaddrs));
+        memset(t->ports, 0, sizeof(t->ports));
+        memset(t->flags, 0, sizeof(t->flags));
+        memset(t->ages, 0, sizeof(t->ages));
+        t->num = FDB_ENTRY_LIST_INVALID;
+        t->size = FDB_ENTRY_LIST_INVALID;
+        if (is_macmap_initialized(&t->index))
+                clear_macmap(&t->index);
+        t->index_num = 0;
 }
 
 void free_fdb_entry(void)
 {
-        memset(fdb_entry_list, 0, MAX_FDB_ENTRY_SIZE * FDB_ENTRY_LEN);
-        fdb_entry_num = FDB_ENTRY_LIST_INVALID;
-        fdb_entry_size = FDB_ENTRY_LIST_INVALID;
+        free_fdb_entry_r(current_fdb_table);
 }
 
-int add_fdb_entry(const struct fdb_entry *fdbp)
+/**
+ * @brief Add an entry to an index of a FDB table, entries before it must be indexed.
+ * @param t A pointer to a FDB table.
+ * @param n An index of the entry.
+ */
+static void index_fdb_entry(struct fdb_table *t, int n)
+{
+        /* a failure leaves the index behind, lookups scan entries until the next load */
+        if (t->index_num == n && (is_macmap_initialized(&t->index) || init_macmap(&t->index, 0) == 0) &&
+            add_macmap(&t->index, t->keys[n] | (u_int64_t) t->ports[n] << FDB_KEY_PORT_SHIFT, n) >= 0 &&
+            (t->flags[n] != FDB_ENTRY_PORT_IS_LOCAL || add_macmap(&t->index, t->keys[n] | FDB_KEY_LOCAL, n) >= 0))
+                t->index_num = n + 1;
+}
+
+int add_fdb_entry_r(struct fdb_table *t, const struct fdb_entry *fdbp)
 {
-        struct fdb_entry *p;
-        int i = 0, n = get_fdb_entry_num();
+        int n = t->num;
 
         if (n >= MAX_FDB_ENTRY_SIZE) {
                 fprintf(stderr, "FDB entry already full.\n");
                 return -1;
         }
 
-        if (exist_fdb_entry(fdbp) == 1) {
+        if (exist_fdb_entry_r(t, fdbp) == 1) {
                 fprintf(stderr, "Specified FDB entry already exist. n: %d\n", n);
                 return -1;
         }
 
-        p = &fdb_entry_list[n];
-        memcpy(p, fdbp, FDB_ENTRY_LEN);
+        t->keys[n] = get_fdb_key(fdbp->macaddr);
+        memcpy(t->macaddrs[n], fdbp->macaddr, ETHER_ADDR_LEN);
+        t->ports[n] = fdbp->port_no;
+        t->flags[n] = fdbp->is_local;
+        t->ages[n] = fdbp->ageing_timer_value.tv_sec * 1000 + fdbp->ageing_timer_value.tv_usec / 1000;
+        t->num = n + 1;
 
-        if (set_fdb_entry_num(n + 1) == -1) {
-                fprintf(stderr, "set_fdb_entry_num() failed.\n");
-                return -1;
-        }
+        index_fdb_entry(t, n);
 
         return 0;
 }
 
-int exist_fdb_entry(const struct fdb_entry *fdbp)
+int add_fdb_entry(const struct fdb_entry *fdbp)
 {
-        struct fdb_entry *p;
-        int i, n = get_fdb_entry_num();
+        return add_fdb_entry_r(current_fdb_table, fdbp);
+}
 
-        for (i = 0; i < n; i++) {
-                p = &fdb_entry_list[i];
-                /* Skip same MAC address and port number */
-                if (ether_addr_cmp(p->macaddr, fdbp->macaddr) &&
-                                p->port_no == fdbp->port_no)
+int exist_fdb_entry_r(struct fdb_table *t, const struct fdb_entry *fdbp)
+{
+        const u_int64_t key = get_fdb_key(fdbp->macaddr);
+        int i = -1;
+
+        if (t->index_num == t->num)
+                return find_macmap(&t->index, key | (u_int64_t) fdbp->port_no << FDB_KEY_PORT_SHIFT) >= 0;
+
+        /* Skip same MAC address and port number */
+        while ((i = find_fdb_key_r(t, key, i + 1)) >= 0)
+                if (t->ports[i] == fdbp->port_no)
                         return 1;
-        }
 
         return 0;
 }
 
-u_int16_t get_portno_by_macaddr(const u_int8_t macaddr[])
+int exist_fdb_entry(const struct fdb_entry *fdbp)
 {
-        struct fdb_entry *p;
-        int i, n = get_fdb_entry_num();
+        return exist_fdb_entry_r(current_fdb_table, fdbp);
+}
 
-        for (i = 0; i < n; i++) {
-                p = &fdb_entry_list[i];
-                if (ether_addr_cmp(p->macaddr, macaddr) && (p->is_local == FDB_ENTRY_PORT_IS_LOCAL))
-                        return p->port_no;
-        }
+u_int16_t get_portno_by_macaddr_r(struct fdb_table *t, const u_int8_t macaddr[])
+{
+        const u_int64_t key = get_fdb_key(macaddr);
+        int i = -1;
+
+        if (t->index_num == t->num)
+                return (i = find_macmap(&t->index, key | FDB_KEY_LOCAL)) >= 0 ? t->ports[i] : FDB_ENTRY_PORT_INVALID;
+
+        while ((i = find_fdb_key_r(t, key, i + 1)) >= 0)
+                if (t->flags[i] == FDB_ENTRY_PORT_IS_LOCAL)
+                        return t->ports[i];
 
         return FDB_ENTRY_PORT_INVALID;
 }
 
-int get_remote_entry_num_by_macaddr(const u_int8_t macaddr[], u_int8_t *macaddrs[])
+u_int16_t get_portno_by_macaddr(const u_int8_t macaddr[])
+{
+        return get_portno_by_macaddr_r(current_fdb_table, macaddr);
+}
+
+int get_remote_entry_num_by_macaddr_r(struct fdb_table *t, const u_int8_t macaddr[], u_int8_t *macaddrs[])
 {
-        const u_int16_t port_no = get_portno_by_macaddr(macaddr);
+        const u_int16_t port_no = get_portno_by_macaddr_r(t, macaddr);
 
         if (port_no == FDB_ENTRY_PORT_INVALID)
                 return 0;
 
-        return get_remote_entry_num_by_portno(port_no, macaddrs);
+        return get_remote_entry_num_by_portno_r(t, port_no, macaddrs);
 }
 
-int get_remote_entry_num_by_portno(const u_int16_t port_no, u_int8_t *macaddrs[])
+int get_remote_entry_num_by_macaddr(const u_int8_t macaddr[], u_int8_t *macaddrs[])
 {
-        struct fdb_entry *p;
-        int i, n = get_fdb_entry_num(), c = 0;
+        return get_remote_entry_num_by_macaddr_r(current_fdb_table, macaddr, macaddrs);
+}
 
-        for (i = 0; i < n; i++) {
-                p = &fdb_entry_list[i];
-                if ((p->port_no == port_no) && (p->is_local == FDB_ENTRY_PORT_NOT_LOCAL)) {
-                        macaddrs[c] = p->macaddr;
+int get_remote_entry_num_by_portno_r(struct fdb_table *t, const u_int16_t port_no, u_int8_t *macaddrs[])
+{
+        const fdb_port_mask f = get_fdb_port_mask_func();
+        u_int32_t m;
+        int i, j, c = 0;
+
+        /* a port has many entries, so matches of a block are taken in one pass */
+        for (i = 0; i + FDB_PORT_BLOCK <= t->num; i += FDB_PORT_BLOCK) {
+                for (m = f(t->ports + i, port_no) & 0x55555555U; m != 0; m &= m - 1) {
+                        j = i + __builtin_ctz(m) / 2;
+                        if (t->flags[j] == FDB_ENTRY_PORT_NOT_LOCAL)
+                                macaddrs[c++] = t->macaddrs[j];
+                }
+        }
+
+        for (; i < t->num; i++) {
+                if ((t->ports[i] == port_no) && (t->flags[i] == FDB_ENTRY_PORT_NOT_LOCAL)) {
+                        macaddrs[c] = t->macaddrs[i];
                         c += 1;
                 }
         }
@@ -208,6 +479,11 @@ int get_remote_entry_num_by_portno(const u_int16_t port_no, u_int8_t *macaddrs[]
         return c;
 }
 
+int get_remote_entry_num_by_portno(const u_int16_t port_no, u_int8_t *macaddrs[])
+{
+        return get_remote_entry_num_by_portno_r(current_fdb_table, port_no, macaddrs);
+}
+
 #ifdef __linux__
 static inline void jiffies_to_tv(struct timeval *tv, unsigned long jiffies)
 {
@@ -229,7 +505,7 @@ static inline void copy_fdb(struct fdb_entry *ent,
 }
 #endif /* __linux__ */
 
-int read_fdb(const char *bridge_name)
+int read_fdb_r(struct fdb_table *t, const char *bridge_name)
 {
 #ifdef __linux__
         FILE *f;
@@ -290,7 +566,7 @@ int read_fdb(const char *bridge_name)
         for (i = 0; i < n; i++) {
                 copy_fdb(&fdb, &fe[i]);
 
-                if (add_fdb_entry(&fdb) < 0) {
+                if (add_fdb_entry_r(t, &fdb) < 0) {
                         fprintf(stderr, "add_fdb_entry() failed.\n");
                 }
         }
@@ -300,27 +576,101 @@ int read_fdb(const char *bridge_name)
         return 0;
 }
 
-int load_fdb(const char *brname, const int size)
+int read_fdb(const char *bridge_name)
 {
-        struct fdb_entry *p;
+        return read_fdb_r(current_fdb_table, bridge_name);
+}
 
-        if (get_fdb_entry_list() != NULL) {
-                free_fdb_entry();
+/**
+ * @brief Get a digest of FDB entries.
+ *
+ * The order of entries in brforward may change, so hashes of entries are summed.
+ *
+ * @param t A pointer to a FDB table.
+ * @return A digest of MAC addresses and port numbers of entries.
+ */
+static u_int32_t get_fdb_digest(const struct fdb_table *t)
+{
+        u_int32_t digest = 0, h;
+        int i, j;
+
+        for (i = 0; i < t->num; i++) {
+                /* FNV-1a */
+                h = 2166136261u;
+                for (j = 0; j < ETHER_ADDR_LEN; j++)
+                        h = (h ^ t->macaddrs[i][j]) * 16777619u;
+                h = (h ^ (t->ports[i] & 0xff)) * 16777619u;
+                h = (h ^ (t->ports[i] >> 8)) * 16777619u;
+                digest += h;
         }
 
-        if ((p = malloc_fdb_entry(size)) == NULL) {
+        return digest;
+}
+
+int load_fdb_r(struct fdb_table *t, const char *brname, const int size)
+{
+        free_fdb_entry_r(t);
+
+        if (malloc_fdb_entry_r(t, size) == NULL) {
                 fprintf(stderr, "malloc_fdb_entry() failed.\n");
                 return -1;
         }
 
-        if (read_fdb(brname) == -1) {
+        if (read_fdb_r(t, brname) == -1) {
                 fprintf(stderr, "read_fdb() failed.\n");
                 return -1;
         }
 
+        t->digest = get_fdb_digest(t);
+
         return 0;
 }
 
+int load_fdb(const char *brname, const int size)
+{
+        return load_fdb_r(current_fdb_table, brname, size);
+}
+
+int filter_fdb_entry_r(struct fdb_table *t, int (*keep)(const struct fdb_table *, int, void *), void *arg)
+{
+        int i, n;
+
+        for (i = 0, n = 0; i < t->num; i++) {
+                if (!keep(t, i, arg))
+                        continue;
+                if (n != i) {
+                        t->keys[n] = t->keys[i];
+                        memcpy(t->macaddrs[n], t->macaddrs[i], ETHER_ADDR_LEN);
+                        t->ports[n] = t->ports[i];
+                        t->flags[n] = t->flags[i];
+                        t->ages[n] = t->ages[i];
+                }
+                n += 1;
+        }
+
+        if (n == t->num)
+                return 0;
+
+        memset(t->keys + n, 0, (t->num - n) * sizeof(t->keys[0]));
+        memset(t->macaddrs + n, 0, (t->num - n) * sizeof(t->macaddrs[0]));
+        memset(t->ports + n, 0, (t->num - n) * sizeof(t->ports[0]));
+        memset(t->flags + n, 0, (t->num - n) * sizeof(t->flags[0]));
+        memset(t->ages + n, 0, (t->num - n) * sizeof(t->ages[0]));
+        i = t->num - n;
+        t->num = n;
+
+        /* entries moved, so the index is built again */
+        if (is_macmap_initialized(&t->index))
+                clear_macmap(&t->index);
+        t->index_num = 0;
+        for (n = 0; n < t->num; n++)
+                index_fdb_entry(t, n);
+
+        t->digest = get_fdb_digest(t);
+
+        return i;
+}
+
 void print_fdb(struct fdb_entry *fdbs, int n)
 {
     int i;
@@ -343,13 +693,18 @@ void print_fdb(struct fdb_entry *fdbs, int n)
     }
 }
 
-void print_fdb_entry(void)
+void print_fdb_entry_r(struct fdb_table *t)
 {
         int i;
-        struct fdb_entry *p;
+        struct fdb_entry e;
 
-        for (i = 0; i < fdb_entry_num; i++) {
-                p = &fdb_entry_list[i];
-                print_fdb(p, 1);
+        for (i = 0; i < t->num; i++) {
+                get_fdb_entry_r(t, i, &e);
+                print_fdb(&e, 1);
         }
 }
+
+void print_fdb_entry(void)
+{
+        print_fdb_entry_r(current_fdb_table);
+}
@@ -0,0 +1,253 @@
+/**
+ * @file   fdbflap.c
+ * @brief A library detecting MAC addresses moving between ports of a bridge.
+ *
+ * A source file of a library that keep the last port and a decaying counter of
+ * moves of each MAC address of a FDB, so a MAC address jumping between ports,
+ * like by a loop or a misconfiguration, is reported as flapping and left out
+ * of advertisements until it settles.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "datalink.h"
+#include "fdb.h"
+#include "fdbflap.h"
+#include "macmap.h"
+
+int init_fdb_flap_table(struct fdb_flap_table *f, int threshold, u_int32_t half_life)
+{
+        memset(f, 0, sizeof(struct fdb_flap_table));
+
+        if (threshold < 0 || threshold >= 0xFFFF / FDB_FLAP_MOVE || half_life == 0) {
+                fprintf(stderr, "invalid flap threshold: %d, half-life: %u\n", threshold, half_life);
+                return -1;
+        }
+
+        if ((f->list = malloc(FDB_FLAP_INIT_SIZE * sizeof(struct fdb_flap_entry))) == NULL) {
+                perror("malloc");
+                return -1;
+        }
+        f->size = FDB_FLAP_INIT_SIZE;
+
+        if (init_macmap(&f->index, 0) < 0) {
+                free(f->list);
+                f->list = NULL;
+                return -1;
+        }
+
+        f->threshold = threshold;
+        f->half_life = half_life;
+
+        return 0;
+}
+
+void destroy_fdb_flap_table(struct fdb_flap_table *f)
+{
+        free(f->list);
+        destroy_macmap(&f->index);
+        memset(f, 0, sizeof(struct fdb_flap_table));
+}
+
+/**
+ * @brief Halve a counter of an entry for each half-life passed.
+ */
+static void decay_fdb_flap_entry(const struct fdb_flap_table *f, struct fdb_flap_entry *e, u_int32_t sec)
+{
+        u_int32_t n = (sec - e->stamp) / f->half_life;
+
+        if (n == 0)
+                return;
+
+        /* the rest of a half-life is kept for the next decay */
+        e->score = n < 16 ? e->score >> n : 0;
+        e->stamp += n * f->half_life;
+}
+
+/**
+ * @brief Add an entry of a MAC address.
+ * @return If succeeded, it returns an index of the entry. If failed, it returns -1.
+ */
+static int add_fdb_flap_entry(struct fdb_flap_table *f, u_int64_t key, u_int16_t port_no, u_int32_t sec)
+{
+        struct fdb_flap_entry *p;
+        int size;
+
+        if (f->num == f->size) {
+                size = f->size * 2;
+                if ((p = realloc(f->list, size * sizeof(struct fdb_flap_entry))) == NULL) {
+                        perror("realloc");
+                        return -1;
+                }
+                f->list = p;
+                f->size = size;
+        }
+
+        if (add_macmap(&f->index, key, f->num) != 0)
+                return -1;
+
+        p = f->list + f->num;
+        memset(p, 0, sizeof(struct fdb_flap_entry));
+        p->key = key | (u_int64_t) port_no << FDB_KEY_PORT_SHIFT;
+        p->stamp = sec;
+        p->flags = FDB_FLAP_FLAG_SEEN;
+
+        return f->num++;
+}
+
+/**
+ * @brief Remove an entry by moving the last entry to its place.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int remove_fdb_flap_entry(struct fdb_flap_table *f, int i)
+{
+        const int last = f->num - 1;
+
+        if (remove_macmap(&f->index, f->list[i].key & FDB_KEY_MASK) < 0)
+                return -1;
+
+        if (i != last) {
+                if (remove_macmap(&f->index, f->list[last].key & FDB_KEY_MASK) < 0 ||
+                    add_macmap(&f->index, f->list[last].key & FDB_KEY_MASK, i) != 0)
+                        return -1;
+                f->list[i] = f->list[last];
+        }
+        f->num = last;
+
+        return 0;
+}
+
+int update_fdb_flap(struct fdb_flap_table *f, const struct fdb_table *t, u_int64_t now)
+{
+        struct fdb_flap_entry *e;
+        const u_int32_t sec = now / 1000;
+        const u_int32_t start = f->threshold * FDB_FLAP_MOVE, stop = start / 2;
+        int i, j, events = 0;
+
+        if (f->threshold == 0)
+                return 0;
+
+        for (i = 0; i < f->num; i++) {
+                decay_fdb_flap_entry(f, f->list + i, sec);
+                f->list[i].flags &= ~FDB_FLAP_FLAG_SEEN;
+        }
+
+        for (i = 0; i < t->num; i++) {
+                /* local entries are addresses of the bridge itself, they never move */
+                if (t->flags[i] == FDB_ENTRY_PORT_IS_LOCAL)
+                        continue;
+
+                if ((j = find_macmap(&f->index, t->keys[i])) < 0) {
+                        if (add_fdb_flap_entry(f, t->keys[i], t->ports[i], sec) < 0)
+                                return -1;
+                        continue;
+                }
+
+                /* a MAC address on two ports of a load is counted once */
+                e = f->list + j;
+                if (e->flags & FDB_FLAP_FLAG_SEEN)
+                        continue;
+                e->flags |= FDB_FLAP_FLAG_SEEN;
+
+                if ((u_int16_t) (e->key >> FDB_KEY_PORT_SHIFT) == t->ports[i])
+                        continue;
+
+                e->key = t->keys[i] | (u_int64_t) t->ports[i] << FDB_KEY_PORT_SHIFT;
+                e->score = e->score < 0xFFFF - FDB_FLAP_MOVE ? e->score + FDB_FLAP_MOVE : 0xFFFF;
+                f->moves += 1;
+        }
+
+        for (i = 0; i < f->num; i++) {
+                e = f->list + i;
+
+                if (!(e->flags & FDB_FLAP_FLAG_FLAPPING) && e->score >= start) {
+                        e->flags |= FDB_FLAP_FLAG_FLAPPING;
+                        f->flapping += 1;
+                        f->flaps += 1;
+                        events += 1;
+                } else if ((e->flags & FDB_FLAP_FLAG_FLAPPING) && e->score < stop) {
+                        e->flags &= ~FDB_FLAP_FLAG_FLAPPING;
+                        f->flapping -= 1;
+                        events += 1;
+                }
+        }
+
+        /* backward, so an entry moved into a place was already looked at */
+        for (i = f->num - 1; i >= 0; i--) {
+                e = f->list + i;
+                if (!(e->flags & (FDB_FLAP_FLAG_SEEN | FDB_FLAP_FLAG_FLAPPING)) && e->score == 0 &&
+                    remove_fdb_flap_entry(f, i) < 0)
+                        return -1;
+        }
+
+        return events;
+}
+
+/**
+ * @brief Check whether a MAC address by get_fdb_key() is flapping.
+ */
+static int is_fdb_key_flapping(const struct fdb_flap_table *f, u_int64_t key)
+{
+        int i;
+
+        if (f->flapping == 0 || (i = find_macmap(&f->index, key)) < 0)
+                return 0;
+
+        return (f->list[i].flags & FDB_FLAP_FLAG_FLAPPING) != 0;
+}
+
+int is_fdb_flapping(const struct fdb_flap_table *f, const u_int8_t macaddr[])
+{
+        return is_fdb_key_flapping(f, get_fdb_key(macaddr));
+}
+
+/**
+ * @brief Check whether an entry is kept in advertisements.
+ */
+static int keep_fdb_flap_entry(const struct fdb_table *t, int i, void *arg)
+{
+        return t->flags[i] == FDB_ENTRY_PORT_IS_LOCAL || !is_fdb_key_flapping(arg, t->keys[i]);
+}
+
+int suppress_fdb_flap(const struct fdb_flap_table *f, struct fdb_table *t)
+{
+        if (f->flapping == 0)
+                return 0;
+
+        return filter_fdb_entry_r(t, keep_fdb_flap_entry, (void *) f);
+}
+
+void print_fdb_flap(const struct fdb_flap_table *f, const char *brname)
+{
+        const struct fdb_flap_entry *e;
+        u_int8_t macaddr[ETHER_ADDR_LEN];
+        char maddr[MAC_BUF_SIZE];
+        int i, j;
+
+        printf("flapping MAC addresses on bridge %s: %d, moves: %llu, flaps: %llu\n", brname, f->flapping,
+                (unsigned long long) f->moves, (unsigned long long) f->flaps);
+
+        for (i = 0; i < f->num; i++) {
+                e = f->list + i;
+                if (!(e->flags & FDB_FLAP_FLAG_FLAPPING))
+                        continue;
+
+                for (j = 0; j < ETHER_ADDR_LEN; j++)
+                        macaddr[j] = e->key >> (j * 8);
+                ether_addr_str(macaddr, maddr);
+                printf("  %s last port %u, moves: %u.%02u\n", maddr, (u_int) (e->key >> FDB_KEY_PORT_SHIFT),
+                        e->score / FDB_FLAP_MOVE, e->score % FDB_FLAP_MOVE * 100 / FDB_FLAP_MOVE);
+        }
+}
@@ -23,79 +23,215 @@
 #include "tlv.h"
 #include "htip.h"
 #include "fdb.h"
+#include "txpool.h"
+
+/**
+ * @brief Get a TTL of frames of a context.
+ * @param ctx A pointer to a HTIP context.
+ * @return TTL_INTERVAL_MULTIPLIER times of the interval, or TTL_DEFAULT if the interval is not set.
+ */
+static u_int16_t get_htip_ttl(const struct htip_ctx *ctx)
+{
+        u_int ttl;
+
+        if (ctx->interval == 0)
+                return TTL_DEFAULT;
+
+        ttl = (u_int) ctx->interval * TTL_INTERVAL_MULTIPLIER;
+
+        return ttl > TTL_MAX ? TTL_MAX : ttl;
+}
+
+/**
+ * @brief Create MAC address list TLVs of a context.
+ *
+ * MAC addresses of all interfaces and remote entries of the FDB are listed
+ * once each, as many as fit in len.
+ *
+ * @param ctx A pointer to a HTIP context.
+ * @param p A head pointer to create TLV.
+ * @param len A length available for the TLVs.
+ * @return Bytes of created TLV, 0 if no address is listed. If failed, it returns -1.
+ */
+static int create_htip_ctx_mac_address_list_tlv(const struct htip_ctx *ctx, u_char *p, u_int len)
+{
+        u_int8_t **macaddrs, *macaddr;
+        int i, j, num = 0, size, max_num, ret;
+
+        /* even an empty TLV takes a header, so nothing is written without a room for an address */
+        if ((max_num = get_htip_mac_address_list_max_num(len)) == 0)
+                return 0;
+
+        size = ctx->ifinfo->num + (ctx->fdb != NULL && ctx->fdb->num > 0 ? ctx->fdb->num : 0);
+        if ((macaddrs = malloc(sizeof(u_int8_t *) * (size + 1))) == NULL) {
+                perror("malloc");
+                return -1;
+        }
+
+        for (i = 0; i < size && num < max_num; i++) {
+                if (i < ctx->ifinfo->num) {
+                        macaddr = ctx->ifinfo->list[i].macaddr;
+                } else {
+                        j = i - ctx->ifinfo->num;
+                        if (ctx->fdb->flags[j] != FDB_ENTRY_PORT_NOT_LOCAL)
+                                continue;
+                        macaddr = ctx->fdb->macaddrs[j];
+                }
+
+                /* VLANs and bonding slaves share a MAC address */
+                for (j = 0; j < num; j++) {
+                        if (ether_addr_cmp(macaddrs[j], macaddr))
+                                break;
+                }
+                if (j == num)
+                        macaddrs[num++] = macaddr;
+        }
+
+        ret = num > 0 ? create_htip_mac_address_list_tlv(p, macaddrs, num) : 0;
+        free(macaddrs);
+
+        return ret;
+}
+
+/**
+ * @brief Fill a HTIP context with the default tables and device parameters.
+ */
+static void init_default_htip_ctx(struct htip_ctx *ctx, u_char *device_category,
+        int device_category_len, u_char *manufacturer_code, u_char *model_name,
+        int model_name_len, u_char *model_number, int model_number_len)
+{
+        memset(ctx, 0, sizeof(*ctx));
+        ctx->ifinfo = get_ifinfo_table();
+        ctx->fdb = get_fdb_table();
+        ctx->device_category = device_category;
+        ctx->device_category_len = device_category_len;
+        ctx->manufacturer_code = manufacturer_code;
+        ctx->model_name = model_name;
+        ctx->model_name_len = model_name_len;
+        ctx->model_number = model_number;
+        ctx->model_number_len = model_number_len;
+}
 
 int send_htip_device_info(u_char *device_category, int device_category_len,
         u_char *manufacturer_code, u_char *model_name, int model_name_len,
         u_char *model_number, int model_number_len)
 {
-        u_int len, rlen;
-        int n;
+        struct htip_ctx ctx;
+
+        init_default_htip_ctx(&ctx, device_category, device_category_len,
+                manufacturer_code, model_name, model_name_len,
+                model_number, model_number_len);
+
+        return send_htip_device_info_r(&ctx);
+}
+
+int send_htip_device_info_r(struct htip_ctx *ctx)
+{
+        int i;
+
+        for (i = 0; i < ctx->ifinfo->num; i++) {
+                if (send_htip_device_info_ifinfo_r(ctx, ctx->ifinfo->list + i) < 0)
+                        return -1;
+        }
+
+        return 0;
+}
+
+int send_htip_device_info_ifinfo(struct ifinfo *ifip,
+        u_char *device_category, int device_category_len,
+        u_char *manufacturer_code, u_char *model_name, int model_name_len,
+        u_char *model_number, int model_number_len)
+{
+        struct htip_ctx ctx;
+
+        init_default_htip_ctx(&ctx, device_category, device_category_len,
+                manufacturer_code, model_name, model_name_len,
+                model_number, model_number_len);
+
+        return send_htip_device_info_ifinfo_r(&ctx, ifip);
+}
+
+int send_htip_device_info_ifinfo_r(struct htip_ctx *ctx, struct ifinfo *ifip)
+{
+        u_int len = 0, rlen = 0;
+        int n, mlen;
         u_char *payload;
         u_char dstaddr[] = HTIP_L2AGENT_DST_MACADDR;
-        struct ifinfo *ifip;
-        int i, num = get_ifinfo_list_num();
 
-        for (i = 0; i < num; i++) {
-                len = 0;
-                rlen = 0;
-                ifip = get_ifinfo_list() + i;
+        if (ifip->fd < 0)
+                return 0;
 
-                if (ifip->fd < 0) {
-                        continue;
-                }
+        if ((payload = malloc(ETH_DATA_LEN)) == NULL) {
+                perror("malloc");
+                return -1;
+        }
 
-                if ((payload = malloc(ETH_DATA_LEN)) == NULL) {
-                        perror("malloc");
-                        return -1;
-                }
+        memset(payload, 0, ETH_DATA_LEN);
+        len += create_lldp_tlv_ttl(payload, ifip->macaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname), get_htip_ttl(ctx));
 
-                memset(payload, 0, ETH_DATA_LEN);
-                len += create_lldp_tlv(payload, ifip->macaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname));
-
-                if ((rlen = create_basic_htip_device_info_tlv(
-                    payload + len, ifip->macaddr, ETHER_ADDR_LEN,
-                    (u_char *) ifip->ifname, strlen(ifip->ifname),
-                    device_category, device_category_len, manufacturer_code,
-                    model_name, model_name_len, model_number,
-                    model_number_len)) == 0) {
-                        fprintf(stderr, "create_required_htip_device_info_tlv() failed\n");
-                        return -1;
-                }
+        if ((rlen = create_basic_htip_device_info_tlv(
+            payload + len, ifip->macaddr, ETHER_ADDR_LEN,
+            (u_char *) ifip->ifname, strlen(ifip->ifname),
+            ctx->device_category, ctx->device_category_len, ctx->manufacturer_code,
+            ctx->model_name, ctx->model_name_len, ctx->model_number,
+            ctx->model_number_len)) == 0) {
+                fprintf(stderr, "create_required_htip_device_info_tlv() failed\n");
+                free(payload);
+                return -1;
+        }
 
-                len += rlen;
-                len += create_end_of_lldpdu_tlv(payload + len);
-#ifdef DEBUG
-                printf("  htip frame created: %d bytes using macaddr: %02x:%02x:%02x:%02x:%02x:%02x, ifname: %s.\n",
-                        len, ifip->macaddr[0], ifip->macaddr[1], ifip->macaddr[2], ifip->macaddr[3], ifip->macaddr[4], ifip->macaddr[5], ifip->ifname);
-#endif /* DEBUG */
-                if ((n = write_frame(ifip->fd, ifip->ifname, dstaddr, ifip->macaddr, payload, len)) < 0) {
-                        fprintf(stderr, "write_frame() failed on ifname: %s.\n", ifip->ifname);
-                        return -1;
-                }
+        len += rlen;
 
-                if (n != (len + sizeof(struct ether_header))) {
-                        fprintf(stderr, "sent bytes: %d != htip frame bytes:%d\n", n, len);
-                }
+        if (ctx->interval > 0)
+                len += create_htip_transmission_interval_tlv(payload + len, ctx->interval);
 
+        /* leave a room for End of LLDPDU TLV */
+        if (ctx->mac_list && (mlen = create_htip_ctx_mac_address_list_tlv(ctx, payload + len,
+                ETH_DATA_LEN - len - TLV_HEADER_LEN)) > 0)
+                len += mlen;
+        len += create_end_of_lldpdu_tlv(payload + len);
+#ifdef DEBUG
+        printf("  htip frame created: %d bytes using macaddr: %02x:%02x:%02x:%02x:%02x:%02x, ifname: %s.\n",
+                len, ifip->macaddr[0], ifip->macaddr[1], ifip->macaddr[2], ifip->macaddr[3], ifip->macaddr[4], ifip->macaddr[5], ifip->ifname);
+#endif /* DEBUG */
+        if ((n = write_frame(ifip->fd, ifip->ifname, dstaddr, ifip->macaddr, payload, len)) < 0) {
+                fprintf(stderr, "write_frame() failed on ifname: %s.\n", ifip->ifname);
                 free(payload);
+                return -1;
         }
 
+        if (n != (len + sizeof(struct ether_header))) {
+                fprintf(stderr, "sent bytes: %d != htip frame bytes:%d\n", n, len);
+        }
+
+        ifip->changed = 0;
+        free(payload);
+
         return 0;
 }
 
 int send_htip_link_info(void)
+{
+        struct htip_ctx ctx;
+
+        init_default_htip_ctx(&ctx, NULL, 0, NULL, NULL, 0, NULL, 0);
+
+        return send_htip_link_info_r(&ctx);
+}
+
+int send_htip_link_info_r(struct htip_ctx *ctx)
 {
         int link_info_tlv_len = 0, len = 0, rlen, n;
         u_char *payload, *link_info_payload;
         u_char dstaddr[] = HTIP_L2AGENT_DST_MACADDR;
         struct ifinfo *ifip;
-        int i, num = get_ifinfo_list_num(), macaddr_num;
+        int i, num = ctx->ifinfo->num, macaddr_num;
         u_int8_t *macaddrs[MAX_FDB_ENTRY_SIZE];
 
         for (i = 0; i < num; i++) {
-                ifip = get_ifinfo_list() + i;
+                ifip = ctx->ifinfo->list + i;
                 memset(macaddrs, 0, sizeof(macaddrs));
-                macaddr_num = get_remote_entry_num_by_macaddr(ifip->macaddr, macaddrs);
+                macaddr_num = get_remote_entry_num_by_macaddr_r(ctx->fdb, ifip->macaddr, macaddrs);
 
                 if (macaddr_num == 0)
                         continue;
@@ -111,13 +247,13 @@ int send_htip_link_info(void)
         for (i = 0; i < num; i++) {
                 len = 0;
                 rlen = 0;
-                ifip = get_ifinfo_list() + i;
+                ifip = ctx->ifinfo->list + i;
 
                 if (ifip->fd < 0)
                         continue;
 
                 memset(macaddrs, 0, sizeof(macaddrs));
-                macaddr_num = get_remote_entry_num_by_macaddr(ifip->macaddr, macaddrs);
+                macaddr_num = get_remote_entry_num_by_macaddr_r(ctx->fdb, ifip->macaddr, macaddrs);
 
                 if (macaddr_num == 0)
                         continue;
@@ -130,7 +266,7 @@ int send_htip_link_info(void)
                 }
 
                 memset(payload, 0, ETH_DATA_LEN);
-                len += create_lldp_tlv(payload, ifip->macaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname));
+                len += create_lldp_tlv_ttl(payload, ifip->macaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname), get_htip_ttl(ctx));
 
                 if ((rlen = create_basic_htip_link_info_tlv(payload,
                         ifip->macaddr, ETHER_ADDR_LEN,
@@ -167,20 +303,166 @@ int send_htip_device_link_info(u_char *device_category,
         int device_category_len, u_char *manufacturer_code, u_char *model_name,
         int model_name_len, u_char *model_number, int model_number_len, u_char *srcaddr)
 {
+        struct htip_ctx ctx;
+
+        init_default_htip_ctx(&ctx, device_category, device_category_len,
+                manufacturer_code, model_name, model_name_len,
+                model_number, model_number_len);
+        ctx.srcaddr = srcaddr;
+
+        return send_htip_device_link_info_r(&ctx);
+}
+
+/**
+ * @brief Link information shared by frames of all ports.
+ */
+struct htip_link_job {
+        /** A HTIP context */
+        struct htip_ctx *ctx;
+        /** Encoded link information TLVs of all ports */
+        u_char *link_info_payload;
+        /** A length of link_info_payload */
+        u_int link_info_tlv_len;
+        /** Ends of link information of ports in link_info_payload, a frame is cut only between ports */
+        u_int *link_info_ends;
+        /** A number of ports in link_info_ends */
+        int link_info_num;
+        /** A number of ports left out of frames for lack of room, added by workers */
+        int dropped;
+};
+
+/**
+ * @brief Encode and send a HTIP device information and link information to a port.
+ * @param arg A pointer to struct htip_link_job.
+ * @param index An index of the port in the ifinfo table.
+ * @param sock A socket to send the frame, -1 to use write_frame().
+ * @return If succeed, it returns 0. If failed, it returns -1.
+ */
+static int send_htip_device_link_info_port(void *arg, int index, int sock)
+{
+        struct htip_link_job *job = arg;
+        struct htip_ctx *ctx = job->ctx;
+        struct ifinfo *ifip = ctx->ifinfo->list + index;
         u_char dstaddr[] = HTIP_L2AGENT_DST_MACADDR;
+        u_char *payload, *srcaddr;
+        u_int8_t *macaddrs[MAX_FDB_ENTRY_SIZE];
+        u_int len = 0, rlen = 0, link_len, room;
+        int macaddr_num, n, mlen, link_num;
+
+        if (ifip->fd < 0)
+                return 0;
+
+        memset(macaddrs, 0, sizeof(macaddrs));
+        macaddr_num = get_remote_entry_num_by_macaddr_r(ctx->fdb, ifip->macaddr, macaddrs);
+
+        if (macaddr_num == 0)
+                return 0;
+
+        if ((payload = malloc(ETH_DATA_LEN)) == NULL) {
+                perror("malloc");
+                return -1;
+        }
+
+        memset(payload, 0, ETH_DATA_LEN);
+
+        srcaddr = ctx->srcaddr ? ctx->srcaddr : ifip->macaddr;
+        len += create_lldp_tlv_ttl(payload, srcaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname), get_htip_ttl(ctx));
+
+        if ((rlen = create_basic_htip_device_info_tlv(payload + len,
+                ifip->macaddr, ETHER_ADDR_LEN,
+                (u_char *) ifip->ifname, strlen(ifip->ifname),
+                ctx->device_category, ctx->device_category_len,
+                ctx->manufacturer_code, ctx->model_name, ctx->model_name_len,
+                ctx->model_number, ctx->model_number_len)) == 0) {
+                fprintf(stderr, "create_required_htip_device_info_tlv() failed\n");
+                free(payload);
+                return -1;
+        }
+
+        len += rlen;
+
+        if (ctx->interval > 0)
+                len += create_htip_transmission_interval_tlv(payload + len, ctx->interval);
+
+        /* link information of as many ports as fit, with a room for End of LLDPDU TLV */
+        room = len + TLV_HEADER_LEN < ETH_DATA_LEN ? ETH_DATA_LEN - len - TLV_HEADER_LEN : 0;
+        for (link_num = job->link_info_num; link_num > 0 && job->link_info_ends[link_num - 1] > room; link_num--)
+                ;
+        link_len = link_num > 0 ? job->link_info_ends[link_num - 1] : 0;
+        if (link_num < job->link_info_num)
+                __atomic_fetch_add(&job->dropped, job->link_info_num - link_num, __ATOMIC_RELAXED);
+
+        /* MAC address lists take the room left by link information */
+        if (ctx->mac_list && len + link_len + TLV_HEADER_LEN < ETH_DATA_LEN &&
+            (mlen = create_htip_ctx_mac_address_list_tlv(ctx, payload + len,
+                ETH_DATA_LEN - len - link_len - TLV_HEADER_LEN)) > 0)
+                len += mlen;
+
+        if ((rlen = create_basic_htip_link_info_tlv(payload + len,
+                ifip->macaddr, ETHER_ADDR_LEN,
+                (u_char *) ifip->ifname, strlen(ifip->ifname),
+                job->link_info_payload, link_len)) == -1) {
+                fprintf(stderr, "create_basic_htip_link_info_tlv() failed\n");
+                free(payload);
+                return -1;
+        }
+
+        len += rlen;
+        len += create_end_of_lldpdu_tlv(payload + len);
+#ifdef DEBUG
+        printf("  htip frame created: %d bytes using macaddr: %02x:%02x:%02x:%02x:%02x:%02x, ifname: %s.\n",
+                len, ifip->macaddr[0], ifip->macaddr[1], ifip->macaddr[2], ifip->macaddr[3], ifip->macaddr[4], ifip->macaddr[5], ifip->ifname);
+#endif /* DEBUG */
+
+#ifdef __linux__
+        if (sock >= 0)
+                n = write_frame_ifindex(sock, ifip->ifindex, dstaddr, srcaddr, payload, len);
+        else
+#endif /* __linux__ */
+                n = write_frame(ifip->fd, ifip->ifname, dstaddr, srcaddr, payload, len);
+
+        if (n < 0) {
+                fprintf(stderr, "write_frame() failed on ifname: %s.\n", ifip->ifname);
+                free(payload);
+                return -1;
+        }
+
+        if (n != (len + sizeof(struct ether_header)))
+                fprintf(stderr, "sent bytes: %d != htip frame bytes:%d\n", n, len);
+#ifdef DEBUG
+        fprintf(stderr, "\tsent htip bytes: %d\n", len);
+#endif /* DEBUG */
+
+        free(payload);
+
+        return 0;
+}
+
+int send_htip_device_link_info_r(struct htip_ctx *ctx)
+{
+        struct htip_link_job job;
         struct ifinfo *ifip;
-        int i, num = get_ifinfo_list_num(), macaddr_num, n;
+        int i, num = ctx->ifinfo->num, macaddr_num, ret = 0;
         u_int len, rlen, link_info_tlv_len = 0;
-        u_char *payload, *link_info_payload;
+        u_char *link_info_payload;
         u_int8_t *macaddrs[MAX_FDB_ENTRY_SIZE];
-        u_int16_t port_no;
-        char tmp_macaddr[MAC_BUF_SIZE] = {0};
+        u_int16_t port_no, max_port_no = 0;
+        u_int portno_len;
+
+        /* all link information of a frame has the same length of port numbers */
+        for (i = 0; i < num; i++) {
+                ifip = ctx->ifinfo->list + i;
+                port_no = get_portno_by_macaddr_r(ctx->fdb, ifip->macaddr);
+                if (port_no != FDB_ENTRY_PORT_INVALID && port_no > max_port_no)
+                        max_port_no = port_no;
+        }
+        portno_len = get_htip_link_info_portno_len(max_port_no);
 
         for (i = 0; i < num; i++) {
-                ifip = get_ifinfo_list() + i;
+                ifip = ctx->ifinfo->list + i;
                 memset(macaddrs, 0, sizeof(macaddrs));
-                macaddr_num = get_remote_entry_num_by_macaddr(ifip->macaddr, macaddrs);
-                link_info_tlv_len += get_htip_link_info_tlv_len(ETHER_ADDR_LEN, macaddr_num);
+                macaddr_num = get_remote_entry_num_by_macaddr_r(ctx->fdb, ifip->macaddr, macaddrs);
+                link_info_tlv_len += get_htip_link_info_tlv_len_portno_len(ETHER_ADDR_LEN, macaddr_num, portno_len);
         }
 
         if ((link_info_payload = malloc(link_info_tlv_len)) == NULL) {
@@ -188,25 +470,35 @@ int send_htip_device_link_info(u_char *device_category,
                 return -1;
         }
 
+        if ((job.link_info_ends = malloc(sizeof(u_int) * (num + 1))) == NULL) {
+                perror("malloc");
+                free(link_info_payload);
+                return -1;
+        }
+        job.link_info_num = 0;
+
         len = 0;
 
         for (i = 0; i < num; i++) {
-                ifip = get_ifinfo_list() + i;
+                ifip = ctx->ifinfo->list + i;
                 memset(macaddrs, 0, sizeof(macaddrs));
-                macaddr_num = get_remote_entry_num_by_macaddr(ifip->macaddr, macaddrs);
+                macaddr_num = get_remote_entry_num_by_macaddr_r(ctx->fdb, ifip->macaddr, macaddrs);
 #ifdef DEBUG
                 printf("  HTIP link info try to create if: %s, iftype: %d, port: %d, mac_num: %d\n",
                         ifip->ifname, ifip->iftype, port_no, macaddr_num);
 #endif /* DEBUG */
 
-                if ((port_no = get_portno_by_macaddr(ifip->macaddr)) == FDB_ENTRY_PORT_INVALID) {
+                if ((port_no = get_portno_by_macaddr_r(ctx->fdb, ifip->macaddr)) == FDB_ENTRY_PORT_INVALID) {
                         fprintf(stderr, "get_portno_by_macaddr() failed with IF: %s.\n", ifip->ifname);
                         fprintf(stderr, "This interface may not join bridge. Ignore to add FDB entry for this interface.\n");
                         continue;
                 }
 
-                rlen = create_htip_link_info_tlv(link_info_payload + len, ifip->iftype, port_no, macaddrs, macaddr_num);
+                rlen = create_htip_link_info_tlv_portno_len(link_info_payload + len, ifip->iftype, port_no,
+                        portno_len, macaddrs, macaddr_num);
                 len += rlen;
+                if (rlen > 0)
+                        job.link_info_ends[job.link_info_num++] = len;
 #ifdef DEBUG
                 printf("  HTIP link info create if: %s, iftype: %d, port: %d, mac_num: %d, len: %d\n",
                                  ifip->ifname, ifip->iftype, port_no, macaddr_num, rlen);
@@ -220,83 +512,25 @@ int send_htip_device_link_info(u_char *device_category,
                 link_info_tlv_len = len;
         }
 
-        for (i = 0; i < num; i++) {
-                len = 0;
-                rlen = 0;
-
-                ifip = get_ifinfo_list() + i;
-
-                if (ifip->fd < 0)
-                        continue;
-
-                memset(macaddrs, 0, sizeof(macaddrs));
-                macaddr_num = get_remote_entry_num_by_macaddr(ifip->macaddr, macaddrs);
-
-                if (macaddr_num == 0)
-                        continue;
-
-                if ((payload = malloc(ETH_DATA_LEN)) == NULL) {
-                        perror("malloc");
-                        return -1;
-                }
-
-                memset(payload, 0, ETH_DATA_LEN);
-
-if (srcaddr) {
-                len += create_lldp_tlv(payload, srcaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname));
-} else {
-                len += create_lldp_tlv(payload, ifip->macaddr, ETHER_ADDR_LEN, (u_char *) ifip->ifname, strlen(ifip->ifname));
-}
-
-                if ((rlen = create_basic_htip_device_info_tlv(payload + len,
-                        ifip->macaddr, ETHER_ADDR_LEN,
-                        (u_char *) ifip->ifname, strlen(ifip->ifname),
-                        device_category, device_category_len,
-                        manufacturer_code, model_name, model_name_len,
-                        model_number, model_number_len)) == 0) {
-                        fprintf(stderr, "create_required_htip_device_info_tlv() failed\n");
-                        return -1;
-                }
-
-                len += rlen;
-
-                if ((rlen = create_basic_htip_link_info_tlv(payload + len,
-                        ifip->macaddr, ETHER_ADDR_LEN,
-                        (u_char *) ifip->ifname, strlen(ifip->ifname),
-                        link_info_payload, link_info_tlv_len)) == -1) {
-                        fprintf(stderr, "create_basic_htip_link_info_tlv() failed\n");
-                        return -1;
-                }
-
-                len += rlen;
-                len += create_end_of_lldpdu_tlv(payload + len);
-#ifdef DEBUG
-                printf("  htip frame created: %d bytes using macaddr: %02x:%02x:%02x:%02x:%02x:%02x, ifname: %s.\n",
-                        len, ifip->macaddr[0], ifip->macaddr[1], ifip->macaddr[2], ifip->macaddr[3], ifip->macaddr[4], ifip->macaddr[5], ifip->ifname);
-#endif /* DEBUG */
-
-if (srcaddr) {
-                if ((n = write_frame(ifip->fd, ifip->ifname, dstaddr, srcaddr, payload, len)) < 0) {
-                        fprintf(stderr, "write_frame() failed on ifname: %s.\n", ifip->ifname);
-                        return -1;
+        job.ctx = ctx;
+        job.link_info_payload = link_info_payload;
+        job.link_info_tlv_len = link_info_tlv_len;
+        job.dropped = 0;
+
+        if (ctx->txpool != NULL) {
+                ret = run_txpool(ctx->txpool, num, send_htip_device_link_info_port, &job);
+        } else {
+                for (i = 0; i < num; i++) {
+                        if ((ret = send_htip_device_link_info_port(&job, i, -1)) < 0)
+                                break;
                 }
-} else {
-                if ((n = write_frame(ifip->fd, ifip->ifname, dstaddr, ifip->macaddr, payload, len)) < 0) {
-                        fprintf(stderr, "write_frame() failed on ifname: %s.\n", ifip->ifname);
-                        return -1;
-                }
-}
-
-                if (n != (len + sizeof(struct ether_header)))
-                        fprintf(stderr, "sent bytes: %d != htip frame bytes:%d\n", n, len);
-#ifdef DEBUG
-                fprintf(stderr, "\tsent htip bytes: %d\n", len);
-#endif /* DEBUG */
-
-                free(payload);
         }
 
+        if (job.dropped > 0)
+                fprintf(stderr, "link information of ports was left out of frames %d times for lack of room.\n", job.dropped);
+
+        free(job.link_info_ends);
         free(link_info_payload);
 
-        return 0;
+        return ret;
 }
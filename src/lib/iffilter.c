@@ -0,0 +1,374 @@
+/**
+ * @file   iffilter.c
+ * @brief A library filtering network interfaces to be advertised.
+ *
+ * A source file of a library that compile include and exclude rules of
+ * network interfaces and match interfaces reported by the kernel against them.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include <net/if.h>
+
+#include "iffilter.h"
+
+/**
+ * @brief A name of an operational state.
+ */
+struct iffilter_operstate {
+        /** A name */
+        const char *name;
+        /** An operational state (IF_OPER_*) */
+        int value;
+};
+
+static const struct iffilter_operstate iffilter_operstates[] = {
+        { "unknown", IFFILTER_OPER_UNKNOWN },
+        { "notpresent", IFFILTER_OPER_NOTPRESENT },
+        { "down", IFFILTER_OPER_DOWN },
+        { "lowerlayerdown", IFFILTER_OPER_LOWERLAYERDOWN },
+        { "testing", IFFILTER_OPER_TESTING },
+        { "dormant", IFFILTER_OPER_DORMANT },
+        { "up", IFFILTER_OPER_UP },
+        { NULL, 0 },
+};
+
+/** Exclude rules, checked before include rules */
+static struct iffilter_rule *iffilter_exclude = NULL;
+static int iffilter_exclude_num = 0;
+/** Include rules */
+static struct iffilter_rule *iffilter_include = NULL;
+static int iffilter_include_num = 0;
+
+/**
+ * @brief Compile a "field=value" condition.
+ * @param str A condition string, it's not terminated by '\0' but len.
+ * @param len A length of str.
+ * @param cond A pointer to store the compiled condition.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int compile_iffilter_cond(const char *str, size_t len, struct iffilter_cond *cond)
+{
+        const char *eq;
+        size_t flen, vlen;
+        int i;
+
+        memset(cond, 0, sizeof(*cond));
+
+        if ((eq = memchr(str, '=', len)) == NULL) {
+                fprintf(stderr, "iffilter: '=' is missing: %.*s\n", (int) len, str);
+                return -1;
+        }
+
+        flen = eq - str;
+        vlen = len - flen - 1;
+        if (vlen == 0 || vlen >= IFFILTER_VALUE_LEN) {
+                fprintf(stderr, "iffilter: invalid value length: %.*s\n", (int) len, str);
+                return -1;
+        }
+
+        if (flen == 4 && strncmp(str, "name", flen) == 0)
+                cond->field = IFFILTER_FIELD_NAME;
+        else if (flen == 4 && strncmp(str, "kind", flen) == 0)
+                cond->field = IFFILTER_FIELD_KIND;
+        else if (flen == 6 && strncmp(str, "master", flen) == 0)
+                cond->field = IFFILTER_FIELD_MASTER;
+        else if (flen == 9 && strncmp(str, "operstate", flen) == 0)
+                cond->field = IFFILTER_FIELD_OPERSTATE;
+        else {
+                fprintf(stderr, "iffilter: unknown field: %.*s\n", (int) flen, str);
+                return -1;
+        }
+
+        memcpy(cond->value, eq + 1, vlen);
+        cond->value[vlen] = '\0';
+        cond->len = vlen;
+        cond->match = IFFILTER_MATCH_EXACT;
+
+        switch (cond->field) {
+        case IFFILTER_FIELD_NAME:
+                /* most patterns are "veth*" or "docker*", they don't need fnmatch(3) */
+                if (strpbrk(cond->value, "*?[\\") == NULL)
+                        break;
+                if (cond->value[vlen - 1] == '*' && strpbrk(cond->value, "*?[\\") == cond->value + vlen - 1) {
+                        cond->match = IFFILTER_MATCH_PREFIX;
+                        cond->len = vlen - 1;
+                        cond->value[vlen - 1] = '\0';
+                        break;
+                }
+                cond->match = IFFILTER_MATCH_GLOB;
+                break;
+        case IFFILTER_FIELD_KIND:
+                if (strcmp(cond->value, "none") == 0) {
+                        cond->value[0] = '\0';
+                        cond->len = 0;
+                } else if (vlen >= IFFILTER_KIND_LEN) {
+                        fprintf(stderr, "iffilter: too long kind: %s\n", cond->value);
+                        return -1;
+                }
+                break;
+        case IFFILTER_FIELD_MASTER:
+                if (strcmp(cond->value, "none") == 0) {
+                        cond->value[0] = '\0';
+                        cond->len = 0;
+                } else if (vlen >= IFNAMSIZ) {
+                        fprintf(stderr, "iffilter: too long master: %s\n", cond->value);
+                        return -1;
+                }
+                break;
+        case IFFILTER_FIELD_OPERSTATE:
+                for (i = 0; iffilter_operstates[i].name != NULL; i++) {
+                        if (strcmp(cond->value, iffilter_operstates[i].name) == 0)
+                                break;
+                }
+                if (iffilter_operstates[i].name == NULL) {
+                        fprintf(stderr, "iffilter: unknown operstate: %s\n", cond->value);
+                        return -1;
+                }
+                cond->num = iffilter_operstates[i].value;
+                break;
+        default:
+                break;
+        }
+
+        return 0;
+}
+
+int add_iffilter_rule(const char *spec)
+{
+        struct iffilter_rule rule, **rules, *p;
+        struct iffilter_cond *c;
+        const char *s, *e;
+        int *num, include = 1;
+
+        if (spec == NULL)
+                return -1;
+
+        if (*spec == '+' || *spec == '-') {
+                include = (*spec == '+');
+                spec++;
+        }
+
+        memset(&rule, 0, sizeof(rule));
+        rule.include = include;
+
+        for (s = spec; *s != '\0'; s = (*e == ',') ? e + 1 : e) {
+                e = s + strcspn(s, ",");
+                if (e == s)
+                        continue;
+
+                if ((c = realloc(rule.conds, sizeof(struct iffilter_cond) * (rule.num + 1))) == NULL) {
+                        perror("realloc");
+                        free(rule.conds);
+                        return -1;
+                }
+                rule.conds = c;
+
+                if (compile_iffilter_cond(s, e - s, rule.conds + rule.num) < 0) {
+                        free(rule.conds);
+                        return -1;
+                }
+                rule.num += 1;
+        }
+
+        if (rule.num == 0) {
+                fprintf(stderr, "iffilter: empty rule.\n");
+                return -1;
+        }
+
+        rules = include ? &iffilter_include : &iffilter_exclude;
+        num = include ? &iffilter_include_num : &iffilter_exclude_num;
+
+        if ((p = realloc(*rules, sizeof(struct iffilter_rule) * (*num + 1))) == NULL) {
+                perror("realloc");
+                free(rule.conds);
+                return -1;
+        }
+        *rules = p;
+        (*rules)[*num] = rule;
+        *num += 1;
+
+        return 0;
+}
+
+int get_iffilter_rule_num(void)
+{
+        return iffilter_exclude_num + iffilter_include_num;
+}
+
+/**
+ * @brief Check whether a network interface matches a condition.
+ * @param cond A pointer to a compiled condition.
+ * @param link A pointer to a network interface.
+ * @return If it matches, it returns 1. If not, it returns 0.
+ */
+static int match_iffilter_cond(const struct iffilter_cond *cond, const struct iffilter_link *link)
+{
+        switch (cond->field) {
+        case IFFILTER_FIELD_NAME:
+                switch (cond->match) {
+                case IFFILTER_MATCH_EXACT:
+                        return strcmp(link->ifname, cond->value) == 0;
+                case IFFILTER_MATCH_PREFIX:
+                        return strncmp(link->ifname, cond->value, cond->len) == 0;
+                default:
+                        return fnmatch(cond->value, link->ifname, 0) == 0;
+                }
+        case IFFILTER_FIELD_KIND:
+                return strcmp(link->kind, cond->value) == 0;
+        case IFFILTER_FIELD_MASTER:
+                if (cond->len == 0)
+                        return link->master_ifindex == 0;
+                /* an unresolved master has no slaves */
+                return cond->num != 0 && link->master_ifindex == cond->num;
+        case IFFILTER_FIELD_OPERSTATE:
+                return link->operstate == cond->num;
+        default:
+                return 0;
+        }
+}
+
+/**
+ * @brief Check whether a network interface matches any of rules.
+ * @param rules A pointer to a head of rules.
+ * @param num A number of rules.
+ * @param link A pointer to a network interface.
+ * @return If it matches, it returns 1. If not, it returns 0.
+ */
+static int match_iffilter_rules(const struct iffilter_rule *rules, int num, const struct iffilter_link *link)
+{
+        int i, j;
+
+        for (i = 0; i < num; i++) {
+                for (j = 0; j < rules[i].num; j++) {
+                        if (!match_iffilter_cond(rules[i].conds + j, link))
+                                break;
+                }
+                if (j == rules[i].num)
+                        return 1;
+        }
+
+        return 0;
+}
+
+int match_iffilter(const struct iffilter_link *link)
+{
+        if (match_iffilter_rules(iffilter_exclude, iffilter_exclude_num, link))
+                return -1;
+
+        if (iffilter_include_num > 0 && !match_iffilter_rules(iffilter_include, iffilter_include_num, link))
+                return -1;
+
+        return 0;
+}
+
+/**
+ * @brief Bind master conditions of rules naming a network interface to an interface index.
+ * @param rules A pointer to a head of rules.
+ * @param num A number of rules.
+ * @param ifname A name of network interface.
+ * @param ifindex An interface index.
+ */
+static void learn_iffilter_rules(struct iffilter_rule *rules, int num, const char *ifname, int ifindex)
+{
+        struct iffilter_cond *cond;
+        int i, j;
+
+        for (i = 0; i < num; i++) {
+                for (j = 0; j < rules[i].num; j++) {
+                        cond = rules[i].conds + j;
+                        if (cond->field != IFFILTER_FIELD_MASTER || cond->len == 0)
+                                continue;
+                        if (strcmp(cond->value, ifname) == 0)
+                                cond->num = ifindex;
+                }
+        }
+}
+
+void learn_iffilter_master(const char *ifname, int ifindex)
+{
+        learn_iffilter_rules(iffilter_exclude, iffilter_exclude_num, ifname, ifindex);
+        learn_iffilter_rules(iffilter_include, iffilter_include_num, ifname, ifindex);
+}
+
+/**
+ * @brief Resolve interface indexes of master conditions of rules.
+ * @param rules A pointer to a head of rules.
+ * @param num A number of rules.
+ */
+static void resolve_iffilter_rules(struct iffilter_rule *rules, int num)
+{
+        struct iffilter_cond *cond;
+        int i, j;
+
+        for (i = 0; i < num; i++) {
+                for (j = 0; j < rules[i].num; j++) {
+                        cond = rules[i].conds + j;
+                        if (cond->field == IFFILTER_FIELD_MASTER && cond->len != 0)
+                                cond->num = if_nametoindex(cond->value);
+                }
+        }
+}
+
+void resolve_iffilter_master(void)
+{
+        resolve_iffilter_rules(iffilter_exclude, iffilter_exclude_num);
+        resolve_iffilter_rules(iffilter_include, iffilter_include_num);
+}
+
+void free_iffilter(void)
+{
+        int i;
+
+        for (i = 0; i < iffilter_exclude_num; i++)
+                free(iffilter_exclude[i].conds);
+        for (i = 0; i < iffilter_include_num; i++)
+                free(iffilter_include[i].conds);
+
+        free(iffilter_exclude);
+        free(iffilter_include);
+        iffilter_exclude = NULL;
+        iffilter_include = NULL;
+        iffilter_exclude_num = 0;
+        iffilter_include_num = 0;
+}
+
+/**
+ * @brief Print rules.
+ * @param rules A pointer to a head of rules.
+ * @param num A number of rules.
+ */
+static void print_iffilter_rules(const struct iffilter_rule *rules, int num)
+{
+        static const char *fields[] = { "", "name", "kind", "master", "operstate" };
+        const struct iffilter_cond *cond;
+        int i, j;
+
+        for (i = 0; i < num; i++) {
+                printf("  %c", rules[i].include ? '+' : '-');
+                for (j = 0; j < rules[i].num; j++) {
+                        cond = rules[i].conds + j;
+                        printf("%s%s=%s%s", j ? "," : "", fields[cond->field],
+                                cond->len == 0 && cond->field != IFFILTER_FIELD_OPERSTATE ? "none" : cond->value,
+                                cond->match == IFFILTER_MATCH_PREFIX ? "*" : "");
+                }
+                printf("\n");
+        }
+}
+
+void print_iffilter(void)
+{
+        printf("iffilter: %d rules\n", get_iffilter_rule_num());
+        print_iffilter_rules(iffilter_exclude, iffilter_exclude_num);
+        print_iffilter_rules(iffilter_include, iffilter_include_num);
+}
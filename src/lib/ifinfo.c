@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
@@ -36,85 +37,211 @@
 #include <linux/sockios.h>
 #include <linux/rtnetlink.h>
 #include <linux/if_arp.h>
+#include <linux/if_addr.h>
+#include <poll.h>
 #endif /* __linux__ */
 
 #include "ifinfo.h"
 #include "datalink.h"
+#include "netlink.h"
+#include "iffilter.h"
 
 /* global */
-/** A list of network interface information. */
-struct ifinfo *ifinfo_list = NULL;
-/** A number of network interface information in the list */
-int ifinfo_list_num = IFINFO_LIST_INVALID;
-/** A size of a list of network interface information */
-int ifinfo_list_size = IFINFO_LIST_INVALID;
+/** A default ifinfo table used by functions without a table argument */
+static struct ifinfo_table default_ifinfo_table = {
+        NULL, IFINFO_LIST_INVALID, IFINFO_LIST_INVALID, NULL, NULL, 0
+};
+
+struct ifinfo_table *get_ifinfo_table(void)
+{
+        return &default_ifinfo_table;
+}
 
 struct ifinfo *get_ifinfo_list(void)
 {
-        return ifinfo_list;
+        return default_ifinfo_table.list;
 }
 
 void set_ifinfo_list(void *p)
 {
-        ifinfo_list = (struct ifinfo *) p;
+        default_ifinfo_table.list = (struct ifinfo *) p;
 }
 
 int get_ifinfo_list_num(void)
 {
-        return ifinfo_list_num;
+        return default_ifinfo_table.num;
 }
 
-int set_ifinfo_list_num(int num)
+/**
+ * @brief Set a number of stored ifinfo of a table.
+ * @param t A pointer to ifinfo table.
+ * @param num A number of stored ifinfo.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int set_ifinfo_table_num(struct ifinfo_table *t, int num)
 {
-        if ((num < IFINFO_LIST_INVALID) || (num > IFINFO_LIST_MAX_SIZE)) {
+        if ((num < IFINFO_LIST_INVALID) || (num > t->size)) {
                 fprintf(stderr, "Specified number is invalid(%d).\n", num);
                 return -1;
         }
 
-        ifinfo_list_num = num;
+        t->num = num;
 
         return 0;
 }
 
+int set_ifinfo_list_num(int num)
+{
+        return set_ifinfo_table_num(&default_ifinfo_table, num);
+}
+
 int increment_ifinfo_list_num(void)
 {
-        int num = get_ifinfo_list_num();
-        int size = get_ifinfo_list_size();
+        struct ifinfo_table *t = &default_ifinfo_table;
 
-        if (num >= size) {
+        if (t->num >= t->size) {
                 fprintf(stderr, "network interface list is already full.\n");
                 return -1;
         }
 
-        ifinfo_list_num += 1;
+        t->num += 1;
 
         return 0;
 }
 
 int get_ifinfo_list_size(void)
 {
-        return ifinfo_list_size;
+        return default_ifinfo_table.size;
 }
 
 int set_ifinfo_list_size(int size)
 {
-        if ((size < IFINFO_LIST_INVALID) || (size > IFINFO_LIST_MAX_SIZE)) {
+        if (size < IFINFO_LIST_INVALID) {
                 fprintf(stderr, "Specified size is invalid(%d).\n", size);
                 return -1;
         }
 
-        ifinfo_list_size = size;
+        default_ifinfo_table.size = size;
 
         return 0;
 }
 
-struct ifinfo *search_ifinfo_by_ifname(const char *ifname)
+static u_int32_t hash_ifname(const char *ifname)
+{
+        u_int32_t h = 2166136261U;
+        int i;
+
+        /* FNV-1a */
+        for (i = 0; i < IFNAMSIZ && ifname[i] != '\0'; i++) {
+                h ^= (u_char) ifname[i];
+                h *= 16777619U;
+        }
+
+        return h;
+}
+
+static u_int32_t hash_ifindex(int ifindex)
+{
+        return (u_int32_t) ifindex * 2654435761U;
+}
+
+/**
+ * @brief Insert an entry of ifinfo list to hash tables.
+ * @param t A pointer to ifinfo table.
+ * @param i An index of ifinfo list.
+ */
+static void insert_ifinfo_hash(struct ifinfo_table *t, int i)
+{
+        struct ifinfo *p = t->list + i;
+        u_int32_t mask = t->hash_size - 1, h;
+
+        for (h = hash_ifname(p->ifname) & mask; t->name_hash[h] != 0; h = (h + 1) & mask)
+                ;
+        t->name_hash[h] = i + 1;
+
+        /* an interface index is unknown on some platforms */
+        if (p->ifindex <= 0)
+                return;
+
+        for (h = hash_ifindex(p->ifindex) & mask; t->index_hash[h] != 0; h = (h + 1) & mask)
+                ;
+        t->index_hash[h] = i + 1;
+}
+
+int rebuild_ifinfo_hash_r(struct ifinfo_table *t)
+{
+        int i, size = 16;
+        int *name_hash, *index_hash;
+
+        while (size < t->size * 2)
+                size *= 2;
+
+        if (size != t->hash_size) {
+                if ((name_hash = malloc(sizeof(int) * size)) == NULL) {
+                        perror("malloc");
+                        return -1;
+                }
+                if ((index_hash = malloc(sizeof(int) * size)) == NULL) {
+                        perror("malloc");
+                        free(name_hash);
+                        return -1;
+                }
+                free(t->name_hash);
+                free(t->index_hash);
+                t->name_hash = name_hash;
+                t->index_hash = index_hash;
+                t->hash_size = size;
+        }
+
+        memset(t->name_hash, 0, sizeof(int) * t->hash_size);
+        memset(t->index_hash, 0, sizeof(int) * t->hash_size);
+
+        for (i = 0; i < t->num; i++)
+                insert_ifinfo_hash(t, i);
+
+        return 0;
+}
+
+int rebuild_ifinfo_hash(void)
+{
+        return rebuild_ifinfo_hash_r(&default_ifinfo_table);
+}
+
+int grow_ifinfo_list_r(struct ifinfo_table *t)
 {
         struct ifinfo *p;
-        int i, num = get_ifinfo_list_num();
+        int size = t->size * 2;
 
-        for (i = 0; i < num; i++) {
-                p = get_ifinfo_list() + i;
+        if (size < IFINFO_LIST_INIT_SIZE)
+                size = IFINFO_LIST_INIT_SIZE;
+
+        if ((p = realloc(t->list, IFINFO_LEN * size)) == NULL) {
+                perror("realloc");
+                return -1;
+        }
+
+        memset(p + t->size, 0, IFINFO_LEN * (size - t->size));
+        t->list = p;
+        t->size = size;
+
+        return rebuild_ifinfo_hash_r(t);
+}
+
+int grow_ifinfo_list(void)
+{
+        return grow_ifinfo_list_r(&default_ifinfo_table);
+}
+
+struct ifinfo *search_ifinfo_by_ifname_r(struct ifinfo_table *t, const char *ifname)
+{
+        struct ifinfo *p;
+        u_int32_t mask = t->hash_size - 1, h;
+
+        if (t->name_hash == NULL || t->num <= 0)
+                return NULL;
+
+        for (h = hash_ifname(ifname) & mask; t->name_hash[h] != 0; h = (h + 1) & mask) {
+                p = t->list + t->name_hash[h] - 1;
                 if (strncmp(ifname, p->ifname, IFNAMSIZ) == 0)
                         return p;
         }
@@ -122,48 +249,112 @@ struct ifinfo *search_ifinfo_by_ifname(const char *ifname)
         return NULL;
 }
 
-struct ifinfo *get_empty_ifinfo(void)
+struct ifinfo *search_ifinfo_by_ifname(const char *ifname)
 {
-        struct ifinfo *p = get_ifinfo_list();
-        int num = get_ifinfo_list_num();
-        int size = get_ifinfo_list_size();
+        return search_ifinfo_by_ifname_r(&default_ifinfo_table, ifname);
+}
 
-        if (num >= size) {
-                fprintf(stderr, "ifinfo list is already full.\n");
+struct ifinfo *search_ifinfo_by_ifindex_r(struct ifinfo_table *t, int ifindex)
+{
+        struct ifinfo *p;
+        u_int32_t mask = t->hash_size - 1, h;
+
+        if (t->index_hash == NULL || t->num <= 0 || ifindex <= 0)
                 return NULL;
+
+        for (h = hash_ifindex(ifindex) & mask; t->index_hash[h] != 0; h = (h + 1) & mask) {
+                p = t->list + t->index_hash[h] - 1;
+                if (p->ifindex == ifindex)
+                        return p;
         }
-        return p + num;
+
+        return NULL;
 }
 
-int set_ifinfo_list_ifname(char *ifname)
+struct ifinfo *search_ifinfo_by_ifindex(int ifindex)
+{
+        return search_ifinfo_by_ifindex_r(&default_ifinfo_table, ifindex);
+}
+
+struct ifinfo *get_empty_ifinfo_r(struct ifinfo_table *t)
+{
+        if (t->num < 0) {
+                fprintf(stderr, "ifinfo list is not allocated.\n");
+                return NULL;
+        }
+
+        if (t->num >= t->size && grow_ifinfo_list_r(t) == -1) {
+                fprintf(stderr, "grow_ifinfo_list() failed.\n");
+                return NULL;
+        }
+
+        return t->list + t->num;
+}
+
+struct ifinfo *get_empty_ifinfo(void)
+{
+        return get_empty_ifinfo_r(&default_ifinfo_table);
+}
+
+int set_ifinfo_list_ifname_r(struct ifinfo_table *t, char *ifname)
 {
         struct ifinfo *p;
 
-        if ((p = search_ifinfo_by_ifname(ifname)) != NULL) {
+        if ((p = search_ifinfo_by_ifname_r(t, ifname)) != NULL) {
         	fprintf(stderr, "Specified network interface is already exist: %s\n", ifname);
                 return -1;
         }
 
-        if ((p = get_empty_ifinfo()) == NULL) {
+        if ((p = get_empty_ifinfo_r(t)) == NULL) {
                 fprintf(stderr, "ifinfo_list is full.");
                 return -1;
         }
 
-        if (increment_ifinfo_list_num() == -1) {
-                fprintf(stderr, "increment_ifinfo_list_num() failed.\n");
-                return -1;
-        }
+        t->num += 1;
 
         memcpy(p->ifname, ifname, IFNAMSIZ);
+        insert_ifinfo_hash(t, p - t->list);
 
         return 0;
 }
 
-int set_ifinfo_addr(char *ifname, char *ipaddr, char *netmask)
+int set_ifinfo_list_ifname(char *ifname)
+{
+        return set_ifinfo_list_ifname_r(&default_ifinfo_table, ifname);
+}
+
+struct ifinfo *add_ifinfo_r(struct ifinfo_table *t, const struct ifinfo *ifi)
 {
         struct ifinfo *p;
 
-        if ((p = search_ifinfo_by_ifname(ifname)) == NULL) {
+        if (search_ifinfo_by_ifname_r(t, ifi->ifname) != NULL) {
+                fprintf(stderr, "Specified network interface is already exist: %s\n", ifi->ifname);
+                return NULL;
+        }
+
+        if ((p = get_empty_ifinfo_r(t)) == NULL) {
+                fprintf(stderr, "ifinfo_list is full.\n");
+                return NULL;
+        }
+
+        t->num += 1;
+
+        memcpy(p, ifi, IFINFO_LEN);
+        insert_ifinfo_hash(t, p - t->list);
+
+        return p;
+}
+
+struct ifinfo *add_ifinfo(const struct ifinfo *ifi)
+{
+        return add_ifinfo_r(&default_ifinfo_table, ifi);
+}
+
+int set_ifinfo_addr_r(struct ifinfo_table *t, char *ifname, char *ipaddr, char *netmask)
+{
+        struct ifinfo *p;
+
+        if ((p = search_ifinfo_by_ifname_r(t, ifname)) == NULL) {
                 fprintf(stderr, "matching entry not found for ifname: %s\n", ifname);
                 return -1;
         }
@@ -174,11 +365,16 @@ int set_ifinfo_addr(char *ifname, char *ipaddr, char *netmask)
         return 0;
 }
 
-int set_ifinfo_hwaddr(char *ifname, u_char *macaddr)
+int set_ifinfo_addr(char *ifname, char *ipaddr, char *netmask)
+{
+        return set_ifinfo_addr_r(&default_ifinfo_table, ifname, ipaddr, netmask);
+}
+
+int set_ifinfo_hwaddr_r(struct ifinfo_table *t, char *ifname, u_char *macaddr)
 {
         struct ifinfo *p;
 
-        if ((p = search_ifinfo_by_ifname(ifname)) == NULL) {
+        if ((p = search_ifinfo_by_ifname_r(t, ifname)) == NULL) {
                 fprintf(stderr, "matching entry not found for ifname: %s\n", ifname);
                 return -1;
         }
@@ -189,11 +385,16 @@ int set_ifinfo_hwaddr(char *ifname, u_char *macaddr)
 
 }
 
-int set_ifinfo_iftype(char *ifname, int iftype)
+int set_ifinfo_hwaddr(char *ifname, u_char *macaddr)
+{
+        return set_ifinfo_hwaddr_r(&default_ifinfo_table, ifname, macaddr);
+}
+
+int set_ifinfo_iftype_r(struct ifinfo_table *t, char *ifname, int iftype)
 {
         struct ifinfo *p;
 
-        if ((p = search_ifinfo_by_ifname(ifname)) == NULL) {
+        if ((p = search_ifinfo_by_ifname_r(t, ifname)) == NULL) {
                 fprintf(stderr, "matching entry not found for ifname: %s\n", ifname);
                 return -1;
         }
@@ -203,11 +404,16 @@ int set_ifinfo_iftype(char *ifname, int iftype)
         return 0;
 }
 
-int set_ifinfo_portno(char *ifname, u_int16_t port_no)
+int set_ifinfo_iftype(char *ifname, int iftype)
+{
+        return set_ifinfo_iftype_r(&default_ifinfo_table, ifname, iftype);
+}
+
+int set_ifinfo_portno_r(struct ifinfo_table *t, char *ifname, u_int16_t port_no)
 {
         struct ifinfo *p;
 
-        if ((p = search_ifinfo_by_ifname(ifname)) == NULL) {
+        if ((p = search_ifinfo_by_ifname_r(t, ifname)) == NULL) {
                 fprintf(stderr, "matching entry not found for ifname: %s\n", ifname);
                 return -1;
         }
@@ -217,56 +423,106 @@ int set_ifinfo_portno(char *ifname, u_int16_t port_no)
         return 0;
 }
 
-struct ifinfo *malloc_ifinfo_list(int size)
+int set_ifinfo_portno(char *ifname, u_int16_t port_no)
 {
-        void *p;
-        struct ifinfo *ifip;
-        int i;
+        return set_ifinfo_portno_r(&default_ifinfo_table, ifname, port_no);
+}
 
-        if (set_ifinfo_list_size(size) == -1) {
-                fprintf(stderr, "set_ifinfo_list_size() failed.\n");
-                return NULL;
+/**
+ * @brief Allocate an empty ifinfo list of a table.
+ * @param t A pointer to ifinfo table.
+ * @param size A size of ifinfo list(number of struct ifinfo).
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int init_ifinfo_table(struct ifinfo_table *t, int size)
+{
+        if (size < 0) {
+                fprintf(stderr, "Specified size is invalid(%d).\n", size);
+                return -1;
         }
 
-        if (set_ifinfo_list_num(0) == -1) {
-                fprintf(stderr, "set_ifinfo_list_num() failed.\n");
-                return NULL;
+        if ((t->list = malloc(IFINFO_LEN * size)) == NULL) {
+                perror("malloc");
+                return -1;
         }
 
-        if ((p = malloc(IFINFO_LEN * size)) == NULL) {
-                perror("malloc");
-                return NULL;
+        memset(t->list, 0, IFINFO_LEN * size);
+        t->size = size;
+        t->num = 0;
+
+        if (rebuild_ifinfo_hash_r(t) == -1) {
+                fprintf(stderr, "rebuild_ifinfo_hash() failed.\n");
+                return -1;
         }
 
-        memset(p, 0, IFINFO_LEN * size);
-        set_ifinfo_list(p);
+        return 0;
+}
+
+/**
+ * @brief Free an ifinfo list and hash tables of a table.
+ * @param t A pointer to ifinfo table.
+ */
+static void fini_ifinfo_table(struct ifinfo_table *t)
+{
+        free(t->list);
+        free(t->name_hash);
+        free(t->index_hash);
+        t->list = NULL;
+        t->num = IFINFO_LIST_INVALID;
+        t->size = IFINFO_LIST_INVALID;
+        t->name_hash = NULL;
+        t->index_hash = NULL;
+        t->hash_size = 0;
+}
+
+struct ifinfo *malloc_ifinfo_list(int size)
+{
+        if (init_ifinfo_table(&default_ifinfo_table, size) == -1)
+                return NULL;
 
-        return (struct ifinfo *) p;
+        return default_ifinfo_table.list;
 }
 
 void free_ifinfo_list(void)
 {
-        struct ifinfo *p;
+        fini_ifinfo_table(&default_ifinfo_table);
+}
 
-        if (set_ifinfo_list_size(IFINFO_LIST_INVALID) == -1)
-                fprintf(stderr, "set_ifinfo_list_size() failed.\n");
+struct ifinfo_table *alloc_ifinfo_table(int size)
+{
+        struct ifinfo_table *t;
 
-        if (set_ifinfo_list_num(IFINFO_LIST_INVALID) == -1)
-                fprintf(stderr, "set_ifinfo_list_num() failed.\n");
+        if ((t = malloc(sizeof(struct ifinfo_table))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
 
-        if ((p = get_ifinfo_list()) != NULL) {
-                free(p);
-                set_ifinfo_list(NULL);
+        memset(t, 0, sizeof(struct ifinfo_table));
+        if (init_ifinfo_table(t, size) == -1) {
+                fini_ifinfo_table(t);
+                free(t);
+                return NULL;
         }
+
+        return t;
 }
 
-int open_netif(void)
+void free_ifinfo_table(struct ifinfo_table *t)
+{
+        if (t == NULL || t == &default_ifinfo_table)
+                return;
+
+        fini_ifinfo_table(t);
+        free(t);
+}
+
+int open_netif_r(struct ifinfo_table *t)
 {
         struct ifinfo *p;
-        int i, num = get_ifinfo_list_num();
+        int i;
 
-        for (i = 0; i < num; i++) {
-                p = get_ifinfo_list() + i;
+        for (i = 0; i < t->num; i++) {
+                p = t->list + i;
                 if ((p->fd = set_promiscuous_mode(p->ifname)) < 0) {
                         fprintf(stderr, "set_promiscuous_mode() failed on net ifname: %s\n", p->ifname);
                         // return -1;
@@ -276,36 +532,53 @@ int open_netif(void)
         return 0;
 }
 
-void close_netif(void)
+int open_netif(void)
+{
+        return open_netif_r(&default_ifinfo_table);
+}
+
+void close_netif_r(struct ifinfo_table *t)
 {
-        struct ifinfo *p = get_ifinfo_list();
-        int i = 0, num = get_ifinfo_list_num();
+        struct ifinfo *p;
+        int i;
 
-        for (i = 0; i < num; i++) {
-                p = get_ifinfo_list() + i;
+        for (i = 0; i < t->num; i++) {
+                p = t->list + i;
                 if (p->fd >= 0)
                         if (close(p->fd) < 0)
                                 perror("close");
         }
 
-        free_ifinfo_list();
+        fini_ifinfo_table(t);
 }
 
-void print_ifinfo(void)
+void close_netif(void)
+{
+        close_netif_r(&default_ifinfo_table);
+
+        free_iftype_cache();
+}
+
+void print_ifinfo_r(struct ifinfo_table *t)
 {
         struct ifinfo *p;
-        int i, num = get_ifinfo_list_num();
+        int i;
         char macaddr[MAC_BUF_SIZE];
 
-        printf("  print ifinfo list num: %d, size: %d.\n", get_ifinfo_list_num(), get_ifinfo_list_size());
-        for (i = 0; i < num; i++) {
-                p = get_ifinfo_list() + i;
+        printf("  print ifinfo list num: %d, size: %d.\n", t->num, t->size);
+        for (i = 0; i < t->num; i++) {
+                p = t->list + i;
                 ether_addr_str(p->macaddr, macaddr);
-                printf("   ifname: %s, fd: %d, ip: %s, netmask: %s, mac: %s, type: %d, port: %d\n",
-                        p->ifname, p->fd, p->ipaddr, p->netmask, macaddr, p->iftype, p->port_no);
+                printf("   ifname: %s, index: %d, master: %d, fd: %d, ip: %s, netmask: %s, mac: %s, type: %d, flags: 0x%x, port: %d\n",
+                        p->ifname, p->ifindex, p->master_ifindex, p->fd, p->ipaddr, p->netmask, macaddr, p->iftype, p->ifflags, p->port_no);
         }
 }
 
+void print_ifinfo(void)
+{
+        print_ifinfo_r(&default_ifinfo_table);
+}
+
 u_char *alloc_brifaddr(char *brifname) {
         int i, sock;
         struct ifreq ifr;
@@ -339,112 +612,229 @@ DONE:
 }
 
 #ifdef __linux__
-int read_ifinfo(void)
+/**
+ * @brief Classify a link reported by rtnetlink without opening a socket.
+ * @param link A pointer to a parsed link.
+ * @return An IANAifType value. If the link is not advertised, it returns IANAIFTYPE_OTHER.
+ */
+static u_int32_t get_link_iftype(const struct rtnl_link *link)
 {
-        int i, n, nifs = 0, sock;
-        char ip[INET6_ADDRSTRLEN], netmask[INET6_ADDRSTRLEN];
-        struct ifreq *ifr, ifbuf[IFINFO_LIST_MAX_SIZE];
-        struct sockaddr *addr;
-        struct ifconf ifc;
-        struct ifinfo tmp, *p;
-        struct ifaddrs *ifa, *ifa_list;
-        struct ifreq ifrbuf;
-
-        if ((n = getifaddrs(&ifa_list)) == -1) {
-                perror("getifaddrs");
-                return -1;
+        u_int32_t iftype;
+        int fd;
+
+        if ((iftype = lookup_iftype_cache(link->ifindex, link->ifname)) != 0)
+                return iftype;
+
+        iftype = get_ianaiftype(link->hwtype);
+
+        /* ignore bridge interface */
+        if (strncmp(link->kind, "bridge", RTNL_KIND_LEN) == 0) {
+                iftype = IANAIFTYPE_OTHER;
+        } else if (link->hwtype == HW_ETHER && link->kind[0] == '\0') {
+                /* only a physical ethernet device may be a wireless device */
+                if ((fd = open_sysfs_netif(link->ifname)) >= 0) {
+                        if (is_sysfs_netif_dir(fd, "wireless") || is_sysfs_netif_dir(fd, "phy80211"))
+                                iftype = IANAIFTYPE_IEEE80211;
+                        if (close(fd) < 0)
+                                perror("close");
+                }
         }
 
-        for (ifa = ifa_list; ifa != NULL; ifa = ifa->ifa_next) {
-#ifdef DEBUG
-                printf("  getifaddrs if: %s\n", ifa->ifa_name);
-#endif /* DEBUG */
+        if (store_iftype_cache(link->ifindex, link->ifname, iftype) < 0)
+                fprintf(stderr, "store_iftype_cache() failed on net ifname: %s\n", link->ifname);
 
-                if (is_valid_ifaddr(ifa) < 0)
-                        continue;
+        return iftype;
+}
 
-#ifdef DEBUG
-                printf("  getifaddrs available if: %s\n", ifa->ifa_name);
-#endif /* DEBUG */
-                nifs += 1;
-        }
+/**
+ * @brief A buffer of ifinfo filled by a rtnetlink dump.
+ */
+struct ifinfo_scan {
+        /** A pointer to a head of ifinfo buffer */
+        struct ifinfo *buf;
+        /** A number of stored ifinfo */
+        int num;
+        /** A size of ifinfo buffer */
+        int size;
+};
 
-#ifdef DEBUG
-        printf("  getifaddrs ifs: %d\n", nifs);
-#endif /* DEBUG */
-        n = nifs;
+/**
+ * @brief Convert a link reported by rtnetlink to ifinfo.
+ * @param link A pointer to a parsed link.
+ * @param p A pointer to ifinfo to store the link.
+ * @return If the link is advertised, it returns 0. If not, it returns -1.
+ */
+static int get_link_ifinfo(const struct rtnl_link *link, struct ifinfo *p)
+{
+        struct iffilter_link fl;
+        u_int32_t iftype;
 
-        if ((sock = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
-                perror("socket");
+        if (is_valid_ifname(link->ifname) < 0)
                 return -1;
-        }
 
-        if ((ifinfo_list = malloc_ifinfo_list(IFINFO_LIST_MAX_SIZE)) == NULL) {
-                fprintf(stderr, "malloc_ifinfo_list() failed.\n");
+        /* excluded interfaces cost no syscall */
+        fl.ifname = link->ifname;
+        fl.kind = link->kind;
+        fl.master_ifindex = link->master;
+        fl.operstate = link->operstate;
+        if (match_iffilter(&fl) < 0)
                 return -1;
-        }
-
-        for (ifa = ifa_list; ifa != NULL; ifa = ifa->ifa_next) {
-                if (is_valid_ifaddr(ifa) < 0)
-                        continue;
 
-                memset(&ifrbuf, 0, sizeof(ifrbuf));
-                memset(ip, 0, INET6_ADDRSTRLEN);
-                memset(netmask, 0, INET6_ADDRSTRLEN);
-                strncpy(ifrbuf.ifr_name, ifa->ifa_name, IFNAMSIZ);
-                ifr = &ifrbuf;
-#ifdef DEBUG
-                printf("ifname: %s\n", ifr->ifr_name);
-#endif /* DEBUG */
-                addr = &(ifr->ifr_addr);
+        if ((iftype = get_link_iftype(link)) == IANAIFTYPE_OTHER)
+                return -1;
 
-                if (ioctl(sock, SIOCGIFADDR, ifr) != -1) {
-                        if (inet_ntop(AF_INET, &(((struct sockaddr_in *)addr)->sin_addr), ip, sizeof(ip)) == NULL) {
-                                perror("inet_ntop");
-                        }
+        memset(p, 0, IFINFO_LEN);
+        p->fd = -1;
+        p->ifindex = link->ifindex;
+        p->master_ifindex = link->master;
+        memcpy(p->ifname, link->ifname, IFNAMSIZ);
+        memcpy(p->macaddr, link->macaddr, ETHER_ADDR_LEN);
+        p->iftype = iftype;
+        p->ifflags = link->flags & IFINFO_FLAGS_MASK;
 
-                        addr = &(ifr->ifr_netmask);
+        return 0;
+}
 
-                        if (ioctl(sock, SIOCGIFNETMASK, ifr) == -1) {
-                                perror("ioctl(SIOCGIFNETMASK)");
-                        }
+static int scan_link(const struct nlmsghdr *nh, void *arg)
+{
+        struct ifinfo_scan *scan = (struct ifinfo_scan *) arg;
+        struct rtnl_link link;
+        struct ifinfo *p;
+        int size;
 
-                        if (inet_ntop(AF_INET, &(((struct sockaddr_in *)addr)->sin_addr), netmask, sizeof(netmask)) == NULL) {
-                                perror("inet_ntop");
-                        }
-                } else {
-                        perror("ioctl(SIOCGIFADDR)");
-                }
+        if (rtnl_parse_link(nh, &link) < 0)
+                return 0;
 
-                if (ioctl(sock, SIOCGIFHWADDR, ifr) == -1) {
-                        perror("ioctl(SIOCFIFHWADDR");
-                        continue;;
-                }
+        learn_iffilter_master(link.ifname, link.ifindex);
 
-                if (set_ifinfo_list_ifname(ifr->ifr_name) < 0) {
-                        fprintf(stderr, "set_ifinfo_ifname() failed\n");
-                        return -1;
-                }
-                if (set_ifinfo_hwaddr(ifr->ifr_name, (u_char *) ifr->ifr_hwaddr.sa_data) < 0) {
-                        fprintf(stderr, "set_ifinfo_hwaddr() failed.\n");
+        if (scan->num >= scan->size) {
+                size = scan->size < IFINFO_LIST_INIT_SIZE ? IFINFO_LIST_INIT_SIZE : scan->size * 2;
+                if ((p = realloc(scan->buf, IFINFO_LEN * size)) == NULL) {
+                        perror("realloc");
                         return -1;
                 }
+                scan->buf = p;
+                scan->size = size;
+        }
 
-                if (set_ifinfo_addr(ifr->ifr_name, ip, netmask) < 0) {
-                        fprintf(stderr, "set_ifinfo_addr() failed\n");
-                        return -1;
+        if (get_link_ifinfo(&link, scan->buf + scan->num) == 0)
+                scan->num += 1;
+
+        return 0;
+}
+
+static int compare_ifindex(const void *a, const void *b)
+{
+        return ((const struct ifinfo *) a)->ifindex - ((const struct ifinfo *) b)->ifindex;
+}
+
+static int scan_addr(const struct nlmsghdr *nh, void *arg)
+{
+        struct ifinfo_scan *scan = (struct ifinfo_scan *) arg;
+        struct rtnl_addr addr;
+        struct ifinfo key, *p;
+
+        if (rtnl_parse_addr(nh, &addr) < 0 || addr.family != AF_INET)
+                return 0;
+
+        /* the primary address is reported before secondary ones */
+        if (addr.flags & IFA_F_SECONDARY)
+                return 0;
+
+        key.ifindex = addr.ifindex;
+        if ((p = bsearch(&key, scan->buf, scan->num, IFINFO_LEN, compare_ifindex)) == NULL)
+                return 0;
+
+        if (p->ipaddr[0] == '\0') {
+                memcpy(p->ipaddr, addr.ipaddr, INET6_ADDRSTRLEN);
+                memcpy(p->netmask, addr.netmask, INET6_ADDRSTRLEN);
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Read all advertised network interfaces with a RTM_GETLINK and a RTM_GETADDR dump.
+ * @param bufp A pointer to store an allocated buffer of ifinfo sorted by interface index. The caller frees it.
+ * @return If succeeded, it returns a number of stored ifinfo. If failed, it returns -1.
+ */
+static int scan_netif(struct ifinfo **bufp)
+{
+        struct ifinfo_scan scan = { NULL, 0, 0 };
+        int fd, ret = 0;
+
+        *bufp = NULL;
+
+        /* a master bridge may be dumped after its slaves */
+        resolve_iffilter_master();
+
+        if ((fd = rtnl_open(0)) < 0) {
+                fprintf(stderr, "rtnl_open() failed.\n");
+                return -1;
+        }
+
+        if (rtnl_dump(fd, RTM_GETLINK, AF_UNSPEC, scan_link, &scan) < 0) {
+                fprintf(stderr, "rtnl_dump(RTM_GETLINK) failed.\n");
+                ret = -1;
+        } else {
+                /* addresses are bound to links by a binary search */
+                qsort(scan.buf, scan.num, IFINFO_LEN, compare_ifindex);
+                if (rtnl_dump(fd, RTM_GETADDR, AF_INET, scan_addr, &scan) < 0) {
+                        fprintf(stderr, "rtnl_dump(RTM_GETADDR) failed.\n");
+                        ret = -1;
                 }
         }
 
-        if (close(sock) < 0) {
+        if (close(fd) < 0)
                 perror("close");
+
+        if (ret < 0) {
+                free(scan.buf);
+                return ret;
+        }
+
+        *bufp = scan.buf;
+
+        return scan.num;
+}
+
+int read_ifinfo_r(struct ifinfo_table *t)
+{
+        struct ifinfo *buf;
+        int i, n;
+
+        if ((n = scan_netif(&buf)) < 0) {
+                fprintf(stderr, "scan_netif() failed.\n");
                 return -1;
         }
 
-        freeifaddrs(ifa_list);
+        if (init_ifinfo_table(t, n > IFINFO_LIST_INIT_SIZE ? n : IFINFO_LIST_INIT_SIZE) == -1) {
+                fprintf(stderr, "init_ifinfo_table() failed.\n");
+                free(buf);
+                return -1;
+        }
+
+        for (i = 0; i < n; i++) {
+#ifdef DEBUG
+                printf("  rtnetlink available if: %s\n", buf[i].ifname);
+#endif /* DEBUG */
+                if (add_ifinfo_r(t, buf + i) == NULL) {
+                        fprintf(stderr, "add_ifinfo() failed.\n");
+                        free(buf);
+                        return -1;
+                }
+        }
+
+        free(buf);
+
         return 0;
 }
 
+int read_ifinfo(void)
+{
+        return read_ifinfo_r(&default_ifinfo_table);
+}
+
 int is_valid_netif(const struct ifinfo *p)
 {
         if (is_valid_ifname(p->ifname) < 0)
@@ -462,6 +852,309 @@ int is_valid_netif(const struct ifinfo *p)
 
         return 0;
 }
+
+int refresh_ifinfo_r(struct ifinfo_table *t)
+{
+        struct ifinfo *buf, *p, *q;
+        char *seen;
+        int i, j, n, num, changed = 0, renamed = 0;
+
+        if ((n = scan_netif(&buf)) < 0) {
+                fprintf(stderr, "scan_netif() failed.\n");
+                return -1;
+        }
+
+        /* new interfaces are appended, so the list never exceeds num + n */
+        if ((seen = calloc(t->num + n + 1, 1)) == NULL) {
+                perror("calloc");
+                free(buf);
+                return -1;
+        }
+
+        for (i = 0; i < n; i++) {
+                q = buf + i;
+
+                if ((p = search_ifinfo_by_ifindex_r(t, q->ifindex)) != NULL) {
+                        seen[p - t->list] = 1;
+                        /* keep the opened file descriptor, the FDB port number and the schedule */
+                        q->fd = p->fd;
+                        q->port_no = p->port_no;
+                        q->changed = p->changed;
+                        q->next_tx = p->next_tx;
+                        q->tx_fast = p->tx_fast;
+                        q->tx_interval = p->tx_interval;
+                        if (memcmp(p, q, IFINFO_LEN) != 0) {
+                                if (strncmp(p->ifname, q->ifname, IFNAMSIZ) != 0)
+                                        renamed = 1;
+                                memcpy(p, q, IFINFO_LEN);
+                                p->changed = 1;
+                                changed += 1;
+                        }
+                        continue;
+                }
+
+                /* only a new interface costs a socket */
+                if ((q->fd = set_promiscuous_mode(q->ifname)) < 0)
+                        fprintf(stderr, "set_promiscuous_mode() failed on net ifname: %s\n", q->ifname);
+
+                q->changed = 1;
+                if ((p = add_ifinfo_r(t, q)) == NULL) {
+                        fprintf(stderr, "add_ifinfo() failed: %s\n", q->ifname);
+                        if (q->fd >= 0 && close(q->fd) < 0)
+                                perror("close");
+                        continue;
+                }
+
+                seen[p - t->list] = 1;
+                changed += 1;
+#ifdef DEBUG
+                printf("  refresh_ifinfo added if: %s\n", p->ifname);
+#endif /* DEBUG */
+        }
+
+        /* forget interfaces which disappeared, keep the order of the others */
+        num = t->num;
+        for (i = 0, j = 0; i < num; i++) {
+                p = t->list + i;
+
+                if (!seen[i]) {
+#ifdef DEBUG
+                        printf("  refresh_ifinfo removed if: %s\n", p->ifname);
+#endif /* DEBUG */
+                        if (p->fd >= 0 && close(p->fd) < 0)
+                                perror("close");
+                        invalidate_iftype_cache(p->ifindex);
+                        changed += 1;
+                        continue;
+                }
+
+                if (i != j)
+                        memcpy(t->list + j, p, IFINFO_LEN);
+                j++;
+        }
+
+        free(buf);
+        free(seen);
+
+        if (j != num) {
+                memset(t->list + j, 0, IFINFO_LEN * (num - j));
+                if (set_ifinfo_table_num(t, j) == -1)
+                        return -1;
+        }
+
+        /* compaction moves entries and a rename moves a name slot */
+        if ((j != num || renamed) && rebuild_ifinfo_hash_r(t) < 0)
+                return -1;
+
+        return changed;
+}
+
+int refresh_ifinfo(void)
+{
+        return refresh_ifinfo_r(&default_ifinfo_table);
+}
+
+int remove_ifinfo_by_ifindex_r(struct ifinfo_table *t, int ifindex)
+{
+        struct ifinfo *p;
+        int i, num = t->num;
+
+        if ((p = search_ifinfo_by_ifindex_r(t, ifindex)) == NULL)
+                return -1;
+
+        if (p->fd >= 0 && close(p->fd) < 0)
+                perror("close");
+
+        i = p - t->list;
+        memmove(p, p + 1, IFINFO_LEN * (num - i - 1));
+        memset(t->list + num - 1, 0, IFINFO_LEN);
+
+        if (set_ifinfo_table_num(t, num - 1) == -1)
+                return -1;
+
+        return rebuild_ifinfo_hash_r(t);
+}
+
+int remove_ifinfo_by_ifindex(int ifindex)
+{
+        return remove_ifinfo_by_ifindex_r(&default_ifinfo_table, ifindex);
+}
+
+int open_ifinfo_monitor(void)
+{
+        return rtnl_open(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR);
+}
+
+/**
+ * @brief Apply a RTM_NEWLINK or RTM_DELLINK event to ifinfo list.
+ * @param t A pointer to ifinfo table.
+ * @param nh A pointer to a link message.
+ * @return If ifinfo list is changed, it returns 1. If not, it returns 0.
+ */
+static int handle_link_event(struct ifinfo_table *t, const struct nlmsghdr *nh)
+{
+        struct rtnl_link link;
+        struct ifinfo ifi, *p;
+
+        if (rtnl_parse_link(nh, &link) < 0)
+                return 0;
+
+        learn_iffilter_master(link.ifname, nh->nlmsg_type == RTM_DELLINK ? 0 : link.ifindex);
+
+        /* a deleted ifindex may be reused by another kind of link */
+        if (nh->nlmsg_type == RTM_DELLINK)
+                invalidate_iftype_cache(link.ifindex);
+
+        p = search_ifinfo_by_ifindex_r(t, link.ifindex);
+
+        /* a deleted link, or a link which is no longer advertised */
+        if (nh->nlmsg_type == RTM_DELLINK || get_link_ifinfo(&link, &ifi) < 0) {
+                if (p == NULL)
+                        return 0;
+#ifdef DEBUG
+                printf("  ifinfo monitor removed if: %s\n", p->ifname);
+#endif /* DEBUG */
+                remove_ifinfo_by_ifindex_r(t, link.ifindex);
+                return 1;
+        }
+
+        if (p != NULL) {
+                /* most of RTM_NEWLINK events only report other flags or statistics */
+                if (strncmp(p->ifname, ifi.ifname, IFNAMSIZ) == 0 &&
+                    memcmp(p->macaddr, ifi.macaddr, ETHER_ADDR_LEN) == 0 &&
+                    p->master_ifindex == ifi.master_ifindex &&
+                    p->iftype == ifi.iftype &&
+                    p->ifflags == ifi.ifflags)
+                        return 0;
+
+                memcpy(p->macaddr, ifi.macaddr, ETHER_ADDR_LEN);
+                p->master_ifindex = ifi.master_ifindex;
+                p->iftype = ifi.iftype;
+                p->ifflags = ifi.ifflags;
+                p->changed = 1;
+                if (strncmp(p->ifname, ifi.ifname, IFNAMSIZ) != 0) {
+                        memcpy(p->ifname, ifi.ifname, IFNAMSIZ);
+                        rebuild_ifinfo_hash_r(t);
+                }
+                return 1;
+        }
+
+        if ((ifi.fd = set_promiscuous_mode(ifi.ifname)) < 0)
+                fprintf(stderr, "set_promiscuous_mode() failed on net ifname: %s\n", ifi.ifname);
+
+        ifi.changed = 1;
+        if (add_ifinfo_r(t, &ifi) == NULL) {
+                fprintf(stderr, "add_ifinfo() failed: %s\n", ifi.ifname);
+                if (ifi.fd >= 0 && close(ifi.fd) < 0)
+                        perror("close");
+                return 0;
+        }
+#ifdef DEBUG
+        printf("  ifinfo monitor added if: %s\n", ifi.ifname);
+#endif /* DEBUG */
+
+        return 1;
+}
+
+/**
+ * @brief Apply a RTM_NEWADDR or RTM_DELADDR event to ifinfo list.
+ * @param t A pointer to ifinfo table.
+ * @param nh A pointer to an address message.
+ * @return If ifinfo list is changed, it returns 1. If not, it returns 0.
+ */
+static int handle_addr_event(struct ifinfo_table *t, const struct nlmsghdr *nh)
+{
+        struct rtnl_addr addr;
+        struct ifinfo *p;
+
+        /* Currently IPv4 support */
+        if (rtnl_parse_addr(nh, &addr) < 0 || addr.family != AF_INET)
+                return 0;
+
+        if (addr.flags & IFA_F_SECONDARY)
+                return 0;
+
+        if ((p = search_ifinfo_by_ifindex_r(t, addr.ifindex)) == NULL)
+                return 0;
+
+        if (nh->nlmsg_type == RTM_DELADDR) {
+                if (strncmp(p->ipaddr, addr.ipaddr, INET6_ADDRSTRLEN) != 0)
+                        return 0;
+                memset(p->ipaddr, 0, INET6_ADDRSTRLEN);
+                memset(p->netmask, 0, INET6_ADDRSTRLEN);
+        } else {
+                if (strncmp(p->ipaddr, addr.ipaddr, INET6_ADDRSTRLEN) == 0 &&
+                    strncmp(p->netmask, addr.netmask, INET6_ADDRSTRLEN) == 0)
+                        return 0;
+                memcpy(p->ipaddr, addr.ipaddr, INET6_ADDRSTRLEN);
+                memcpy(p->netmask, addr.netmask, INET6_ADDRSTRLEN);
+        }
+
+        p->changed = 1;
+
+        return 1;
+}
+
+int handle_ifinfo_monitor_r(struct ifinfo_table *t, int fd)
+{
+        char buf[RTNL_BUF_SIZE];
+        struct nlmsghdr *nh;
+        int n, changed = 0;
+
+        for (;;) {
+                if ((n = rtnl_recv(fd, buf, sizeof(buf))) < 0) {
+                        /* events were lost, read all interfaces again */
+                        if (errno == ENOBUFS)
+                                return refresh_ifinfo_r(t);
+                        return -1;
+                }
+
+                if (n == 0)
+                        break;
+
+                for (nh = (struct nlmsghdr *) buf; NLMSG_OK(nh, n); nh = NLMSG_NEXT(nh, n)) {
+                        switch (nh->nlmsg_type) {
+                        case RTM_NEWLINK:
+                        case RTM_DELLINK:
+                                changed += handle_link_event(t, nh);
+                                break;
+                        case RTM_NEWADDR:
+                        case RTM_DELADDR:
+                                changed += handle_addr_event(t, nh);
+                                break;
+                        default:
+                                break;
+                        }
+                }
+        }
+
+        return changed;
+}
+
+int handle_ifinfo_monitor(int fd)
+{
+        return handle_ifinfo_monitor_r(&default_ifinfo_table, fd);
+}
+
+int wait_ifinfo_monitor(int fd, int timeout)
+{
+        struct pollfd pfd;
+        int n;
+
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        /* poll() ignores a negative fd and just sleeps */
+        if ((n = poll(&pfd, 1, timeout)) < 0) {
+                if (errno == EINTR)
+                        return 0;
+                perror("poll");
+                return -1;
+        }
+
+        return (n > 0 && (pfd.revents & POLLIN)) ? 1 : 0;
+}
 #endif /* __linux__ */
 
 int is_valid_ifname(const char *p)
@@ -474,6 +1167,26 @@ int is_valid_ifname(const char *p)
         return 0;
 }
 
+#ifdef __APPLE__
+/**
+ * @brief Check whether a specified ifaddrs passes the interface filter.
+ * @param ifa A pointer to struct ifaddrs
+ * @return If it passes, it returns 0. If not, it returns -1.
+ */
+static int is_filtered_ifaddr(struct ifaddrs *ifa)
+{
+        struct iffilter_link fl;
+
+        /* getifaddrs() doesn't report a link kind nor a master */
+        fl.ifname = ifa->ifa_name;
+        fl.kind = "";
+        fl.master_ifindex = 0;
+        fl.operstate = (ifa->ifa_flags & IFF_RUNNING) ? IFFILTER_OPER_UP : IFFILTER_OPER_DOWN;
+
+        return match_iffilter(&fl);
+}
+#endif /* __APPLE__ */
+
 int is_valid_ifaddr(struct ifaddrs *ifa)
 {
         int i;
@@ -485,6 +1198,11 @@ int is_valid_ifaddr(struct ifaddrs *ifa)
         if (is_valid_ifname(ifa->ifa_name) == -1)
                 return -1;
 
+#ifdef __APPLE__
+        if (is_filtered_ifaddr(ifa) < 0)
+                return -1;
+#endif /* __APPLE__ */
+
         /* Currently IPv4 support */
 #ifdef DEBUG
          fprintf(stderr, "    is_valid_ifaddr family: %x\n", ifa->ifa_addr->sa_family);
@@ -497,31 +1215,39 @@ int is_valid_ifaddr(struct ifaddrs *ifa)
 #endif /* __APPLE__ */
                 return -1;
 
+#ifdef __linux__
+        if (get_iftype_ifindex(ifa->ifa_name, ((struct sockaddr_ll *) ifa->ifa_addr)->sll_ifindex) == IANAIFTYPE_OTHER)
+#else
         if (get_iftype(ifa->ifa_name) == IANAIFTYPE_OTHER)
+#endif /* __linux__ */
                 return -1;
 
         return 0;
 }
 
-int read_net_type(void)
+int read_net_type_r(struct ifinfo_table *t)
 {
         struct ifreq ifr;
 #ifdef __linux__
         struct ethtool_cmd cmd;
 #endif /* __linux__ */
         struct ifinfo *p;
-        int sock, i, num = get_ifinfo_list_num();
+        int sock, i, num = t->num;
         u_int32_t dlt;
 
         for (i = 0; i < num; i++) {
-                p = get_ifinfo_list() + i;
+                p = t->list + i;
+
+                /* already classified when the list was read */
+                if (p->iftype != 0)
+                        continue;
 
-                if ((dlt = get_iftype(p->ifname)) == HW_INVALID) {
+                if ((dlt = get_iftype_ifindex(p->ifname, p->ifindex)) == HW_INVALID) {
                         fprintf(stderr, "get_iftype() failed.\n");
                         return -1;
                 }
 
-                if (set_ifinfo_iftype(p->ifname, dlt) == -1) {
+                if (set_ifinfo_iftype_r(t, p->ifname, dlt) == -1) {
                         fprintf(stderr, "set_ifinfo_iftype() failed.\n");
                         return -1;
                 }
@@ -530,6 +1256,11 @@ int read_net_type(void)
         return 0;
 }
 
+int read_net_type(void)
+{
+        return read_net_type_r(&default_ifinfo_table);
+}
+
 #ifdef __APPLE__
 void print_netif(void)
 {
@@ -591,7 +1322,7 @@ void print_netif(void)
         }
 }
 
-int read_ifinfo(void)
+int read_ifinfo_r(struct ifinfo_table *t)
 {
         struct ifinfo *p;
         struct ifaddrs *ifa_list, *ifa;
@@ -607,7 +1338,7 @@ int read_ifinfo(void)
         
         n = num_netif(ifa_list);
 
-        if ((ifinfo_list = malloc_ifinfo_list(n)) == NULL) {
+        if (init_ifinfo_table(t, n) == -1) {
                 fprintf(stderr, "mallocifinfo() failed.\n");
                 freeifaddrs(ifa_list);
                 return -1;
@@ -616,12 +1347,12 @@ int read_ifinfo(void)
         for (ifa = ifa_list; ifa != NULL; ifa = ifa->ifa_next) {
                 dl = (struct sockaddr_dl *) ifa->ifa_addr;
                 if (is_available_ifaddr(ifa) == 0) {
-                        if (set_ifinfo_list_ifname(ifa->ifa_name) < 0) {
+                        if (set_ifinfo_list_ifname_r(t, ifa->ifa_name) < 0) {
                                 fprintf(stderr, "set_ifinfo_ifname() failed\n");
                                 return -1;
                         }
                         dl_addr = (unsigned char *) LLADDR(dl);
-                        if (set_ifinfo_hwaddr(ifa->ifa_name, dl_addr) < 0) {
+                        if (set_ifinfo_hwaddr_r(t, ifa->ifa_name, dl_addr) < 0) {
                                 fprintf(stderr, "set_ifinfo_hwaddr() failed.\n");
                                 return -1;
                         }
@@ -629,7 +1360,7 @@ int read_ifinfo(void)
         }
 
         for (ifa = ifa_list; ifa != NULL; ifa = ifa->ifa_next) {
-                if (search_ifinfo_by_ifname(ifa->ifa_name) == NULL)
+                if (search_ifinfo_by_ifname_r(t, ifa->ifa_name) == NULL)
                         continue;
                 memset(addr, 0, sizeof(addr));
                 memset(netmask, 0, sizeof(netmask));
@@ -645,7 +1376,7 @@ int read_ifinfo(void)
                                 perror("inet_ntop");
                                 return -1;
                         }
-                        if (set_ifinfo_addr(ifa->ifa_name, addr, netmask) < 0) {
+                        if (set_ifinfo_addr_r(t, ifa->ifa_name, addr, netmask) < 0) {
                                 fprintf(stderr, "set_ifinfo_addr() failed\n");
                                 return -1;
                         }
@@ -660,6 +1391,11 @@ int read_ifinfo(void)
         return 0;
 }
 
+int read_ifinfo(void)
+{
+        return read_ifinfo_r(&default_ifinfo_table);
+}
+
 int num_netif(struct ifaddrs *ifa_list)
 {
         struct ifaddrs *ifa;
@@ -679,6 +1415,8 @@ int is_available_ifaddr(struct ifaddrs *ifa)
         struct sockaddr_dl *dl = (struct sockaddr_dl *) ifa->ifa_addr;
 
         if (dl->sdl_family == AF_LINK && dl->sdl_type == IFT_ETHER) {
+                if (is_filtered_ifaddr(ifa) < 0)
+                        return -1;
                 /* check interface is up and support broadcast */
                 if (((ifa->ifa_flags & IFF_UP) != IFF_UP) || ((ifa->ifa_flags & IFF_BROADCAST) != IFF_BROADCAST))
                         return -1;
@@ -0,0 +1,175 @@
+/**
+ * @file   intern.c
+ * @brief A library interning immutable strings.
+ *
+ * A source file of a library that keep one reference counted copy of each
+ * distinct string, so strings repeated by many objects, like a model name of
+ * thousands of devices, take memory once.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "intern.h"
+#include "slab.h"
+
+/**
+ * @brief Get a hash of a string by FNV-1a.
+ */
+static u_int32_t hash_intern_string(const u_char *data, u_int len)
+{
+        u_int32_t h = 2166136261u;
+        u_int i;
+
+        for (i = 0; i < len; i++)
+                h = (h ^ data[i]) * 16777619u;
+
+        return h;
+}
+
+int init_intern_table(struct intern_table *t)
+{
+        memset(t, 0, sizeof(struct intern_table));
+
+        if ((t->table = calloc(INTERN_TABLE_INIT_SIZE, sizeof(struct intern_string *))) == NULL) {
+                perror("calloc");
+                return -1;
+        }
+        t->size = INTERN_TABLE_INIT_SIZE;
+        init_slab_classes(&t->slabs);
+
+        return 0;
+}
+
+void destroy_intern_table(struct intern_table *t)
+{
+        /* strings are in pages of the slabs */
+        destroy_slab_classes(&t->slabs);
+        free(t->table);
+        t->table = NULL;
+        t->size = 0;
+        t->num = 0;
+}
+
+int match_intern_string(const struct intern_string *s, const u_char *data, u_int len)
+{
+        return s != NULL && s->len == len && memcmp(s->data, data, len) == 0;
+}
+
+/**
+ * @brief Get a slot of a string or an empty slot to insert it.
+ */
+static u_int32_t get_intern_slot(struct intern_table *t, u_int32_t h, const u_char *data, u_int len)
+{
+        struct intern_string *s;
+        u_int32_t i, mask = t->size - 1;
+
+        for (i = h & mask; (s = t->table[i]) != NULL; i = (i + 1) & mask)
+                if (s->hash == h && match_intern_string(s, data, len))
+                        break;
+
+        return i;
+}
+
+/**
+ * @brief Double a hash table and rehash all strings.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int grow_intern_table(struct intern_table *t)
+{
+        struct intern_string **table;
+        u_int32_t h, mask = t->size * 2 - 1;
+        int i;
+
+        if ((table = calloc(t->size * 2, sizeof(struct intern_string *))) == NULL) {
+                perror("calloc");
+                return -1;
+        }
+
+        for (i = 0; i < t->size; i++) {
+                if (t->table[i] == NULL)
+                        continue;
+                for (h = t->table[i]->hash & mask; table[h] != NULL; h = (h + 1) & mask)
+                        ;
+                table[h] = t->table[i];
+        }
+
+        free(t->table);
+        t->table = table;
+        t->size *= 2;
+
+        return 0;
+}
+
+const struct intern_string *intern_string(struct intern_table *t, const u_char *data, u_int len)
+{
+        struct intern_string *s;
+        u_int32_t h, i;
+
+        h = hash_intern_string(data, len);
+        i = get_intern_slot(t, h, data, len);
+
+        if ((s = t->table[i]) != NULL) {
+                s->refcnt += 1;
+                return s;
+        }
+
+        /* keep the load factor under 1/2 */
+        if ((t->num + 1) * 2 > t->size) {
+                if (grow_intern_table(t) < 0)
+                        return NULL;
+                i = get_intern_slot(t, h, data, len);
+        }
+
+        if ((s = alloc_slab_size(&t->slabs, sizeof(struct intern_string) + len)) == NULL)
+                return NULL;
+        s->hash = h;
+        s->refcnt = 1;
+        s->len = len;
+        memcpy(s->data, data, len);
+
+        t->table[i] = s;
+        t->num += 1;
+
+        return s;
+}
+
+void release_intern_string(struct intern_table *t, const struct intern_string *s)
+{
+        struct intern_string *p;
+        u_int32_t i, j, k, mask = t->size - 1;
+
+        if (s == NULL || --((struct intern_string *) s)->refcnt > 0)
+                return;
+
+        for (i = s->hash & mask; t->table[i] != s; i = (i + 1) & mask)
+                ;
+
+        /* shift following strings back instead of leaving a tombstone */
+        for (j = (i + 1) & mask; (p = t->table[j]) != NULL; j = (j + 1) & mask) {
+                k = p->hash & mask;
+                if (((j - k) & mask) >= ((j - i) & mask)) {
+                        t->table[i] = p;
+                        i = j;
+                }
+        }
+        t->table[i] = NULL;
+        t->num -= 1;
+
+        free_slab_size(&t->slabs, (void *) s, sizeof(struct intern_string) + s->len);
+}
+
+size_t get_intern_table_bytes(const struct intern_table *t)
+{
+        return get_slab_classes_bytes(&t->slabs) + (size_t) t->size * sizeof(struct intern_string *);
+}
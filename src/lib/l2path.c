@@ -0,0 +1,300 @@
+/**
+ * @file   l2path.c
+ * @brief A library answering path queries over an estimated layer 2 topology.
+ *
+ * A source file of a library that index a tree of a topology by an Euler tour
+ * and a sparse table, so the lowest common ancestor of two nodes is found in
+ * constant time and a path between them in time linear in its length. The
+ * index is built again only when the topology changes.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "l2path.h"
+#include "topology.h"
+
+struct l2path *alloc_l2path(struct topology *t)
+{
+        struct l2path *p;
+
+        if ((p = malloc(sizeof(struct l2path))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        memset(p, 0, sizeof(struct l2path));
+        p->topology = t;
+
+        return p;
+}
+
+/**
+ * @brief Free arrays of an index.
+ */
+static void clear_l2path(struct l2path *p)
+{
+        free(p->parent);
+        free(p->parent_port);
+        free(p->uplink);
+        free(p->depth);
+        free(p->first);
+        free(p->child);
+        free(p->sibling);
+        free(p->tour);
+        free(p->sparse);
+}
+
+void free_l2path(struct l2path *p)
+{
+        if (p == NULL)
+                return;
+
+        clear_l2path(p);
+        free(p);
+}
+
+/**
+ * @brief Allocate arrays of an index for a number of nodes with the virtual root.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int grow_l2path(struct l2path *p, int num)
+{
+        int size, levels;
+
+        if (num <= p->node_size)
+                return 0;
+
+        for (size = p->node_size ? p->node_size : TOPOLOGY_INIT_SIZE; size < num; size *= 2)
+                ;
+        /* a tour visits a node once, and its parent again after it */
+        for (levels = 1; (1 << levels) <= size * 2; levels++)
+                ;
+
+        clear_l2path(p);
+        memset(&p->parent, 0, sizeof(struct l2path) - offsetof(struct l2path, parent));
+        p->node_size = 0;
+        p->built = 0;
+
+        if ((p->parent = malloc(size * sizeof(int))) == NULL ||
+            (p->parent_port = malloc(size * sizeof(int))) == NULL ||
+            (p->uplink = malloc(size * sizeof(int))) == NULL ||
+            (p->depth = malloc(size * sizeof(int))) == NULL ||
+            (p->first = malloc(size * sizeof(int))) == NULL ||
+            (p->child = malloc(size * sizeof(int))) == NULL ||
+            (p->sibling = malloc(size * sizeof(int))) == NULL ||
+            (p->tour = malloc(size * 2 * sizeof(int))) == NULL ||
+            (p->sparse = malloc((size_t) levels * size * 2 * sizeof(int))) == NULL) {
+                perror("malloc");
+                return -1;
+        }
+        p->node_size = size;
+
+        return 0;
+}
+
+/**
+ * @brief Get a shallower node of two.
+ */
+static inline int get_l2path_shallower(const struct l2path *p, int a, int b)
+{
+        return p->depth[a] <= p->depth[b] ? a : b;
+}
+
+/**
+ * @brief Build an index from links of a refreshed topology.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int build_l2path(struct l2path *p)
+{
+        const struct topology *t = p->topology;
+        const struct topology_edge *e;
+        int *s;
+        int i, j, k, n, v, x, c;
+
+        if (grow_l2path(p, t->node_num + 1) < 0)
+                return -1;
+
+        n = p->node_num = t->node_num;
+        v = n;
+
+        for (i = 0; i <= n; i++) {
+                p->parent[i] = v;
+                p->parent_port[i] = -1;
+                p->uplink[i] = -1;
+                p->first[i] = -1;
+                p->child[i] = -1;
+        }
+        p->parent[v] = -1;
+
+        /* the first end of a link is toward the root, a node linked twice by stale entries hangs from the last */
+        for (i = 0; i < t->edge_num; i++) {
+                e = t->edges + i;
+                p->parent[e->node2] = e->node1;
+                p->parent_port[e->node2] = e->port1;
+                p->uplink[e->node2] = e->port2;
+        }
+        for (i = n - 1; i >= 0; i--) {
+                p->sibling[i] = p->child[p->parent[i]];
+                p->child[p->parent[i]] = i;
+        }
+
+        /*
+         * walk down by children and back by siblings and parents, without a stack;
+         * nodes in a cycle of inconsistent links aren't reached, and stay unconnected
+         */
+        k = 0;
+        x = v;
+        p->depth[v] = 0;
+        p->first[v] = k;
+        p->tour[k++] = v;
+        c = p->child[v];
+        for (;;) {
+                if (c >= 0) {
+                        p->depth[c] = p->depth[x] + 1;
+                        p->first[c] = k;
+                        p->tour[k++] = c;
+                        x = c;
+                        c = p->child[c];
+                } else {
+                        if (x == v)
+                                break;
+                        c = p->sibling[x];
+                        x = p->parent[x];
+                        p->tour[k++] = x;
+                }
+        }
+        p->tour_num = k;
+
+        /* a level k keeps a shallowest node of positions from i to i + 2^k - 1 */
+        memcpy(p->sparse, p->tour, k * sizeof(int));
+        for (j = 1, s = p->sparse; (1 << j) <= k; j++, s += k)
+                for (i = 0; i + (1 << j) <= k; i++)
+                        s[k + i] = get_l2path_shallower(p, s[i], s[i + (1 << (j - 1))]);
+        p->levels = j;
+
+        return 0;
+}
+
+int refresh_l2path(struct l2path *p)
+{
+        if (refresh_topology(p->topology) < 0)
+                return -1;
+
+        if (p->built && p->generation == p->topology->generation)
+                return 0;
+
+        p->built = 0;
+        if (build_l2path(p) < 0) {
+                fprintf(stderr, "build_l2path() failed.\n");
+                return -1;
+        }
+        p->generation = p->topology->generation;
+        p->built = 1;
+
+        return 0;
+}
+
+int find_l2path_ancestor(struct l2path *p, int a, int b)
+{
+        const int *s;
+        int l, r, k, x;
+
+        if (a < 0 || a >= p->node_num || b < 0 || b >= p->node_num ||
+            (l = p->first[a]) < 0 || (r = p->first[b]) < 0)
+                return -1;
+
+        if (l > r) {
+                k = l;
+                l = r;
+                r = k;
+        }
+
+        /* two ranges of a level cover positions from l to r */
+        k = 31 - __builtin_clz(r - l + 1);
+        s = p->sparse + (size_t) k * p->tour_num;
+        x = get_l2path_shallower(p, s[l], s[r - (1 << k) + 1]);
+
+        return x == p->node_num ? -1 : x;
+}
+
+int get_l2path(struct l2path *p, int a, int b, struct l2path_hop *hops, int max)
+{
+        int i, x, port, lca, num, in;
+
+        if ((lca = find_l2path_ancestor(p, a, b)) < 0)
+                return -1;
+
+        num = p->depth[a] + p->depth[b] - 2 * p->depth[lca] + 1;
+
+        /* up from a, entering by a port a child hangs from and leaving by the uplink */
+        for (i = 0, x = a, port = -1; x != lca; i++, x = p->parent[x]) {
+                if (i < max) {
+                        hops[i].node = x;
+                        hops[i].in_port = port;
+                        hops[i].out_port = p->uplink[x];
+                }
+                port = p->parent_port[x];
+        }
+        in = port;
+
+        /* up from b, filling hops backward */
+        for (i = num - 1, x = b, port = -1; x != lca; i--, x = p->parent[x]) {
+                if (i < max) {
+                        hops[i].node = x;
+                        hops[i].in_port = p->uplink[x];
+                        hops[i].out_port = port;
+                }
+                port = p->parent_port[x];
+        }
+
+        if (i < max) {
+                hops[i].node = lca;
+                hops[i].in_port = in;
+                hops[i].out_port = port;
+        }
+
+        return num;
+}
+
+int get_l2path_by_macaddr(struct l2path *p, const u_int8_t a[], const u_int8_t b[],
+        struct l2path_hop *hops, int max)
+{
+        int x, y;
+
+        if (refresh_l2path(p) < 0)
+                return -1;
+
+        if ((x = find_topology_node(p->topology, a)) < 0 || (y = find_topology_node(p->topology, b)) < 0)
+                return -1;
+
+        return get_l2path(p, x, y, hops, max);
+}
+
+void print_l2path(struct l2path *p, const struct l2path_hop *hops, int num)
+{
+        struct topology *t = p->topology;
+        int i;
+
+        printf("path: %d hops\n", num);
+
+        for (i = 0; i < num; i++) {
+                printf("  ");
+                print_topology_node(t, hops[i].node, -1);
+                if (hops[i].in_port >= 0)
+                        printf(", in: port %u", t->ports[hops[i].in_port].port_no);
+                if (hops[i].out_port >= 0)
+                        printf(", out: port %u", t->ports[hops[i].out_port].port_no);
+                printf("\n");
+        }
+}
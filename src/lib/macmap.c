@@ -0,0 +1,414 @@
+/**
+ * @file   macmap.c
+ * @brief A library of a hash map keyed by MAC addresses.
+ *
+ * A source file of a library that map 64-bit keys, like a MAC address packed
+ * by get_fdb_key(), to indexes by an open addressing hash table probed by
+ * groups of slots. A table is changed by one writer, and read by other threads
+ * at the same time if they register as readers.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define MACMAP_GROUP_X86
+#include <emmintrin.h>
+#endif
+
+#include "macmap.h"
+
+/** A control byte of an empty slot */
+#define MACMAP_CTRL_EMPTY 0x80
+/** A control byte of a deleted slot */
+#define MACMAP_CTRL_DELETED 0xFE
+/** A size of a cache line, readers are kept apart */
+#define MACMAP_CACHE_LINE 64
+
+/**
+ * @brief A slot of a table.
+ */
+struct macmap_slot {
+        /** A key */
+        u_int64_t key;
+        /** A value */
+        int value;
+};
+
+/**
+ * @brief A table of a map, control bytes followed by slots.
+ */
+struct macmap_table {
+        /** A number of groups minus 1 */
+        u_int32_t group_mask;
+        /** A number of slots */
+        int size;
+        /** An epoch the table was replaced at */
+        u_int64_t epoch;
+        /** A next replaced table */
+        struct macmap_table *next;
+        /** Slots */
+        struct macmap_slot *slots;
+        /** Control bytes, MACMAP_GROUP_SIZE per group */
+        u_int8_t ctrl[];
+};
+
+/**
+ * @brief A reader of a map.
+ */
+struct macmap_reader {
+        /** An epoch the reader entered at, 0 if it's not in the map */
+        u_int64_t epoch;
+        /** 1 if the reader is registered */
+        int used;
+        char pad[MACMAP_CACHE_LINE - sizeof(u_int64_t) - sizeof(int)];
+};
+
+/**
+ * @brief Get a hash of a key by a finalizer of MurmurHash3.
+ *
+ * A product alone leaves low bits blind to high bits of a key, like a port
+ * number above a MAC address, so the bits are folded both ways.
+ */
+static inline u_int64_t hash_macmap(u_int64_t key)
+{
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDULL;
+        key ^= key >> 33;
+        key *= 0xC4CEB9FE1A85EC53ULL;
+        key ^= key >> 33;
+
+        return key;
+}
+
+/**
+ * @brief Get a control byte of a hash, its 7 highest bits.
+ */
+static inline u_int8_t get_macmap_h2(u_int64_t h)
+{
+        return (u_int8_t) (h >> 57);
+}
+
+/**
+ * @brief Get a first group of a hash.
+ */
+static inline u_int32_t get_macmap_group(const struct macmap_table *t, u_int64_t h)
+{
+        return (u_int32_t) (h >> 25) & t->group_mask;
+}
+
+/**
+ * @brief Match control bytes of a group with a byte.
+ * @return A mask with a bit per matched slot.
+ */
+static inline u_int32_t match_macmap_group(const u_int8_t *ctrl, u_int8_t c)
+{
+#ifdef MACMAP_GROUP_X86
+        return (u_int32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) ctrl),
+                _mm_set1_epi8((char) c)));
+#else
+        u_int32_t m = 0;
+        int i;
+
+        for (i = 0; i < MACMAP_GROUP_SIZE; i++)
+                if (__atomic_load_n(ctrl + i, __ATOMIC_RELAXED) == c)
+                        m |= 1U << i;
+
+        return m;
+#endif /* MACMAP_GROUP_X86 */
+}
+
+/**
+ * @brief Allocate an empty table.
+ * @param size A number of slots, a power of two not less than MACMAP_GROUP_SIZE.
+ * @return If succeeded, it returns an allocated table. If failed, it returns NULL.
+ */
+static struct macmap_table *alloc_macmap_table(int size)
+{
+        struct macmap_table *t;
+
+        if ((t = malloc(sizeof(struct macmap_table) + size + sizeof(struct macmap_slot) * size)) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        t->group_mask = size / MACMAP_GROUP_SIZE - 1;
+        t->size = size;
+        t->epoch = 0;
+        t->next = NULL;
+        /* ctrl is a multiple of the group size, so slots are aligned */
+        t->slots = (struct macmap_slot *) (t->ctrl + size);
+        memset(t->ctrl, MACMAP_CTRL_EMPTY, size);
+
+        return t;
+}
+
+int init_macmap(struct macmap *m, int readers)
+{
+        memset(m, 0, sizeof(struct macmap));
+
+        if (readers < 0 || readers > MACMAP_MAX_READERS) {
+                fprintf(stderr, "Invalid number of readers: %d\n", readers);
+                return -1;
+        }
+
+        if (readers > 0) {
+                if ((m->readers = calloc(readers, sizeof(struct macmap_reader))) == NULL) {
+                        perror("calloc");
+                        return -1;
+                }
+                m->reader_num = readers;
+        }
+
+        if ((m->table = alloc_macmap_table(MACMAP_GROUP_SIZE)) == NULL) {
+                free(m->readers);
+                m->readers = NULL;
+                return -1;
+        }
+        m->epoch = 1;
+
+        return 0;
+}
+
+void destroy_macmap(struct macmap *m)
+{
+        struct macmap_table *t;
+
+        while ((t = m->retired) != NULL) {
+                m->retired = t->next;
+                free(t);
+        }
+
+        free(m->table);
+        free(m->readers);
+        memset(m, 0, sizeof(struct macmap));
+}
+
+int is_macmap_initialized(const struct macmap *m)
+{
+        return m->table != NULL;
+}
+
+/**
+ * @brief Find a slot of a key in a table.
+ * @return If found, it returns an index of the slot. If not, it returns -1.
+ */
+static int find_macmap_slot(const struct macmap_table *t, u_int64_t key)
+{
+        const u_int64_t h = hash_macmap(key);
+        const u_int8_t h2 = get_macmap_h2(h);
+        const u_int8_t *ctrl;
+        u_int32_t g, i, m;
+        int j;
+
+        /* triangular probing visits every group once */
+        for (g = get_macmap_group(t, h), i = 1; i <= t->group_mask + 1; g = (g + i++) & t->group_mask) {
+                ctrl = t->ctrl + (size_t) g * MACMAP_GROUP_SIZE;
+                m = match_macmap_group(ctrl, h2);
+                /* keys are stored before their control bytes, x86 keeps the order of a vector load */
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                for (; m != 0; m &= m - 1) {
+                        j = g * MACMAP_GROUP_SIZE + __builtin_ctz(m);
+                        if (t->slots[j].key == key)
+                                return j;
+                }
+                if (match_macmap_group(ctrl, MACMAP_CTRL_EMPTY) != 0)
+                        break;
+        }
+
+        return -1;
+}
+
+int find_macmap(const struct macmap *m, u_int64_t key)
+{
+        const struct macmap_table *t = __atomic_load_n(&m->table, __ATOMIC_ACQUIRE);
+        int i;
+
+        if (t == NULL || (i = find_macmap_slot(t, key)) < 0)
+                return -1;
+
+        return __atomic_load_n(&t->slots[i].value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Store a key to an empty slot of a table, the key must not be in it.
+ */
+static void store_macmap_slot(struct macmap_table *t, u_int64_t key, int value)
+{
+        const u_int64_t h = hash_macmap(key);
+        u_int32_t g, i, m;
+        int j;
+
+        for (g = get_macmap_group(t, h), i = 1; ; g = (g + i++) & t->group_mask) {
+                if ((m = match_macmap_group(t->ctrl + (size_t) g * MACMAP_GROUP_SIZE, MACMAP_CTRL_EMPTY)) != 0)
+                        break;
+        }
+
+        j = g * MACMAP_GROUP_SIZE + __builtin_ctz(m);
+        t->slots[j].key = key;
+        t->slots[j].value = value;
+        __atomic_store_n(&t->ctrl[j], get_macmap_h2(h), __ATOMIC_RELEASE);
+}
+
+int reclaim_macmap(struct macmap *m)
+{
+        struct macmap_table **p, *t;
+        u_int64_t e, min = __atomic_load_n(&m->epoch, __ATOMIC_SEQ_CST);
+        int i, num = 0;
+
+        for (i = 0; i < m->reader_num; i++)
+                if ((e = __atomic_load_n(&m->readers[i].epoch, __ATOMIC_SEQ_CST)) != 0 && e < min)
+                        min = e;
+
+        /* a reader entered after a table was replaced can't see it */
+        for (p = &m->retired; (t = *p) != NULL; ) {
+                if (t->epoch < min) {
+                        *p = t->next;
+                        free(t);
+                } else {
+                        p = &t->next;
+                        num += 1;
+                }
+        }
+
+        return num;
+}
+
+/**
+ * @brief Replace a table of a map, the old one is freed after readers leave it.
+ */
+static void replace_macmap_table(struct macmap *m, struct macmap_table *t)
+{
+        struct macmap_table *old = m->table;
+
+        __atomic_store_n(&m->table, t, __ATOMIC_SEQ_CST);
+
+        if (m->reader_num == 0) {
+                free(old);
+                return;
+        }
+
+        old->epoch = m->epoch;
+        old->next = m->retired;
+        m->retired = old;
+        __atomic_store_n(&m->epoch, m->epoch + 1, __ATOMIC_SEQ_CST);
+
+        reclaim_macmap(m);
+}
+
+/**
+ * @brief Rehash keys to a new table, large enough for a key more, without deleted slots.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int rehash_macmap(struct macmap *m)
+{
+        struct macmap_table *t, *old = m->table;
+        int i, size = old->size;
+
+        /* a rehashed table is at most half full */
+        while ((m->num + 1) * 2 > size)
+                size *= 2;
+
+        if ((t = alloc_macmap_table(size)) == NULL)
+                return -1;
+
+        for (i = 0; i < old->size; i++)
+                if (old->ctrl[i] < MACMAP_CTRL_EMPTY)
+                        store_macmap_slot(t, old->slots[i].key, old->slots[i].value);
+
+        replace_macmap_table(m, t);
+        m->used = m->num;
+
+        return 0;
+}
+
+int add_macmap(struct macmap *m, u_int64_t key, int value)
+{
+        if (find_macmap_slot(m->table, key) >= 0)
+                return 1;
+
+        /* deleted slots count, they're only reused by a rehash */
+        if ((m->used + 1) * 8 > m->table->size * 7 && rehash_macmap(m) < 0)
+                return -1;
+
+        store_macmap_slot(m->table, key, value);
+        m->num += 1;
+        m->used += 1;
+
+        return 0;
+}
+
+int remove_macmap(struct macmap *m, u_int64_t key)
+{
+        int i;
+
+        if ((i = find_macmap_slot(m->table, key)) < 0)
+                return -1;
+
+        __atomic_store_n(&m->table->ctrl[i], MACMAP_CTRL_DELETED, __ATOMIC_RELEASE);
+        m->num -= 1;
+
+        return 0;
+}
+
+int clear_macmap(struct macmap *m)
+{
+        struct macmap_table *t;
+
+        if (m->reader_num == 0) {
+                memset(m->table->ctrl, MACMAP_CTRL_EMPTY, m->table->size);
+        } else {
+                if ((t = alloc_macmap_table(m->table->size)) == NULL)
+                        return -1;
+                replace_macmap_table(m, t);
+        }
+
+        m->num = 0;
+        m->used = 0;
+
+        return 0;
+}
+
+int register_macmap_reader(struct macmap *m)
+{
+        int i, unused;
+
+        for (i = 0; i < m->reader_num; i++) {
+                unused = 0;
+                if (__atomic_compare_exchange_n(&m->readers[i].used, &unused, 1, 0,
+                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+                        return i;
+        }
+
+        return -1;
+}
+
+void unregister_macmap_reader(struct macmap *m, int reader)
+{
+        __atomic_store_n(&m->readers[reader].used, 0, __ATOMIC_RELEASE);
+}
+
+void enter_macmap(struct macmap *m, int reader)
+{
+        u_int64_t e;
+
+        /* the epoch is published before the table is loaded */
+        do {
+                e = __atomic_load_n(&m->epoch, __ATOMIC_SEQ_CST);
+                __atomic_store_n(&m->readers[reader].epoch, e, __ATOMIC_SEQ_CST);
+        } while (__atomic_load_n(&m->epoch, __ATOMIC_SEQ_CST) != e);
+}
+
+void leave_macmap(struct macmap *m, int reader)
+{
+        __atomic_store_n(&m->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,634 @@
+/**
+ * @file   neighbor.c
+ * @brief A library of a neighbor database collected from HTIP frames.
+ *
+ * A source file of a library that keep HTIP devices by chassis ID and port ID
+ * with their device information and link information until their TTL expire.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "binary.h"
+#include "datalink.h"
+#include "intern.h"
+#include "neighbor.h"
+#include "slab.h"
+#include "timer.h"
+#include "tlv.h"
+
+/**
+ * @brief Get a hash of chassis ID and port ID.
+ */
+static u_int32_t hash_neighbor(const u_char *chassis_id, u_int chassis_id_len,
+        const u_char *port_id, u_int port_id_len)
+{
+        u_int32_t h = 2166136261u;
+        u_int i;
+
+        /* FNV-1a, the length keeps a boundary of two IDs */
+        for (i = 0; i < chassis_id_len; i++)
+                h = (h ^ chassis_id[i]) * 16777619u;
+        h = (h ^ chassis_id_len) * 16777619u;
+        for (i = 0; i < port_id_len; i++)
+                h = (h ^ port_id[i]) * 16777619u;
+
+        return h;
+}
+
+/**
+ * @brief Check whether a neighbor has specified chassis ID and port ID.
+ */
+static int match_neighbor(const struct neighbor *n, u_int32_t h, const u_char *chassis_id,
+        u_int chassis_id_len, const u_char *port_id, u_int port_id_len)
+{
+        return n->hash == h && match_intern_string(n->chassis_id, chassis_id, chassis_id_len) &&
+                match_intern_string(n->port_id, port_id, port_id_len);
+}
+
+/**
+ * @brief Free MAC addresses of a set.
+ */
+static void free_neighbor_macset(struct neighbor_db *db, struct neighbor_macset *set)
+{
+        free_slab_size(&db->arrays, set->macaddrs, (size_t) set->macaddr_size * ETHER_ADDR_LEN);
+}
+
+/**
+ * @brief Free a neighbor, its links and its strings.
+ */
+static void free_neighbor(struct neighbor_db *db, struct neighbor *n)
+{
+        int i;
+
+        for (i = 0; i < n->link_num; i++)
+                free_neighbor_macset(db, &n->links[i].macset);
+        free_slab_size(&db->arrays, n->links, n->link_size * sizeof(struct neighbor_link));
+        free_neighbor_macset(db, &n->mac_list);
+
+        release_intern_string(&db->strings, n->chassis_id);
+        release_intern_string(&db->strings, n->port_id);
+        release_intern_string(&db->strings, n->device_category);
+        release_intern_string(&db->strings, n->manufacturer_code);
+        release_intern_string(&db->strings, n->model_name);
+        release_intern_string(&db->strings, n->model_number);
+
+        free_slab_object(&db->neighbors, n);
+}
+
+struct neighbor_db *alloc_neighbor_db(void)
+{
+        struct neighbor_db *db;
+
+        if ((db = malloc(sizeof(struct neighbor_db))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        memset(db, 0, sizeof(struct neighbor_db));
+
+        if ((db->table = calloc(NEIGHBOR_DB_INIT_SIZE, sizeof(struct neighbor *))) == NULL) {
+                perror("calloc");
+                free(db);
+                return NULL;
+        }
+        db->size = NEIGHBOR_DB_INIT_SIZE;
+        init_timer_wheel(&db->wheel, NEIGHBOR_TIMER_RESOLUTION);
+
+        if (init_intern_table(&db->strings) < 0) {
+                free(db->table);
+                free(db);
+                return NULL;
+        }
+        init_slab(&db->neighbors, sizeof(struct neighbor));
+        init_slab_classes(&db->arrays);
+
+        return db;
+}
+
+void free_neighbor_db(struct neighbor_db *db)
+{
+        int i;
+
+        if (db == NULL)
+                return;
+
+        for (i = 0; i < db->size; i++)
+                if (db->table[i] != NULL)
+                        free_neighbor(db, db->table[i]);
+
+        destroy_slab_classes(&db->arrays);
+        destroy_slab(&db->neighbors);
+        destroy_intern_table(&db->strings);
+        free(db->table);
+        free(db);
+}
+
+int get_neighbor_num(struct neighbor_db *db)
+{
+        return db->num;
+}
+
+size_t get_neighbor_db_bytes(struct neighbor_db *db)
+{
+        return sizeof(struct neighbor_db) + (size_t) db->size * sizeof(struct neighbor *) +
+                get_slab_bytes(&db->neighbors) + get_slab_classes_bytes(&db->arrays) +
+                get_intern_table_bytes(&db->strings);
+}
+
+/**
+ * @brief Get a slot of a neighbor or an empty slot to insert it.
+ */
+static u_int32_t get_neighbor_slot(struct neighbor_db *db, u_int32_t h, const u_char *chassis_id,
+        u_int chassis_id_len, const u_char *port_id, u_int port_id_len)
+{
+        struct neighbor *n;
+        u_int32_t i, mask = db->size - 1;
+
+        for (i = h & mask; (n = db->table[i]) != NULL; i = (i + 1) & mask)
+                if (match_neighbor(n, h, chassis_id, chassis_id_len, port_id, port_id_len))
+                        break;
+
+        return i;
+}
+
+struct neighbor *find_neighbor(struct neighbor_db *db, const u_char *chassis_id, u_int chassis_id_len,
+        const u_char *port_id, u_int port_id_len)
+{
+        u_int32_t h = hash_neighbor(chassis_id, chassis_id_len, port_id, port_id_len);
+
+        return db->table[get_neighbor_slot(db, h, chassis_id, chassis_id_len, port_id, port_id_len)];
+}
+
+/**
+ * @brief Double a neighbor hash table and rehash all neighbors.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int grow_neighbor_db(struct neighbor_db *db)
+{
+        struct neighbor **table;
+        u_int32_t h, mask = db->size * 2 - 1;
+        int i;
+
+        if ((table = calloc(db->size * 2, sizeof(struct neighbor *))) == NULL) {
+                perror("calloc");
+                return -1;
+        }
+
+        for (i = 0; i < db->size; i++) {
+                if (db->table[i] == NULL)
+                        continue;
+                for (h = db->table[i]->hash & mask; table[h] != NULL; h = (h + 1) & mask)
+                        ;
+                table[h] = db->table[i];
+        }
+
+        free(db->table);
+        db->table = table;
+        db->size *= 2;
+
+        return 0;
+}
+
+/**
+ * @brief Remove a neighbor in a slot.
+ */
+static void remove_neighbor_slot(struct neighbor_db *db, u_int32_t h)
+{
+        struct neighbor *n;
+        u_int32_t i, j, k, mask = db->size - 1;
+
+        if (db->hook.removed != NULL)
+                db->hook.removed(db->hook.arg, db->table[h]);
+        db->generation += 1;
+
+        del_timer(&db->wheel, &db->table[h]->timer);
+
+        free_neighbor(db, db->table[h]);
+
+        /* shift following neighbors back instead of leaving a tombstone */
+        for (i = h, j = (h + 1) & mask; (n = db->table[j]) != NULL; j = (j + 1) & mask) {
+                k = n->hash & mask;
+                if (((j - k) & mask) >= ((j - i) & mask)) {
+                        db->table[i] = n;
+                        i = j;
+                }
+        }
+        db->table[i] = NULL;
+        db->num -= 1;
+}
+
+/**
+ * @brief Set a timer of a neighbor to the earliest expiring time of it, its links and its MAC address list.
+ */
+static void schedule_neighbor(struct neighbor_db *db, struct neighbor *n, u_int64_t now)
+{
+        u_int64_t expire = n->expire;
+        int j;
+
+        for (j = 0; j < n->link_num; j++)
+                if (n->links[j].macset.expire < expire)
+                        expire = n->links[j].macset.expire;
+        if (n->mac_list.macaddr_num > 0 && n->mac_list.expire < expire)
+                expire = n->mac_list.expire;
+
+        add_timer(&db->wheel, &n->timer, expire, now);
+}
+
+/**
+ * @brief Replace or append MAC addresses of a set.
+ *
+ * The first fragment of a frame replaces the set, and following fragments of
+ * the same frame are appended to it.
+ */
+static int update_neighbor_macset(struct neighbor_db *db, struct neighbor_macset *set, u_int64_t frame,
+        u_int64_t expire, const u_int8_t *macaddrs, int macaddr_num)
+{
+        u_int8_t *p;
+        int i, j, size;
+        u_int32_t h;
+
+        if (set->frame != frame) {
+                set->frame = frame;
+                set->prev_num = set->macaddr_num;
+                set->prev_digest = set->digest;
+                set->macaddr_num = 0;
+                set->digest = 0;
+        }
+        set->expire = expire;
+
+        if (macaddr_num > NEIGHBOR_MAX_MACADDR_NUM - set->macaddr_num)
+                macaddr_num = NEIGHBOR_MAX_MACADDR_NUM - set->macaddr_num;
+        if (macaddr_num <= 0)
+                return 0;
+
+        if (set->macaddr_num + macaddr_num > set->macaddr_size) {
+                /* fill the class of a slab */
+                size = get_slab_class_size((size_t) (set->macaddr_num + macaddr_num) * ETHER_ADDR_LEN) / ETHER_ADDR_LEN;
+                if ((p = alloc_slab_size(&db->arrays, (size_t) size * ETHER_ADDR_LEN)) == NULL)
+                        return -1;
+                if (set->macaddr_num > 0)
+                        memcpy(p, set->macaddrs, (size_t) set->macaddr_num * ETHER_ADDR_LEN);
+                free_neighbor_macset(db, set);
+                set->macaddrs = p;
+                set->macaddr_size = size;
+        }
+
+        memcpy(set->macaddrs + (size_t) set->macaddr_num * ETHER_ADDR_LEN, macaddrs,
+                (size_t) macaddr_num * ETHER_ADDR_LEN);
+        set->macaddr_num += macaddr_num;
+
+        /* a sum of hashes doesn't depend on the order of FDB entries */
+        for (i = 0; i < macaddr_num; i++) {
+                h = 2166136261u;
+                for (j = 0; j < ETHER_ADDR_LEN; j++)
+                        h = (h ^ macaddrs[i * ETHER_ADDR_LEN + j]) * 16777619u;
+                set->digest += h;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Check whether a set changed by the current frame.
+ * @return If changed, it returns 1. If not, it returns 0.
+ */
+static int is_neighbor_macset_changed(struct neighbor_macset *set, u_int64_t frame)
+{
+        if (set->frame != frame || (set->macaddr_num == set->prev_num && set->digest == set->prev_digest))
+                return 0;
+
+        set->changed = frame;
+
+        return 1;
+}
+
+/**
+ * @brief Get a link of a neighbor, a new link is added if not found.
+ * @return If succeeded, it returns a pointer to the link. If failed, it returns NULL.
+ */
+static struct neighbor_link *get_neighbor_link(struct neighbor_db *db, struct neighbor *n, u_int16_t port_no)
+{
+        struct neighbor_link *p;
+        int i, size;
+
+        for (i = 0; i < n->link_num; i++)
+                if (n->links[i].port_no == port_no)
+                        return n->links + i;
+
+        if (n->link_num >= NEIGHBOR_MAX_LINK_NUM)
+                return NULL;
+
+        if (n->link_num == n->link_size) {
+                size = n->link_size ? n->link_size * 2 : 1;
+                if ((p = alloc_slab_size(&db->arrays, size * sizeof(struct neighbor_link))) == NULL)
+                        return NULL;
+                if (n->link_num > 0)
+                        memcpy(p, n->links, n->link_num * sizeof(struct neighbor_link));
+                free_slab_size(&db->arrays, n->links, n->link_size * sizeof(struct neighbor_link));
+                n->links = p;
+                n->link_size = size;
+        }
+
+        p = n->links + n->link_num;
+        memset(p, 0, sizeof(struct neighbor_link));
+        p->port_no = port_no;
+        n->link_num += 1;
+
+        return p;
+}
+
+/**
+ * @brief Replace a device information by an interned string if it's in a frame.
+ * @return If changed, it returns NEIGHBOR_DEVICE_CHANGED. If not, it returns 0. If failed, it returns -1.
+ */
+static int copy_neighbor_device_info(struct neighbor_db *db, const struct intern_string **dst, u_int max,
+        const u_char *src, u_int src_len)
+{
+        const struct intern_string *s;
+
+        if (src == NULL)
+                return 0;
+
+        if (src_len > max)
+                src_len = max;
+        if (match_intern_string(*dst, src, src_len))
+                return 0;
+
+        if ((s = intern_string(&db->strings, src, src_len)) == NULL)
+                return -1;
+        release_intern_string(&db->strings, *dst);
+        *dst = s;
+
+        return NEIGHBOR_DEVICE_CHANGED;
+}
+
+void set_neighbor_hook(struct neighbor_db *db, const struct neighbor_hook *hook)
+{
+        if (hook != NULL)
+                db->hook = *hook;
+        else
+                memset(&db->hook, 0, sizeof(struct neighbor_hook));
+}
+
+int update_neighbor(struct neighbor_db *db, const struct htip_lldpdu *du, u_int32_t crc, u_int64_t now)
+{
+        struct neighbor *n;
+        struct neighbor_link *link;
+        const struct htip_link_info *info;
+        u_int32_t h, i;
+        int j, link_num, changed, flags = 0, failed = 0;
+
+        h = hash_neighbor(du->chassis_id, du->chassis_id_len, du->port_id, du->port_id_len);
+        i = get_neighbor_slot(db, h, du->chassis_id, du->chassis_id_len, du->port_id, du->port_id_len);
+
+        /* TTL 0 is a shutdown of the agent */
+        if (du->ttl == 0) {
+                if (db->table[i] != NULL)
+                        remove_neighbor_slot(db, i);
+                return 0;
+        }
+
+        if ((n = db->table[i]) == NULL) {
+                /* keep the load factor under 1/2 */
+                if ((db->num + 1) * 2 > db->size) {
+                        if (grow_neighbor_db(db) < 0)
+                                return -1;
+                        i = get_neighbor_slot(db, h, du->chassis_id, du->chassis_id_len,
+                                du->port_id, du->port_id_len);
+                }
+
+                if ((n = alloc_slab_object(&db->neighbors)) == NULL)
+                        return -1;
+                memset(n, 0, sizeof(struct neighbor));
+                n->hash = h;
+                /* ports of a device share its chassis ID */
+                if ((n->chassis_id = intern_string(&db->strings, du->chassis_id, du->chassis_id_len)) == NULL ||
+                    (n->port_id = intern_string(&db->strings, du->port_id, du->port_id_len)) == NULL) {
+                        release_intern_string(&db->strings, n->chassis_id);
+                        free_slab_object(&db->neighbors, n);
+                        return -1;
+                }
+
+                db->table[i] = n;
+                db->num += 1;
+                flags |= NEIGHBOR_ADDED;
+        }
+
+        db->frame += 1;
+        n->ttl = du->ttl;
+        n->interval = du->interval;
+        /* a partly applied frame is never refreshed by its CRC, it's decoded again */
+        n->crc = 0;
+        n->expire = now + (u_int64_t) du->ttl * 1000;
+        /* an earlier time than needed, so the neighbor expires even if the update fails */
+        schedule_neighbor(db, n, now);
+
+        if ((changed = copy_neighbor_device_info(db, &n->device_category, NEIGHBOR_DEVICE_CATEGORY_LEN,
+                du->device_category, du->device_category_len)) < 0)
+                return -1;
+        flags |= changed;
+        if ((changed = copy_neighbor_device_info(db, &n->manufacturer_code, NEIGHBOR_MANUFACTURER_CODE_LEN,
+                du->manufacturer_code, du->manufacturer_code_len)) < 0)
+                return -1;
+        flags |= changed;
+        if ((changed = copy_neighbor_device_info(db, &n->model_name, NEIGHBOR_MODEL_NAME_LEN,
+                du->model_name, du->model_name_len)) < 0)
+                return -1;
+        flags |= changed;
+        if ((changed = copy_neighbor_device_info(db, &n->model_number, NEIGHBOR_MODEL_NUMBER_LEN,
+                du->model_number, du->model_number_len)) < 0)
+                return -1;
+        flags |= changed;
+
+        for (j = 0; j < du->link_info_num; j++) {
+                info = du->link_info + j;
+                link_num = n->link_num;
+                /* a link not stored is skipped, so changes of the others are still reported */
+                if ((link = get_neighbor_link(db, n, info->port_no)) == NULL) {
+                        failed = 1;
+                        continue;
+                }
+                if (n->link_num != link_num)
+                        flags |= NEIGHBOR_LINK_ADDED;
+                link->iftype = info->iftype;
+                if (update_neighbor_macset(db, &link->macset, db->frame, n->expire,
+                        info->macaddrs, info->macaddr_num) < 0)
+                        failed = 1;
+        }
+
+        /* compared after all fragments of the frame */
+        for (j = 0; j < n->link_num; j++)
+                if (is_neighbor_macset_changed(&n->links[j].macset, db->frame))
+                        flags |= NEIGHBOR_LINK_CHANGED;
+
+        for (j = 0; j < du->mac_address_list_num; j++) {
+                if (update_neighbor_macset(db, &n->mac_list, db->frame, n->expire,
+                        du->mac_address_list[j].macaddrs, du->mac_address_list[j].macaddr_num) < 0)
+                        failed = 1;
+        }
+        if (is_neighbor_macset_changed(&n->mac_list, db->frame))
+                flags |= NEIGHBOR_MAC_LIST_CHANGED;
+
+        if (!failed)
+                n->crc = crc;
+        schedule_neighbor(db, n, now);
+
+        if (flags != 0) {
+                db->generation += 1;
+                if (db->hook.updated != NULL)
+                        db->hook.updated(db->hook.arg, n, flags);
+        }
+
+        return failed ? -1 : flags;
+}
+
+int refresh_neighbor(struct neighbor_db *db, const u_char *chassis_id, u_int chassis_id_len,
+        const u_char *port_id, u_int port_id_len, u_int16_t ttl, u_int32_t crc, u_int64_t now)
+{
+        struct neighbor *n;
+        u_int64_t expire;
+        int j;
+
+        if (ttl == 0 || (n = find_neighbor(db, chassis_id, chassis_id_len, port_id, port_id_len)) == NULL)
+                return -1;
+
+        /* the neighbor was updated by another frame since, it's decoded again */
+        if (n->crc == 0 || n->crc != crc)
+                return -1;
+
+        /* links and a MAC address list in the last frame expire with the neighbor */
+        expire = now + (u_int64_t) ttl * 1000;
+        for (j = 0; j < n->link_num; j++)
+                if (n->links[j].macset.expire == n->expire)
+                        n->links[j].macset.expire = expire;
+        if (n->mac_list.expire == n->expire)
+                n->mac_list.expire = expire;
+        n->expire = expire;
+        schedule_neighbor(db, n, now);
+
+        return 0;
+}
+
+/**
+ * @brief A state of expire_neighbor() passed to expire_neighbor_timer().
+ */
+struct neighbor_expiry {
+        /** A neighbor database */
+        struct neighbor_db *db;
+        /** A current time */
+        u_int64_t now;
+        /** A number of removed neighbors */
+        int num;
+};
+
+/**
+ * @brief Expire a neighbor, its links or its MAC address list by its timer.
+ */
+static void expire_neighbor_timer(struct timer_node *t, void *arg)
+{
+        struct neighbor_expiry *x = arg;
+        struct neighbor *n = (struct neighbor *) ((char *) t - offsetof(struct neighbor, timer));
+        int j, flags = 0;
+
+        if (n->expire <= x->now) {
+                remove_neighbor_slot(x->db, get_neighbor_slot(x->db, n->hash, n->chassis_id->data,
+                        n->chassis_id->len, n->port_id->data, n->port_id->len));
+                x->num += 1;
+                return;
+        }
+
+        /* a port not in recent frames is gone */
+        for (j = 0; j < n->link_num; ) {
+                if (n->links[j].macset.expire > x->now) {
+                        j++;
+                        continue;
+                }
+                free_neighbor_macset(x->db, &n->links[j].macset);
+                n->links[j] = n->links[--n->link_num];
+                flags |= NEIGHBOR_LINK_REMOVED;
+        }
+
+        if (n->mac_list.expire <= x->now && n->mac_list.macaddr_num > 0) {
+                n->mac_list.macaddr_num = 0;
+                n->mac_list.digest = 0;
+                flags |= NEIGHBOR_MAC_LIST_CHANGED;
+        }
+
+        schedule_neighbor(x->db, n, x->now);
+
+        if (flags != 0) {
+                x->db->generation += 1;
+                if (x->db->hook.updated != NULL)
+                        x->db->hook.updated(x->db->hook.arg, n, flags);
+        }
+}
+
+int expire_neighbor(struct neighbor_db *db, u_int64_t now)
+{
+        struct neighbor_expiry x;
+
+        x.db = db;
+        x.now = now;
+        x.num = 0;
+        run_timer_wheel(&db->wheel, now, expire_neighbor_timer, &x);
+
+        return x.num;
+}
+
+void print_neighbor(const struct neighbor *n, u_int64_t now)
+{
+        char maddr[MAC_BUF_SIZE];
+        int i, j;
+
+        printf("chassis ID: ");
+        print_hexlstr((char *) n->chassis_id->data, n->chassis_id->len);
+        printf(", port ID: ");
+        print_hexlstr((char *) n->port_id->data, n->port_id->len);
+        printf(", ttl: %u, interval: %u, expire in: %llu ms\n", n->ttl, n->interval,
+                (unsigned long long) (n->expire > now ? n->expire - now : 0));
+        printf("  device category: %.*s, manufacturer code: %.*s, model name: %.*s, model number: %.*s\n",
+                INTERN_STRING_ARG(n->device_category), INTERN_STRING_ARG(n->manufacturer_code),
+                INTERN_STRING_ARG(n->model_name), INTERN_STRING_ARG(n->model_number));
+
+        for (i = 0; i < n->link_num; i++) {
+                printf("  port no: %u, iftype: %u, mac num: %d, mac:", n->links[i].port_no,
+                        n->links[i].iftype, n->links[i].macset.macaddr_num);
+                for (j = 0; j < n->links[i].macset.macaddr_num; j++) {
+                        ether_addr_str(n->links[i].macset.macaddrs + ETHER_ADDR_LEN * j, maddr);
+                        printf(" %s", maddr);
+                }
+                printf("\n");
+        }
+
+        if (n->mac_list.macaddr_num > 0) {
+                printf("  mac list num: %d, mac:", n->mac_list.macaddr_num);
+                for (j = 0; j < n->mac_list.macaddr_num; j++) {
+                        ether_addr_str(n->mac_list.macaddrs + ETHER_ADDR_LEN * j, maddr);
+                        printf(" %s", maddr);
+                }
+                printf("\n");
+        }
+}
+
+void print_neighbor_db(struct neighbor_db *db, u_int64_t now)
+{
+        int i;
+
+        printf("neighbors: %d\n", db->num);
+
+        for (i = 0; i < db->size; i++)
+                if (db->table[i] != NULL)
+                        print_neighbor(db->table[i], now);
+}
@@ -0,0 +1,271 @@
+/**
+ * @file   netlink.c
+ * @brief A library handling rtnetlink messages.
+ *
+ * A source file of a library that read network interface information
+ * from the kernel through rtnetlink.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#ifdef __linux__
+#include <linux/if_link.h>
+#include <linux/if_addr.h>
+#endif /* __linux__ */
+
+#include "netlink.h"
+
+#ifdef __linux__
+int rtnl_open(u_int32_t groups)
+{
+        int fd;
+        struct sockaddr_nl snl;
+
+        if ((fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | (groups ? SOCK_NONBLOCK : 0), NETLINK_ROUTE)) < 0) {
+                perror("socket(AF_NETLINK)");
+                return -1;
+        }
+
+        memset(&snl, 0, sizeof(snl));
+        snl.nl_family = AF_NETLINK;
+        snl.nl_groups = groups;
+
+        if (bind(fd, (struct sockaddr *) &snl, sizeof(snl)) < 0) {
+                perror("bind(AF_NETLINK)");
+                close(fd);
+                return -1;
+        }
+
+        return fd;
+}
+
+int rtnl_dump_request(int fd, u_int16_t type, u_char family, u_int32_t seq)
+{
+        struct {
+                struct nlmsghdr nh;
+                struct rtgenmsg g;
+        } req;
+        struct sockaddr_nl snl;
+
+        memset(&snl, 0, sizeof(snl));
+        snl.nl_family = AF_NETLINK;
+
+        memset(&req, 0, sizeof(req));
+        req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg));
+        req.nh.nlmsg_type = type;
+        req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        req.nh.nlmsg_seq = seq;
+        req.g.rtgen_family = family;
+
+        if (sendto(fd, &req, req.nh.nlmsg_len, 0, (struct sockaddr *) &snl, sizeof(snl)) < 0) {
+                perror("sendto(AF_NETLINK)");
+                return -1;
+        }
+
+        return 0;
+}
+
+int rtnl_recv(int fd, void *buf, size_t len)
+{
+        struct sockaddr_nl snl;
+        struct iovec iov = { buf, len };
+        struct msghdr msg;
+        ssize_t n;
+        int err;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &snl;
+        msg.msg_namelen = sizeof(snl);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        for (;;) {
+                if ((n = recvmsg(fd, &msg, 0)) >= 0)
+                        break;
+                if (errno == EINTR)
+                        continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                        return 0;
+                err = errno;
+                perror("recvmsg(AF_NETLINK)");
+                /* ENOBUFS tells a caller that events were dropped */
+                errno = err;
+                return -1;
+        }
+
+        if (msg.msg_flags & MSG_TRUNC) {
+                fprintf(stderr, "rtnetlink message truncated.\n");
+                return -1;
+        }
+
+        /* ignore messages which are not sent by the kernel */
+        if (snl.nl_pid != 0)
+                return 0;
+
+        return n;
+}
+
+/** A sequence number of the last dump request, shared by all sockets */
+static u_int32_t rtnl_seq = 0;
+
+int rtnl_dump(int fd, u_int16_t type, u_char family,
+        int (*handler)(const struct nlmsghdr *nh, void *arg), void *arg)
+{
+        char buf[RTNL_BUF_SIZE];
+        struct nlmsghdr *nh;
+        struct nlmsgerr *e;
+        u_int32_t seq;
+        int n, ret = 0;
+
+        /* a dump on another thread takes its own number, replies are matched by the local copy */
+        seq = __atomic_add_fetch(&rtnl_seq, 1, __ATOMIC_RELAXED);
+        if (rtnl_dump_request(fd, type, family, seq) < 0)
+                return -1;
+
+        for (;;) {
+                if ((n = rtnl_recv(fd, buf, sizeof(buf))) < 0)
+                        return -1;
+
+                for (nh = (struct nlmsghdr *) buf; NLMSG_OK(nh, n); nh = NLMSG_NEXT(nh, n)) {
+                        if (nh->nlmsg_seq != seq)
+                                continue;
+
+                        switch (nh->nlmsg_type) {
+                        case NLMSG_DONE:
+                                return ret;
+                        case NLMSG_ERROR:
+                                e = (struct nlmsgerr *) NLMSG_DATA(nh);
+                                fprintf(stderr, "rtnetlink dump failed: %s\n", strerror(-e->error));
+                                return -1;
+                        default:
+                                if (handler(nh, arg) < 0)
+                                        ret = -1;
+                                break;
+                        }
+                }
+        }
+}
+
+int rtnl_parse_link(const struct nlmsghdr *nh, struct rtnl_link *link)
+{
+        struct ifinfomsg *ifi;
+        struct rtattr *rta, *info;
+        int len, info_len;
+
+        if (nh->nlmsg_type != RTM_NEWLINK && nh->nlmsg_type != RTM_DELLINK)
+                return -1;
+
+        if ((len = nh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi))) < 0)
+                return -1;
+
+        ifi = (struct ifinfomsg *) NLMSG_DATA(nh);
+
+        memset(link, 0, sizeof(*link));
+        link->ifindex = ifi->ifi_index;
+        link->hwtype = ifi->ifi_type;
+        link->flags = ifi->ifi_flags;
+
+        for (rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+                switch (rta->rta_type) {
+                case IFLA_IFNAME:
+                        strncpy(link->ifname, (char *) RTA_DATA(rta), IFNAMSIZ - 1);
+                        break;
+                case IFLA_ADDRESS:
+                        if (RTA_PAYLOAD(rta) == ETHER_ADDR_LEN)
+                                memcpy(link->macaddr, RTA_DATA(rta), ETHER_ADDR_LEN);
+                        break;
+                case IFLA_MASTER:
+                        link->master = *(int *) RTA_DATA(rta);
+                        break;
+                case IFLA_OPERSTATE:
+                        link->operstate = *(u_char *) RTA_DATA(rta);
+                        break;
+                case IFLA_LINKINFO:
+                        info_len = RTA_PAYLOAD(rta);
+                        for (info = RTA_DATA(rta); RTA_OK(info, info_len); info = RTA_NEXT(info, info_len)) {
+                                if (info->rta_type == IFLA_INFO_KIND)
+                                        strncpy(link->kind, (char *) RTA_DATA(info), RTNL_KIND_LEN - 1);
+                        }
+                        break;
+                default:
+                        break;
+                }
+        }
+
+        return 0;
+}
+
+int rtnl_parse_addr(const struct nlmsghdr *nh, struct rtnl_addr *addr)
+{
+        struct ifaddrmsg *ifa;
+        struct rtattr *rta;
+        struct in_addr mask;
+        void *local = NULL, *address = NULL;
+        int len;
+
+        if (nh->nlmsg_type != RTM_NEWADDR && nh->nlmsg_type != RTM_DELADDR)
+                return -1;
+
+        if ((len = nh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifa))) < 0)
+                return -1;
+
+        ifa = (struct ifaddrmsg *) NLMSG_DATA(nh);
+
+        memset(addr, 0, sizeof(*addr));
+        addr->ifindex = ifa->ifa_index;
+        addr->family = ifa->ifa_family;
+        addr->prefixlen = ifa->ifa_prefixlen;
+        addr->flags = ifa->ifa_flags;
+
+        for (rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+                switch (rta->rta_type) {
+                case IFA_LOCAL:
+                        local = RTA_DATA(rta);
+                        break;
+                case IFA_ADDRESS:
+                        address = RTA_DATA(rta);
+                        break;
+                case IFA_FLAGS:
+                        addr->flags = *(u_int32_t *) RTA_DATA(rta);
+                        break;
+                default:
+                        break;
+                }
+        }
+
+        /* IFA_ADDRESS is a peer address on point-to-point links */
+        if (local == NULL)
+                local = address;
+        if (local == NULL)
+                return -1;
+
+        if (inet_ntop(addr->family, local, addr->ipaddr, sizeof(addr->ipaddr)) == NULL) {
+                perror("inet_ntop");
+                return -1;
+        }
+
+        if (addr->family == AF_INET) {
+                mask.s_addr = addr->prefixlen ? htonl(0xFFFFFFFFU << (32 - addr->prefixlen)) : 0;
+                if (inet_ntop(AF_INET, &mask, addr->netmask, sizeof(addr->netmask)) == NULL) {
+                        perror("inet_ntop");
+                        return -1;
+                }
+        }
+
+        return 0;
+}
+#endif /* __linux__ */
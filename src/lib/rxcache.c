@@ -0,0 +1,219 @@
+/**
+ * @file   rxcache.c
+ * @brief A library of a cache of received LLDPDUs.
+ *
+ * A source file of a library that keep a CRC32C of the last LLDPDU from each
+ * source MAC address and network interface, so a frame same as the last one is
+ * found without decoding it.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "binary.h"
+#include "fdb.h"
+#include "rxcache.h"
+#include "tlv.h"
+
+static u_int32_t hash_rxcache(u_int64_t key, int ifindex)
+{
+        return (u_int32_t) (((key ^ (u_int64_t) ifindex << 48) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/**
+ * @brief Get a slot of a source or an empty slot to insert it.
+ */
+static u_int32_t get_rxcache_slot(struct rxcache *c, u_int64_t key, int ifindex)
+{
+        struct rxcache_entry *e;
+        u_int32_t h, mask = c->size - 1;
+
+        for (h = hash_rxcache(key, ifindex) & mask; (e = c->entries + h)->ifindex != 0; h = (h + 1) & mask)
+                if (e->key == key && e->ifindex == ifindex)
+                        break;
+
+        return h;
+}
+
+/**
+ * @brief Double a cache and rehash all entries.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int grow_rxcache(struct rxcache *c)
+{
+        struct rxcache_entry *entries;
+        u_int32_t h, mask = c->size * 2 - 1;
+        int i;
+
+        if ((entries = calloc(c->size * 2, sizeof(struct rxcache_entry))) == NULL) {
+                perror("calloc");
+                return -1;
+        }
+
+        for (i = 0; i < c->size; i++) {
+                if (c->entries[i].ifindex == 0)
+                        continue;
+                for (h = hash_rxcache(c->entries[i].key, c->entries[i].ifindex) & mask;
+                     entries[h].ifindex != 0; h = (h + 1) & mask)
+                        ;
+                entries[h] = c->entries[i];
+        }
+
+        free(c->entries);
+        c->entries = entries;
+        c->size *= 2;
+
+        return 0;
+}
+
+/**
+ * @brief Remove an entry in a slot.
+ */
+static void remove_rxcache_slot(struct rxcache *c, u_int32_t h)
+{
+        struct rxcache_entry *e;
+        u_int32_t i, j, k, mask = c->size - 1;
+
+        /* shift following entries back instead of leaving a tombstone */
+        for (i = h, j = (h + 1) & mask; (e = c->entries + j)->ifindex != 0; j = (j + 1) & mask) {
+                k = hash_rxcache(e->key, e->ifindex) & mask;
+                if (((j - k) & mask) >= ((j - i) & mask)) {
+                        c->entries[i] = *e;
+                        i = j;
+                }
+        }
+        memset(c->entries + i, 0, sizeof(struct rxcache_entry));
+        c->num -= 1;
+}
+
+struct rxcache *alloc_rxcache(void)
+{
+        struct rxcache *c;
+
+        if ((c = malloc(sizeof(struct rxcache))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        memset(c, 0, sizeof(struct rxcache));
+
+        if ((c->entries = calloc(RXCACHE_INIT_SIZE, sizeof(struct rxcache_entry))) == NULL) {
+                perror("calloc");
+                free(c);
+                return NULL;
+        }
+        c->size = RXCACHE_INIT_SIZE;
+
+        return c;
+}
+
+void free_rxcache(struct rxcache *c)
+{
+        if (c == NULL)
+                return;
+
+        free(c->entries);
+        free(c);
+}
+
+const struct rxcache_entry *find_rxcache(struct rxcache *c, const u_char *frame, u_int len,
+        int ifindex, u_int64_t now, u_int32_t *crc)
+{
+        const struct ether_header *eh = (const struct ether_header *) frame;
+        struct rxcache_entry *e;
+
+        if (len < ETHER_HDR_LEN)
+                return NULL;
+
+        *crc = crc32c(0, frame + ETHER_HDR_LEN, len - ETHER_HDR_LEN);
+        if (ifindex <= 0)
+                return NULL;
+
+        e = c->entries + get_rxcache_slot(c, get_fdb_key(eh->ether_shost), ifindex);
+        if (e->ifindex == 0 || e->crc != *crc || e->len != len - ETHER_HDR_LEN || e->expire <= now) {
+                c->misses += 1;
+                return NULL;
+        }
+
+        c->hits += 1;
+        e->expire = now + (u_int64_t) e->ttl * 1000;
+
+        return e;
+}
+
+int store_rxcache(struct rxcache *c, const u_char *frame, u_int len, int ifindex, u_int32_t crc,
+        const struct htip_lldpdu *du, u_int64_t now)
+{
+        const struct ether_header *eh = (const struct ether_header *) frame;
+        const u_char *lldpdu = frame + ETHER_HDR_LEN;
+        struct rxcache_entry *e;
+        u_int64_t key;
+        u_int32_t h;
+
+        if (len < ETHER_HDR_LEN)
+                return -1;
+        /* a source on an unknown interface isn't cached */
+        if (ifindex <= 0)
+                return 0;
+
+        key = get_fdb_key(eh->ether_shost);
+        h = get_rxcache_slot(c, key, ifindex);
+
+        /* a shutdown isn't repeated */
+        if (du->ttl == 0) {
+                if (c->entries[h].ifindex != 0)
+                        remove_rxcache_slot(c, h);
+                return 0;
+        }
+
+        if (c->entries[h].ifindex == 0) {
+                /* keep the load factor under 1/2 */
+                if ((c->num + 1) * 2 > c->size) {
+                        if (grow_rxcache(c) < 0)
+                                return -1;
+                        h = get_rxcache_slot(c, key, ifindex);
+                }
+                c->num += 1;
+        }
+
+        e = c->entries + h;
+        e->key = key;
+        e->ifindex = ifindex;
+        e->crc = crc;
+        e->len = len - ETHER_HDR_LEN;
+        e->expire = now + (u_int64_t) du->ttl * 1000;
+        e->ttl = du->ttl;
+        e->chassis_id_off = du->chassis_id - lldpdu;
+        e->chassis_id_len = du->chassis_id_len;
+        e->port_id_off = du->port_id - lldpdu;
+        e->port_id_len = du->port_id_len;
+
+        return 0;
+}
+
+int expire_rxcache(struct rxcache *c, u_int64_t now)
+{
+        int i, n = 0;
+
+        for (i = 0; i < c->size; ) {
+                if (c->entries[i].ifindex == 0 || c->entries[i].expire > now) {
+                        i++;
+                        continue;
+                }
+                /* a following entry may be shifted into the slot */
+                remove_rxcache_slot(c, i);
+                n++;
+        }
+
+        return n;
+}
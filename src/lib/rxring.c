@@ -0,0 +1,233 @@
+/**
+ * @file   rxring.c
+ * @brief A library of a ring passing received LLDPDUs between threads.
+ *
+ * A source file of a library that pass frames decoded by receiving threads to
+ * a single thread owning a neighbor database, through a bounded lock-free ring
+ * of fixed-size records. A producer never blocks, a frame is dropped if the
+ * ring is full.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "rxring.h"
+#include "tlv.h"
+
+/** A size of a cache line, counters written by different threads are kept apart */
+#define RXRING_CACHE_LINE 64
+
+/**
+ * @brief A cell of a ring.
+ *
+ * A producer may claim a cell when seq equals its position, and the consumer
+ * may read it when seq equals the position plus 1. Releasing it makes seq the
+ * position of the next round.
+ */
+struct rxring_cell {
+        /** A sequence number */
+        u_int64_t seq;
+        /** A position the cell was claimed at */
+        u_int64_t pos;
+        /** A record */
+        struct rxring_record record;
+};
+
+struct rxring {
+        /** Cells */
+        struct rxring_cell *cells;
+        /** Storage of frames of all records, ETHER_MAX_LEN bytes each */
+        u_char *slab;
+        /** A number of cells minus 1 */
+        u_int64_t mask;
+        char pad1[RXRING_CACHE_LINE];
+        /** A position of the next cell to claim, shared by producers */
+        u_int64_t tail;
+        /** A number of published records */
+        u_int64_t written;
+        /** A number of dropped frames */
+        u_int64_t dropped;
+        char pad2[RXRING_CACHE_LINE];
+        /** A position of the next cell to read, only by the consumer */
+        u_int64_t head;
+        /** A number of cells read but not released */
+        u_int64_t reading;
+        /** A number of malformed records */
+        u_int64_t malformed;
+};
+
+struct rxring *alloc_rxring(int size)
+{
+        struct rxring *r;
+        u_int64_t i, num;
+
+        for (num = 1; num < (u_int64_t) size; num *= 2)
+                ;
+
+        if ((r = malloc(sizeof(struct rxring))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        memset(r, 0, sizeof(struct rxring));
+
+        if ((r->cells = calloc(num, sizeof(struct rxring_cell))) == NULL ||
+            (r->slab = malloc(num * ETHER_MAX_LEN)) == NULL) {
+                perror("calloc");
+                free_rxring(r);
+                return NULL;
+        }
+        r->mask = num - 1;
+
+        for (i = 0; i < num; i++) {
+                r->cells[i].seq = i;
+                r->cells[i].record.frame = r->slab + i * ETHER_MAX_LEN;
+        }
+
+        return r;
+}
+
+void free_rxring(struct rxring *r)
+{
+        if (r == NULL)
+                return;
+
+        free(r->cells);
+        free(r->slab);
+        free(r);
+}
+
+struct rxring_record *claim_rxring(struct rxring *r)
+{
+        struct rxring_cell *c;
+        u_int64_t pos, seq;
+
+        pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+        for (;;) {
+                c = r->cells + (pos & r->mask);
+                seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+                if (seq == pos) {
+                        /* pos is reloaded if another producer took it */
+                        if (__atomic_compare_exchange_n(&r->tail, &pos, pos + 1, 1,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                                break;
+                } else if ((int64_t) (seq - pos) < 0) {
+                        /* the cell of the last round isn't released yet */
+                        __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+                        return NULL;
+                } else {
+                        pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+                }
+        }
+
+        c->pos = pos;
+
+        return &c->record;
+}
+
+int fill_rxring_record(struct rxring_record *rec, const u_char *frame, u_int len, int ifindex,
+        u_int64_t now, int decode)
+{
+        if (len > ETHER_MAX_LEN)
+                len = ETHER_MAX_LEN;
+
+        memcpy(rec->frame, frame, len);
+        rec->len = len;
+        rec->ifindex = ifindex;
+        rec->time = now;
+        rec->crc = 0;
+
+        if (len < ETHER_HDR_LEN) {
+                rec->status = RXRING_RECORD_MALFORMED;
+                return -1;
+        }
+        memcpy(rec->macaddr, ((const struct ether_header *) frame)->ether_shost, ETHER_ADDR_LEN);
+
+        if (!decode) {
+                rec->status = RXRING_RECORD_RAW;
+                return 0;
+        }
+
+        if (decode_htip_lldpdu(rec->frame + ETHER_HDR_LEN, len - ETHER_HDR_LEN, &rec->du) < 0) {
+                rec->status = RXRING_RECORD_MALFORMED;
+                return -1;
+        }
+        rec->status = RXRING_RECORD_DECODED;
+
+        return 0;
+}
+
+void publish_rxring(struct rxring *r, struct rxring_record *rec)
+{
+        struct rxring_cell *c = (struct rxring_cell *) ((char *) rec - offsetof(struct rxring_cell, record));
+
+        __atomic_fetch_add(&r->written, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->seq, c->pos + 1, __ATOMIC_RELEASE);
+}
+
+int write_rxring(struct rxring *r, const u_char *frame, u_int len, int ifindex, u_int64_t now)
+{
+        struct rxring_record *rec;
+        int ret;
+
+        if ((rec = claim_rxring(r)) == NULL)
+                return -1;
+
+        ret = fill_rxring_record(rec, frame, len, ifindex, now, 1);
+        publish_rxring(r, rec);
+
+        return ret;
+}
+
+int read_rxring(struct rxring *r, struct rxring_record **records, int max)
+{
+        struct rxring_cell *c;
+        u_int64_t pos;
+        int n = 0;
+
+        while (n < max) {
+                pos = r->head + r->reading;
+                c = r->cells + (pos & r->mask);
+                if (__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) != pos + 1)
+                        break;
+
+                r->reading += 1;
+                if (c->record.status == RXRING_RECORD_MALFORMED) {
+                        __atomic_fetch_add(&r->malformed, 1, __ATOMIC_RELAXED);
+                        continue;
+                }
+                records[n++] = &c->record;
+        }
+
+        return n;
+}
+
+void release_rxring(struct rxring *r)
+{
+        u_int64_t i;
+
+        for (i = 0; i < r->reading; i++)
+                __atomic_store_n(&r->cells[(r->head + i) & r->mask].seq, r->head + i + r->mask + 1,
+                        __ATOMIC_RELEASE);
+
+        r->head += r->reading;
+        r->reading = 0;
+}
+
+void get_rxring_stats(struct rxring *r, struct rxring_stats *stats)
+{
+        stats->written = __atomic_load_n(&r->written, __ATOMIC_RELAXED);
+        stats->dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+        stats->malformed = __atomic_load_n(&r->malformed, __ATOMIC_RELAXED);
+}
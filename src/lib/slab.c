@@ -0,0 +1,186 @@
+/**
+ * @file   slab.c
+ * @brief A library of slab allocators of fixed-size objects.
+ *
+ * A source file of a library that carve fixed-size objects out of large pages
+ * and keep freed objects on a free list, so allocating and freeing an object
+ * don't call malloc() once enough pages are allocated.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "slab.h"
+
+/** An alignment of objects, enough for 64-bit integers */
+#define SLAB_ALIGN 8
+/** A size of a header of a page linking pages, objects follow it */
+#define SLAB_PAGE_HEADER_SIZE 16
+
+void init_slab(struct slab *s, size_t object_size)
+{
+        memset(s, 0, sizeof(struct slab));
+
+        if (object_size < sizeof(void *))
+                object_size = sizeof(void *);
+        s->object_size = (object_size + SLAB_ALIGN - 1) & ~(size_t) (SLAB_ALIGN - 1);
+        s->page_objects = (SLAB_PAGE_SIZE - SLAB_PAGE_HEADER_SIZE) / s->object_size;
+        if (s->page_objects < 1)
+                s->page_objects = 1;
+}
+
+void destroy_slab(struct slab *s)
+{
+        void *p;
+
+        while ((p = s->pages) != NULL) {
+                s->pages = *(void **) p;
+                free(p);
+        }
+
+        s->free = NULL;
+        s->page_num = 0;
+        s->num = 0;
+}
+
+/**
+ * @brief Allocate a page and put its objects on the free list.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int grow_slab(struct slab *s)
+{
+        char *page, *p;
+        int i;
+
+        if ((page = malloc(SLAB_PAGE_HEADER_SIZE + s->object_size * s->page_objects)) == NULL) {
+                perror("malloc");
+                return -1;
+        }
+        *(void **) page = s->pages;
+        s->pages = page;
+        s->page_num += 1;
+
+        /* the first object is taken first */
+        for (i = s->page_objects - 1; i >= 0; i--) {
+                p = page + SLAB_PAGE_HEADER_SIZE + s->object_size * i;
+                *(void **) p = s->free;
+                s->free = p;
+        }
+
+        return 0;
+}
+
+void *alloc_slab_object(struct slab *s)
+{
+        void *p;
+
+        if (s->free == NULL && grow_slab(s) < 0)
+                return NULL;
+
+        p = s->free;
+        s->free = *(void **) p;
+        s->num += 1;
+
+        return p;
+}
+
+void free_slab_object(struct slab *s, void *p)
+{
+        if (p == NULL)
+                return;
+
+        *(void **) p = s->free;
+        s->free = p;
+        s->num -= 1;
+}
+
+size_t get_slab_bytes(const struct slab *s)
+{
+        return (size_t) s->page_num * (SLAB_PAGE_HEADER_SIZE + s->object_size * s->page_objects);
+}
+
+void init_slab_classes(struct slab_classes *c)
+{
+        int i;
+
+        for (i = 0; i < SLAB_CLASS_NUM; i++)
+                init_slab(c->slabs + i, (size_t) 1 << (SLAB_CLASS_MIN_SHIFT + i));
+}
+
+void destroy_slab_classes(struct slab_classes *c)
+{
+        int i;
+
+        for (i = 0; i < SLAB_CLASS_NUM; i++)
+                destroy_slab(c->slabs + i);
+}
+
+/**
+ * @brief Get a class of a size.
+ * @return If the size has a class, it returns an index of the class. If not, it returns -1.
+ */
+static int get_slab_class(size_t size)
+{
+        int i;
+
+        for (i = 0; i < SLAB_CLASS_NUM; i++)
+                if (size <= (size_t) 1 << (SLAB_CLASS_MIN_SHIFT + i))
+                        return i;
+
+        return -1;
+}
+
+void *alloc_slab_size(struct slab_classes *c, size_t size)
+{
+        void *p;
+        int i;
+
+        if ((i = get_slab_class(size)) >= 0)
+                return alloc_slab_object(c->slabs + i);
+
+        if ((p = malloc(size)) == NULL)
+                perror("malloc");
+
+        return p;
+}
+
+void free_slab_size(struct slab_classes *c, void *p, size_t size)
+{
+        int i;
+
+        if ((i = get_slab_class(size)) >= 0)
+                free_slab_object(c->slabs + i, p);
+        else
+                free(p);
+}
+
+size_t get_slab_class_size(size_t size)
+{
+        int i;
+
+        if ((i = get_slab_class(size)) >= 0)
+                return (size_t) 1 << (SLAB_CLASS_MIN_SHIFT + i);
+
+        return size;
+}
+
+size_t get_slab_classes_bytes(const struct slab_classes *c)
+{
+        size_t bytes = 0;
+        int i;
+
+        for (i = 0; i < SLAB_CLASS_NUM; i++)
+                bytes += get_slab_bytes(c->slabs + i);
+
+        return bytes;
+}
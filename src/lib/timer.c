@@ -12,3 +12,167 @@
  * @par ChangeLog:
  * - 2017.09.30: Takashi OKADA: Created.
  */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "timer.h"
+
+u_int64_t get_monotonic_msec(void)
+{
+        struct timespec ts;
+
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
+                perror("clock_gettime");
+                return 0;
+        }
+
+        return (u_int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void init_timer_wheel(struct timer_wheel *w, u_int64_t resolution)
+{
+        int i, j;
+
+        w->resolution = resolution > 0 ? resolution : 1;
+        w->tick = 0;
+        w->num = 0;
+
+        for (i = 0; i < TIMER_WHEEL_LEVELS; i++)
+                for (j = 0; j < TIMER_WHEEL_SLOTS; j++)
+                        w->slots[i][j].next = w->slots[i][j].prev = &w->slots[i][j];
+}
+
+void init_timer(struct timer_node *t)
+{
+        t->next = t->prev = NULL;
+        t->expire = 0;
+}
+
+int is_timer_pending(const struct timer_node *t)
+{
+        return t->next != NULL;
+}
+
+/**
+ * @brief Link a timer into a slot by its expiring time.
+ */
+static void link_timer(struct timer_wheel *w, struct timer_node *t)
+{
+        struct timer_node *head;
+        u_int64_t tick, delta;
+        int level;
+
+        /* expiring at the end of a tick never fires early */
+        tick = (t->expire + w->resolution - 1) / w->resolution;
+        if (tick < w->tick)
+                tick = w->tick;
+
+        delta = tick - w->tick;
+        for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++)
+                if (delta < 1ULL << (TIMER_WHEEL_BITS * (level + 1)))
+                        break;
+        /* beyond the wheel, it's moved down again when the last slot comes */
+        if (delta >= 1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+                tick = w->tick + (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+        head = &w->slots[level][(tick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+        t->next = head;
+        t->prev = head->prev;
+        head->prev->next = t;
+        head->prev = t;
+}
+
+/**
+ * @brief Unlink a timer from its slot.
+ */
+static void unlink_timer(struct timer_node *t)
+{
+        t->prev->next = t->next;
+        t->next->prev = t->prev;
+        t->next = t->prev = NULL;
+}
+
+void add_timer(struct timer_wheel *w, struct timer_node *t, u_int64_t expire, u_int64_t now)
+{
+        if (is_timer_pending(t))
+                unlink_timer(t);
+        else
+                w->num += 1;
+
+        /* nothing to expire until now */
+        if (w->num == 1 && now / w->resolution > w->tick)
+                w->tick = now / w->resolution;
+
+        t->expire = expire;
+        link_timer(w, t);
+}
+
+void del_timer(struct timer_wheel *w, struct timer_node *t)
+{
+        if (!is_timer_pending(t))
+                return;
+
+        unlink_timer(t);
+        w->num -= 1;
+}
+
+/**
+ * @brief Move timers in a slot of an upper level down to lower levels.
+ * @return An index of the slot.
+ */
+static int cascade_timer_wheel(struct timer_wheel *w, int level)
+{
+        struct timer_node *head, *t;
+        int i = (w->tick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1);
+
+        head = &w->slots[level][i];
+        while ((t = head->next) != head) {
+                unlink_timer(t);
+                link_timer(w, t);
+        }
+
+        return i;
+}
+
+int run_timer_wheel(struct timer_wheel *w, u_int64_t now,
+        void (*expired)(struct timer_node *t, void *arg), void *arg)
+{
+        struct timer_node list, *head, *t;
+        u_int64_t last = now / w->resolution;
+        int level, c = 0;
+
+        for (; w->tick <= last; w->tick++) {
+                if (w->num == 0) {
+                        w->tick = last + 1;
+                        break;
+                }
+
+                /* a slot of a level comes when all slots below it have passed */
+                for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+                        if ((w->tick & ((1ULL << (TIMER_WHEEL_BITS * level)) - 1)) != 0 ||
+                            cascade_timer_wheel(w, level) != 0)
+                                break;
+
+                /* detach the slot, so an expired timer can be added again */
+                head = &w->slots[0][w->tick & (TIMER_WHEEL_SLOTS - 1)];
+                if (head->next == head)
+                        continue;
+                list.next = head->next;
+                list.prev = head->prev;
+                list.next->prev = &list;
+                list.prev->next = &list;
+                head->next = head->prev = head;
+
+                while ((t = list.next) != &list) {
+                        unlink_timer(t);
+                        w->num -= 1;
+                        expired(t, arg);
+                        c++;
+                }
+        }
+
+        return c;
+}
@@ -26,7 +26,7 @@
 
 u_int get_tlv_len(const struct tlv_header *th)
 {
-        return (th->tlv_len1 << 7) + th->tlv_len2;
+        return (th->tlv_len1 << 8) + th->tlv_len2;
 }
 
 void set_tlv_len(struct tlv_header *th, const u_int len)
@@ -206,10 +206,11 @@ void print_htip_tlv(const struct tlv_header *th, const u_int len)
                 break;
         case HTIP_TTC_SUBTYPE_LINK_INFO:
                 printf("      Link information htip ttc subtype: %u\n", ttc_subtype);
-                print_htip_link_info(p + HTIP_TLV_HEADER_LEN);
+                print_htip_link_info(p + HTIP_TLV_HEADER_LEN, len - HTIP_TLV_HEADER_LEN);
                 break;
         case HTIP_TTC_SUBTYPE_MAC_ADDRESS_LIST:
                 printf("      MAC address list htip ttc subtype: %u\n", ttc_subtype);
+                print_htip_mac_address_list(p + HTIP_TLV_HEADER_LEN, len - HTIP_TLV_HEADER_LEN);
                 break;
         default:
                 printf("      Unknown htip ttc subtype: %u\n", ttc_subtype);
@@ -217,25 +218,94 @@ void print_htip_tlv(const struct tlv_header *th, const u_int len)
         }
 }
 
-void print_htip_link_info(char *p)
+void print_htip_link_info(char *p, u_int len)
 {
-        int i, len;
+        int i;
         char maddr[MAC_BUF_SIZE];
-        struct htip_link_info_header *hh;
+        struct htip_link_info info;
 
-        hh = (struct htip_link_info_header *) p;
-        printf("        iftype len: %u, iftype: %d, port len: %u, port no: %d, mac num: %u, mac:",
-                hh->iftype_len, hh->iftype, hh->portno_len, hh->portno, hh->macaddr_num);
-        len = hh->macaddr_num;
+        if (decode_htip_link_info((u_char *) p, len, &info) < 0) {
+                printf("        malformed link info, len: %u\n", len);
+                return;
+        }
+
+        printf("        iftype: %u, port len: %u, port no: %u, mac num: %d, mac:",
+                info.iftype, info.portno_len, info.port_no, info.macaddr_num);
+
+        for (i = 0; i < info.macaddr_num; i++) {
+                ether_addr_str((u_int8_t *) info.macaddrs + ETHER_ADDR_LEN * i, maddr);
+                printf(" %s", maddr);
+        }
+
+        printf("\n");
+}
+
+int decode_htip_link_info(const u_char *p, u_int len, struct htip_link_info *info)
+{
+        u_int i, off = 0, n;
+
+        memset(info, 0, sizeof(struct htip_link_info));
+
+        /* interface type */
+        if (off + 1 > len || (n = p[off++]) == 0 || n > sizeof(u_int32_t) || off + n > len)
+                return -1;
+        for (i = 0; i < n; i++)
+                info->iftype = (info->iftype << 8) | p[off++];
+
+        /* port number */
+        if (off + 1 > len || (n = p[off++]) == 0 || n > HTIP_LINK_INFO_PORTNO_LEN_MAX || off + n > len)
+                return -1;
+        info->portno_len = n;
+        for (i = 0; i < n; i++)
+                info->port_no = (info->port_no << 8) | p[off++];
+
+        /* MAC addresses */
+        if (off + 1 > len)
+                return -1;
+        info->macaddr_num = p[off++];
+        if (off + (u_int) info->macaddr_num * ETHER_ADDR_LEN > len)
+                return -1;
+        info->macaddrs = p + off;
 
-        for (i = 0; i < len; i++) {
-                ether_addr_str((u_int8_t *) hh + HTIP_LINK_INFO_HEADER_LEN + ETHER_ADDR_LEN * i, maddr);
+        return 0;
+}
+
+void print_htip_mac_address_list(char *p, u_int len)
+{
+        int i;
+        char maddr[MAC_BUF_SIZE];
+        struct htip_mac_address_list list;
+
+        if (decode_htip_mac_address_list((u_char *) p, len, &list) < 0) {
+                printf("        malformed MAC address list, len: %u\n", len);
+                return;
+        }
+
+        printf("        mac num: %d, mac:", list.macaddr_num);
+
+        for (i = 0; i < list.macaddr_num; i++) {
+                ether_addr_str((u_int8_t *) list.macaddrs + ETHER_ADDR_LEN * i, maddr);
                 printf(" %s", maddr);
         }
 
         printf("\n");
 }
 
+int decode_htip_mac_address_list(const u_char *p, u_int len, struct htip_mac_address_list *list)
+{
+        memset(list, 0, sizeof(struct htip_mac_address_list));
+
+        if (len < HTIP_MAC_ADDRESS_LIST_HEADER_LEN)
+                return -1;
+
+        list->macaddr_num = p[0];
+        if (HTIP_MAC_ADDRESS_LIST_HEADER_LEN + (u_int) list->macaddr_num * ETHER_ADDR_LEN > len)
+                return -1;
+        list->macaddrs = p + HTIP_MAC_ADDRESS_LIST_HEADER_LEN;
+
+        return 0;
+}
+
 void print_htip_device_info(char *p)
 {
         int len;
@@ -248,6 +318,122 @@ void print_htip_device_info(char *p)
         printf(", device info: %.*s\n", len, hh->device_info);
 }
 
+/**
+ * @brief Decode a HTIP device information into a decoded LLDPDU.
+ * @param p A pointer to a head of a device information after the HTIP TLV header.
+ * @param len A length of the device information.
+ * @param du A pointer to a decoded LLDPDU.
+ * @return If succeeded, it returns 0. If the device information is malformed, it returns -1.
+ */
+static int decode_htip_lldpdu_device_info(const u_char *p, u_int len, struct htip_lldpdu *du)
+{
+        const struct htip_device_info_header *hh = (const struct htip_device_info_header *) p;
+        u_int n;
+
+        if (len < HTIP_DEVICE_INFO_HEADER_LEN ||
+            (n = hh->device_info_len) > len - HTIP_DEVICE_INFO_HEADER_LEN)
+                return -1;
+
+        switch (hh->device_info_id) {
+        case HTIP_DEVICE_INFO_DEVICE_CATEGORY:
+                du->device_category = hh->device_info;
+                du->device_category_len = n;
+                break;
+        case HTIP_DEVICE_INFO_MANUFACTURER_CODE:
+                du->manufacturer_code = hh->device_info;
+                du->manufacturer_code_len = n;
+                break;
+        case HTIP_DEVICE_INFO_MODEL_NAME:
+                du->model_name = hh->device_info;
+                du->model_name_len = n;
+                break;
+        case HTIP_DEVICE_INFO_MODEL_NUMBER:
+                du->model_number = hh->device_info;
+                du->model_number_len = n;
+                break;
+        case HTIP_DEVICE_INFO_LLDPDU_TRANSMISSION_INTERVAL:
+                if (n != HTIP_DEVICE_INFO_LLDPDU_TRANSMISSION_INTERVAL_LEN)
+                        return -1;
+                du->interval = (hh->device_info[0] << 8) | hh->device_info[1];
+                break;
+        default:
+                break;
+        }
+
+        return 0;
+}
+
+int decode_htip_lldpdu(const u_char *buf, size_t len, struct htip_lldpdu *du)
+{
+        const u_char *p = buf, *v;
+        const struct htip_tlv_header *hh;
+        u_int type, tlv_len, i = 0;
+
+        memset(du, 0, sizeof(struct htip_lldpdu));
+
+        for (; p + TLV_HEADER_LEN <= buf + len; p += TLV_HEADER_LEN + tlv_len, i++) {
+                type = ((const struct tlv_header *) p)->tlv_type;
+                tlv_len = get_tlv_len((const struct tlv_header *) p);
+                v = p + TLV_HEADER_LEN;
+                if (v + tlv_len > buf + len)
+                        return -1;
+
+                /* chassis ID, port ID and TTL come first in this order */
+                if ((i == 0 && type != CHASSIS_ID_TLV) || (i == 1 && type != PORT_ID_TLV) ||
+                    (i == 2 && type != TIME_TO_LIVE_TLV))
+                        return -1;
+
+                switch (type) {
+                case END_OF_LLDPDU_TLV:
+                        return i > 2 ? 0 : -1;
+                case CHASSIS_ID_TLV:
+                        if (tlv_len < 2)
+                                return -1;
+                        du->chassis_id = v;
+                        du->chassis_id_len = tlv_len;
+                        break;
+                case PORT_ID_TLV:
+                        if (tlv_len < 2)
+                                return -1;
+                        du->port_id = v;
+                        du->port_id_len = tlv_len;
+                        break;
+                case TIME_TO_LIVE_TLV:
+                        if (tlv_len < TTL_TLV_HEADER_LEN)
+                                return -1;
+                        du->ttl = (v[0] << 8) | v[1];
+                        break;
+                case ORGANIZATIONALLY_SPECIFIC_TLV:
+                        if (tlv_len < HTIP_TLV_HEADER_LEN || is_htip_tlv((const struct tlv_header *) p, tlv_len) < 0)
+                                break;
+                        hh = (const struct htip_tlv_header *) v;
+                        v += HTIP_TLV_HEADER_LEN;
+                        if (hh->ttc_subtype == HTIP_TTC_SUBTYPE_DEVICE_INFO) {
+                                if (decode_htip_lldpdu_device_info(v, tlv_len - HTIP_TLV_HEADER_LEN, du) < 0)
+                                        return -1;
+                        } else if (hh->ttc_subtype == HTIP_TTC_SUBTYPE_LINK_INFO &&
+                                   du->link_info_num < HTIP_LLDPDU_MAX_LINK_INFO) {
+                                if (decode_htip_link_info(v, tlv_len - HTIP_TLV_HEADER_LEN,
+                                        du->link_info + du->link_info_num) < 0)
+                                        return -1;
+                                du->link_info_num += 1;
+                        } else if (hh->ttc_subtype == HTIP_TTC_SUBTYPE_MAC_ADDRESS_LIST &&
+                                   du->mac_address_list_num < HTIP_LLDPDU_MAX_MAC_ADDRESS_LIST) {
+                                if (decode_htip_mac_address_list(v, tlv_len - HTIP_TLV_HEADER_LEN,
+                                        du->mac_address_list + du->mac_address_list_num) < 0)
+                                        return -1;
+                                du->mac_address_list_num += 1;
+                        }
+                        break;
+                default:
+                        break;
+                }
+        }
+
+        /* End of LLDPDU TLV may be cut off by padding of a short frame */
+        return i > 2 ? 0 : -1;
+}
+
 int is_htip_tlv(const struct tlv_header *th, const u_int len)
 {
         char *p;
@@ -350,12 +536,18 @@ int create_port_description_tlv(u_char *p, u_char *ifname, u_int ifname_len)
 
 int create_lldp_tlv(u_char *p, u_char *macaddr,
         u_int macaddr_len, u_char *ifname, u_int ifname_len)
+{
+        return create_lldp_tlv_ttl(p, macaddr, macaddr_len, ifname, ifname_len, TTL_DEFAULT);
+}
+
+int create_lldp_tlv_ttl(u_char *p, u_char *macaddr,
+        u_int macaddr_len, u_char *ifname, u_int ifname_len, u_int16_t ttl)
 {
         u_int len = 0;
 
         len += create_chassis_id_tlv(p, macaddr, macaddr_len);
         len += create_port_id_tlv(p + len, macaddr, macaddr_len);
-        len += create_ttl_tlv(p + len, TTL_DEFAULT);
+        len += create_ttl_tlv(p + len, ttl);
         len += create_port_description_tlv(p + len, ifname, ifname_len);
 
         return len;
@@ -435,6 +627,20 @@ int create_htip_device_info_tlv(u_char *p, u_char device_info_id,
         return TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + HTIP_DEVICE_INFO_HEADER_LEN + device_info_len;
 }
 
+int create_htip_transmission_interval_tlv(u_char *p, u_int16_t interval)
+{
+        u_int16_t value = htons(interval);
+
+        return create_htip_device_info_tlv(p, HTIP_DEVICE_INFO_LLDPDU_TRANSMISSION_INTERVAL,
+                (u_char *) &value, HTIP_DEVICE_INFO_LLDPDU_TRANSMISSION_INTERVAL_LEN);
+}
+
+int get_htip_transmission_interval_tlv_len(void)
+{
+        return TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + HTIP_DEVICE_INFO_HEADER_LEN +
+                HTIP_DEVICE_INFO_LLDPDU_TRANSMISSION_INTERVAL_LEN;
+}
+
 int create_basic_htip_device_info_tlv(u_char *p,
         u_char *macaddr, u_int macaddr_len, u_char *ifname, u_int ifname_len,
         u_char *device_category, u_int device_category_len,
@@ -475,14 +681,32 @@ int get_basic_htip_device_info_len(u_int macaddr_len, u_int ifname_len,
                 TLV_HEADER_LEN;         /* End of TLV */
 }
 
+u_int get_htip_link_info_portno_len(u_int16_t port_no)
+{
+        return port_no > 0xFF ? HTIP_LINK_INFO_PORTNO_LEN_MAX : HTIP_LINK_INFO_PORTNO_LEN;
+}
+
 int create_htip_link_info_tlv(u_char *p, u_int32_t iftype, u_int16_t port_no, u_int8_t *macaddrs[], int macaddr_num)
 {
-        struct htip_link_info_header hlih;
-        int i, j, fragment, max_macaddr_num, macaddr_num_tlv;
+        return create_htip_link_info_tlv_portno_len(p, iftype, port_no,
+                get_htip_link_info_portno_len(port_no), macaddrs, macaddr_num);
+}
+
+int create_htip_link_info_tlv_portno_len(u_char *p, u_int32_t iftype, u_int16_t port_no,
+        u_int portno_len, u_int8_t *macaddrs[], int macaddr_num)
+{
+        int i, j, fragment, max_macaddr_num, macaddr_num_tlv, header_len;
         u_int len = 0;
 
+        if (portno_len < get_htip_link_info_portno_len(port_no) || portno_len > HTIP_LINK_INFO_PORTNO_LEN_MAX) {
+                fprintf(stderr, "port no: %u doesn't fit in %u bytes.\n", port_no, portno_len);
+                return 0;
+        }
+
+        header_len = HTIP_LINK_INFO_HEADER_LEN_PORTNO(portno_len);
+
         /* max number of MAC address can be stored in TLV */
-        max_macaddr_num = (MAX_TLV_LEN  - HTIP_TLV_HEADER_LEN - HTIP_LINK_INFO_HEADER_LEN) / ETHER_ADDR_LEN;
+        max_macaddr_num = (MAX_TLV_LEN  - HTIP_TLV_HEADER_LEN - header_len) / ETHER_ADDR_LEN;
         /* A number of fragments that are separated in multiple TLVs */
         if (macaddr_num <= 0)
                 fragment = 1;
@@ -498,16 +722,17 @@ int create_htip_link_info_tlv(u_char *p, u_int32_t iftype, u_int16_t port_no, u_
                 if (i + 1 == fragment)
                         macaddr_num_tlv = macaddr_num - i * max_macaddr_num;
 
-                len += create_tlv_header(p + len, HTIP_TLV_HEADER_LEN + HTIP_LINK_INFO_HEADER_LEN + ETHER_ADDR_LEN * macaddr_num_tlv);
+                len += create_tlv_header(p + len, HTIP_TLV_HEADER_LEN + header_len + ETHER_ADDR_LEN * macaddr_num_tlv);
                 len += create_htip_tlv_header(p + len, HTIP_TTC_SUBTYPE_LINK_INFO);
 
-                hlih.iftype_len = HTIP_LINK_INFO_IFTYPE_LEN;
-                hlih.iftype = (u_int8_t) iftype;
-                hlih.portno_len = HTIP_LINK_INFO_PORTNO_LEN;
-                hlih.portno = (u_int8_t) port_no;
-                hlih.macaddr_num = macaddr_num_tlv;
-                memcpy(p + len, &hlih, HTIP_LINK_INFO_HEADER_LEN);
-                len += HTIP_LINK_INFO_HEADER_LEN;
+                /* written byte by byte, the port number may be 1 or 2 bytes */
+                p[len++] = HTIP_LINK_INFO_IFTYPE_LEN;
+                p[len++] = (u_int8_t) iftype;
+                p[len++] = portno_len;
+                if (portno_len == HTIP_LINK_INFO_PORTNO_LEN_MAX)
+                        p[len++] = port_no >> 8;
+                p[len++] = port_no & 0xFF;
+                p[len++] = macaddr_num_tlv;
 
                 for (j = 0; j < macaddr_num_tlv; j++) {
                         memcpy(p + len, macaddrs[i * max_macaddr_num + j], ETHER_ADDR_LEN);
@@ -516,8 +741,8 @@ int create_htip_link_info_tlv(u_char *p, u_int32_t iftype, u_int16_t port_no, u_
 
 #ifdef DEBUG
                 printf("\t\tHTIP link info tlv len: %d, created len: %d, macaddr_num_tlv: %d, MAXTLVLEN: %d, HTIP_TLV_HEADER_LEN: %d, HTIP_LINK_INFO_HEADER_LEN: %d\n",
-                        TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + HTIP_LINK_INFO_HEADER_LEN + ETHER_ADDR_LEN * macaddr_num_tlv, len, macaddr_num_tlv, MAX_TLV_LEN,
-                                                HTIP_TLV_HEADER_LEN, HTIP_LINK_INFO_HEADER_LEN);
+                        TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + header_len + ETHER_ADDR_LEN * macaddr_num_tlv, len, macaddr_num_tlv, MAX_TLV_LEN,
+                                                HTIP_TLV_HEADER_LEN, header_len);
 #endif /* DEBUG */
         }
 
@@ -548,13 +773,81 @@ int get_basic_htip_link_info_len(u_int macaddr_len, u_int ifname_len,
 
 int get_htip_link_info_tlv_len(u_int macaddr_len, int macaddr_num)
 {
-        int i, j, fragment, max_macaddr_num, macaddr_num_tlv;
+        return get_htip_link_info_tlv_len_portno_len(macaddr_len, macaddr_num, HTIP_LINK_INFO_PORTNO_LEN);
+}
+
+int get_htip_link_info_tlv_len_portno_len(u_int macaddr_len, int macaddr_num, u_int portno_len)
+{
+        int fragment, max_macaddr_num, header_len;
 
-        max_macaddr_num = (MAX_TLV_LEN  - HTIP_TLV_HEADER_LEN - HTIP_LINK_INFO_HEADER_LEN) / ETHER_ADDR_LEN;
+        header_len = HTIP_LINK_INFO_HEADER_LEN_PORTNO(portno_len);
+        max_macaddr_num = (MAX_TLV_LEN  - HTIP_TLV_HEADER_LEN - header_len) / ETHER_ADDR_LEN;
         if (macaddr_num <= 0)
                 fragment = 1;
         else
                 fragment = macaddr_num / max_macaddr_num + 1;
 
-        return (TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + HTIP_LINK_INFO_HEADER_LEN) * fragment + macaddr_len * macaddr_num;
+        return (TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + header_len) * fragment + macaddr_len * macaddr_num;
+}
+
+/** The max number of MAC addresses stored in a MAC address list TLV */
+#define HTIP_MAC_ADDRESS_LIST_MAX_NUM \
+        ((MAX_TLV_LEN - HTIP_TLV_HEADER_LEN - HTIP_MAC_ADDRESS_LIST_HEADER_LEN) / ETHER_ADDR_LEN)
+
+int create_htip_mac_address_list_tlv(u_char *p, u_int8_t *macaddrs[], int macaddr_num)
+{
+        int i, j, fragment, macaddr_num_tlv;
+        u_int len = 0;
+
+        /* same fragmentation as link information */
+        if (macaddr_num <= 0)
+                fragment = 1;
+        else
+                fragment = (macaddr_num + HTIP_MAC_ADDRESS_LIST_MAX_NUM - 1) / HTIP_MAC_ADDRESS_LIST_MAX_NUM;
+
+        for (i = 0; i < fragment; i++) {
+                macaddr_num_tlv = HTIP_MAC_ADDRESS_LIST_MAX_NUM;
+                if (i + 1 == fragment)
+                        macaddr_num_tlv = macaddr_num - i * HTIP_MAC_ADDRESS_LIST_MAX_NUM;
+                if (macaddr_num_tlv < 0)
+                        macaddr_num_tlv = 0;
+
+                len += create_tlv_header(p + len, HTIP_TLV_HEADER_LEN + HTIP_MAC_ADDRESS_LIST_HEADER_LEN + ETHER_ADDR_LEN * macaddr_num_tlv);
+                len += create_htip_tlv_header(p + len, HTIP_TTC_SUBTYPE_MAC_ADDRESS_LIST);
+                p[len++] = macaddr_num_tlv;
+
+                for (j = 0; j < macaddr_num_tlv; j++) {
+                        memcpy(p + len, macaddrs[i * HTIP_MAC_ADDRESS_LIST_MAX_NUM + j], ETHER_ADDR_LEN);
+                        len += ETHER_ADDR_LEN;
+                }
+        }
+
+        return len;
+}
+
+int get_htip_mac_address_list_tlv_len(u_int macaddr_len, int macaddr_num)
+{
+        int fragment;
+
+        if (macaddr_num <= 0)
+                fragment = 1;
+        else
+                fragment = (macaddr_num + HTIP_MAC_ADDRESS_LIST_MAX_NUM - 1) / HTIP_MAC_ADDRESS_LIST_MAX_NUM;
+
+        return (TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + HTIP_MAC_ADDRESS_LIST_HEADER_LEN) * fragment +
+                macaddr_len * (macaddr_num > 0 ? macaddr_num : 0);
+}
+
+int get_htip_mac_address_list_max_num(u_int len)
+{
+        u_int header_len = TLV_HEADER_LEN + HTIP_TLV_HEADER_LEN + HTIP_MAC_ADDRESS_LIST_HEADER_LEN;
+        u_int full_len = header_len + ETHER_ADDR_LEN * HTIP_MAC_ADDRESS_LIST_MAX_NUM;
+        int num;
+
+        num = (len / full_len) * HTIP_MAC_ADDRESS_LIST_MAX_NUM;
+        len %= full_len;
+        if (len > header_len)
+                num += (len - header_len) / ETHER_ADDR_LEN;
+
+        return num;
 }
@@ -0,0 +1,863 @@
+/**
+ * @file   topology.c
+ * @brief A library estimating a layer 2 topology from HTIP information.
+ *
+ * A source file of a library that build a graph of switches, ports and end
+ * devices from link information and device information in a neighbor
+ * database, and infer unmanaged segments hidden behind a port.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <net/ethernet.h>
+
+#include "datalink.h"
+#include "fdb.h"
+#include "macmap.h"
+#include "neighbor.h"
+#include "tlv.h"
+#include "topology.h"
+
+/**
+ * @brief Set a bit of a bitset.
+ */
+static inline void set_topology_bit(u_int64_t *set, int i)
+{
+        set[i / 64] |= 1ULL << (i % 64);
+}
+
+/**
+ * @brief Test a bit of a bitset.
+ */
+static inline int test_topology_bit(const u_int64_t *set, int i)
+{
+        return (set[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * @brief Count bits of a bitset.
+ */
+static int count_topology_bits(const u_int64_t *set, int words)
+{
+        int i, c = 0;
+
+        for (i = 0; i < words; i++)
+                c += __builtin_popcountll(set[i]);
+
+        return c;
+}
+
+/**
+ * @brief Get a key of a chassis ID, a 64-bit FNV-1a hash.
+ */
+static u_int64_t get_topology_chassis_key(const struct neighbor *n)
+{
+        u_int64_t h = 14695981039346656037ULL;
+        u_int i;
+
+        for (i = 0; i < n->chassis_id->len; i++)
+                h = (h ^ n->chassis_id->data[i]) * 1099511628211ULL;
+
+        return h;
+}
+
+/**
+ * @brief Get a MAC address in a chassis ID or a port ID.
+ * @param id An ID with its subtype.
+ * @param len A length of the ID.
+ * @param subtype A subtype of a MAC address.
+ * @return If the ID is a MAC address, it returns a pointer to it. If not, it returns NULL.
+ */
+static const u_int8_t *get_topology_id_macaddr(const u_char *id, u_int len, u_char subtype)
+{
+        if (len != ETHER_ADDR_LEN + 1 || (id[0] & 0x0F) != subtype)
+                return NULL;
+
+        return id + 1;
+}
+
+/**
+ * @brief Add a node.
+ * @return If succeeded, it returns an index of the node. If failed, it returns -1.
+ */
+static int add_topology_node(struct topology *t, int type, const struct neighbor *neighbor,
+        const u_int8_t *macaddr)
+{
+        struct topology_node *p;
+        int size;
+
+        if (t->node_num == t->node_size) {
+                size = t->node_size ? t->node_size * 2 : TOPOLOGY_INIT_SIZE;
+                if ((p = realloc(t->nodes, size * sizeof(struct topology_node))) == NULL) {
+                        perror("realloc");
+                        return -1;
+                }
+                t->nodes = p;
+                t->node_size = size;
+        }
+
+        p = t->nodes + t->node_num;
+        memset(p, 0, sizeof(struct topology_node));
+        p->type = type;
+        p->neighbor = neighbor;
+        if (macaddr != NULL)
+                memcpy(p->macaddr, macaddr, ETHER_ADDR_LEN);
+        p->first_port = -1;
+        p->uplink = -1;
+        p->parent = -1;
+
+        return t->node_num++;
+}
+
+/**
+ * @brief Find a port of a switch.
+ * @return If found, it returns an index of the port. If not, it returns -1.
+ */
+static int find_topology_port(struct topology *t, int node, u_int16_t port_no)
+{
+        int i;
+
+        for (i = t->nodes[node].first_port; i >= 0; i = t->ports[i].next)
+                if (t->ports[i].port_no == port_no)
+                        return i;
+
+        return -1;
+}
+
+/**
+ * @brief Get a port of a switch, a new port is added if not found.
+ * @return If succeeded, it returns an index of the port. If failed, it returns -1.
+ */
+static int get_topology_port(struct topology *t, int node, u_int16_t port_no)
+{
+        struct topology_port *p;
+        int i, size;
+
+        if ((i = find_topology_port(t, node, port_no)) >= 0)
+                return i;
+
+        if (t->port_num == t->port_size) {
+                size = t->port_size ? t->port_size * 2 : TOPOLOGY_INIT_SIZE;
+                if ((p = realloc(t->ports, size * sizeof(struct topology_port))) == NULL) {
+                        perror("realloc");
+                        return -1;
+                }
+                t->ports = p;
+                t->port_size = size;
+        }
+
+        p = t->ports + t->port_num;
+        memset(p, 0, sizeof(struct topology_port));
+        p->node = node;
+        p->port_no = port_no;
+        p->next = t->nodes[node].first_port;
+        t->nodes[node].first_port = t->port_num;
+
+        return t->port_num++;
+}
+
+/**
+ * @brief Add a link.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int add_topology_edge(struct topology *t, int node1, int port1, int node2, int port2)
+{
+        struct topology_edge *p;
+        int size;
+
+        if (t->edge_num == t->edge_size) {
+                size = t->edge_size ? t->edge_size * 2 : TOPOLOGY_INIT_SIZE;
+                if ((p = realloc(t->edges, size * sizeof(struct topology_edge))) == NULL) {
+                        perror("realloc");
+                        return -1;
+                }
+                t->edges = p;
+                t->edge_size = size;
+        }
+
+        p = t->edges + t->edge_num++;
+        p->node1 = node1;
+        p->port1 = port1;
+        p->node2 = node2;
+        p->port2 = port2;
+
+        return 0;
+}
+
+/**
+ * @brief Add nodes of HTIP devices, and map their chassis IDs and own MAC addresses.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int add_topology_devices(struct topology *t, struct neighbor_db *db)
+{
+        const struct neighbor *n;
+        const u_int8_t *chassis_mac, *port_mac;
+        u_int64_t key;
+        int i, j, node;
+
+        for (i = 0; i < db->size; i++) {
+                if ((n = db->table[i]) == NULL)
+                        continue;
+
+                chassis_mac = get_topology_id_macaddr(n->chassis_id->data, n->chassis_id->len, CHASSIS_ID_SUBTYPE_MAC_ADDRESS);
+                port_mac = get_topology_id_macaddr(n->port_id->data, n->port_id->len, PORT_ID_SUBTYPE_MAC_ADDRESS);
+
+                /* network interfaces of a device share its chassis ID */
+                key = get_topology_chassis_key(n);
+                if ((node = find_macmap(&t->chassis, key)) < 0) {
+                        if ((node = add_topology_node(t, TOPOLOGY_NODE_DEVICE, n,
+                                chassis_mac ? chassis_mac : port_mac)) < 0 ||
+                            add_macmap(&t->chassis, key, node) < 0)
+                                return -1;
+                }
+                if (n->link_num > 0)
+                        t->nodes[node].type = TOPOLOGY_NODE_SWITCH;
+
+                if (chassis_mac != NULL && add_macmap(&t->macs, get_fdb_key(chassis_mac), node) < 0)
+                        return -1;
+                if (port_mac != NULL && add_macmap(&t->macs, get_fdb_key(port_mac), node) < 0)
+                        return -1;
+                for (j = 0; j < n->mac_list.macaddr_num; j++)
+                        if (add_macmap(&t->macs, get_fdb_key(n->mac_list.macaddrs + ETHER_ADDR_LEN * j), node) < 0)
+                                return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Add ports of switches and nodes of MAC addresses only seen in link information.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int add_topology_ports(struct topology *t, struct neighbor_db *db)
+{
+        const struct neighbor *n;
+        const struct neighbor_link *link;
+        const u_int8_t *macaddr;
+        u_int64_t key;
+        int i, j, k, x, node;
+
+        for (i = 0; i < db->size; i++) {
+                if ((n = db->table[i]) == NULL || n->link_num == 0)
+                        continue;
+
+                node = find_macmap(&t->chassis, get_topology_chassis_key(n));
+                for (j = 0; j < n->link_num; j++) {
+                        link = n->links + j;
+                        if (get_topology_port(t, node, link->port_no) < 0)
+                                return -1;
+                        for (k = 0; k < link->macset.macaddr_num; k++) {
+                                macaddr = link->macset.macaddrs + ETHER_ADDR_LEN * k;
+                                key = get_fdb_key(macaddr);
+                                if (find_macmap(&t->macs, key) >= 0)
+                                        continue;
+                                if ((x = add_topology_node(t, TOPOLOGY_NODE_UNKNOWN, NULL, macaddr)) < 0 ||
+                                    add_macmap(&t->macs, key, x) < 0)
+                                        return -1;
+                        }
+                }
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Fill bitsets of nodes beyond ports.
+ */
+static void fill_topology_macsets(struct topology *t, struct neighbor_db *db)
+{
+        const struct neighbor *n;
+        const struct neighbor_link *link;
+        struct topology_port *p;
+        int i, j, k, x, node;
+
+        for (i = 0; i < db->size; i++) {
+                if ((n = db->table[i]) == NULL || n->link_num == 0)
+                        continue;
+
+                node = find_macmap(&t->chassis, get_topology_chassis_key(n));
+                for (j = 0; j < n->link_num; j++) {
+                        link = n->links + j;
+                        p = t->ports + get_topology_port(t, node, link->port_no);
+                        for (k = 0; k < link->macset.macaddr_num; k++) {
+                                x = find_macmap(&t->macs, get_fdb_key(link->macset.macaddrs + ETHER_ADDR_LEN * k));
+                                if (x != node)
+                                        set_topology_bit(p->macset, x);
+                        }
+                }
+        }
+
+        for (i = 0; i < t->port_num; i++)
+                t->ports[i].macset_num = count_topology_bits(t->ports[i].macset, t->words);
+}
+
+/**
+ * @brief Find a root switch, the switch seeing the most nodes is likely in the middle.
+ * @return If found, it returns an index of the switch. If not, it returns -1.
+ */
+static int find_topology_root(struct topology *t)
+{
+        int i, j, sum, max = -1, root = -1;
+
+        for (i = 0; i < t->node_num; i++) {
+                if (t->nodes[i].type != TOPOLOGY_NODE_SWITCH)
+                        continue;
+                for (sum = 0, j = t->nodes[i].first_port; j >= 0; j = t->ports[j].next)
+                        sum += t->ports[j].macset_num;
+                if (sum > max) {
+                        max = sum;
+                        root = i;
+                }
+        }
+
+        return root;
+}
+
+/**
+ * @brief Find an uplink of a switch, the largest port beyond which the root is seen.
+ * @return If found, it returns an index of the port. If not, it returns -1.
+ */
+static int find_topology_uplink(struct topology *t, int node)
+{
+        int j, uplink = -1;
+
+        if (node == t->root)
+                return -1;
+
+        for (j = t->nodes[node].first_port; j >= 0; j = t->ports[j].next) {
+                if (!test_topology_bit(t->ports[j].macset, t->root))
+                        continue;
+                if (uplink < 0 || t->ports[j].macset_num > t->ports[uplink].macset_num)
+                        uplink = j;
+        }
+
+        return uplink;
+}
+
+/**
+ * @brief Find a port a switch is attached to, the smallest downlink beyond which it's seen.
+ * @return If found, it returns an index of the port. If not, it returns -1.
+ */
+static int find_topology_parent(struct topology *t, int node)
+{
+        struct topology_port *p;
+        int i, parent = -1;
+
+        for (i = 0; i < t->port_num; i++) {
+                p = t->ports + i;
+                if (t->nodes[p->node].uplink == i || !test_topology_bit(p->macset, node))
+                        continue;
+                if (parent < 0 || p->macset_num < t->ports[parent].macset_num)
+                        parent = i;
+        }
+
+        return parent;
+}
+
+/**
+ * @brief Attach nodes to a port.
+ *
+ * Nodes beyond downlinks of switches attached to the port are removed from
+ * the port, and the rest are directly attached to it. Parents of switches must
+ * be found before.
+ */
+static void attach_topology_port(struct topology *t, int i)
+{
+        struct topology_port *p = t->ports + i;
+        struct topology_node *s;
+        u_int64_t m;
+        int j, w, x;
+
+        for (w = 0; w < t->words; w++)
+                for (m = p->attached[w] & ~t->switches[w]; m != 0; m &= m - 1)
+                        if (t->nodes[(x = w * 64 + __builtin_ctzll(m))].parent == i)
+                                t->nodes[x].parent = -1;
+
+        if (t->nodes[p->node].uplink == i) {
+                memset(p->attached, 0, t->words * sizeof(u_int64_t));
+                p->attached_num = 0;
+                return;
+        }
+
+        memcpy(p->attached, p->macset, t->words * sizeof(u_int64_t));
+        for (w = 0; w < t->words; w++) {
+                for (m = p->macset[w] & t->switches[w]; m != 0; m &= m - 1) {
+                        s = t->nodes + w * 64 + __builtin_ctzll(m);
+                        if (s->parent != i)
+                                continue;
+                        for (j = s->first_port; j >= 0; j = t->ports[j].next) {
+                                if (j == s->uplink)
+                                        continue;
+                                for (x = 0; x < t->words; x++)
+                                        p->attached[x] &= ~t->ports[j].macset[x];
+                        }
+                }
+        }
+
+        p->attached_num = count_topology_bits(p->attached, t->words);
+        for (w = 0; w < t->words; w++)
+                for (m = p->attached[w] & ~t->switches[w]; m != 0; m &= m - 1)
+                        t->nodes[w * 64 + __builtin_ctzll(m)].parent = i;
+}
+
+/**
+ * @brief Attach nodes to downlink ports.
+ *
+ * A switch is attached to the smallest downlink beyond which it's seen, found
+ * for all switches at once by scanning ports.
+ */
+static void attach_topology_nodes(struct topology *t)
+{
+        struct topology_port *p;
+        struct topology_node *s;
+        u_int64_t m;
+        int i, w;
+
+        for (i = 0; i < t->port_num; i++) {
+                p = t->ports + i;
+                if (t->nodes[p->node].uplink == i)
+                        continue;
+                for (w = 0; w < t->words; w++) {
+                        for (m = p->macset[w] & t->switches[w]; m != 0; m &= m - 1) {
+                                s = t->nodes + w * 64 + __builtin_ctzll(m);
+                                if (s->parent < 0 || p->macset_num < t->ports[s->parent].macset_num)
+                                        s->parent = i;
+                        }
+                }
+        }
+
+        for (i = 0; i < t->port_num; i++)
+                attach_topology_port(t, i);
+}
+
+/**
+ * @brief Add links of attached nodes, through a segment if a port has several of them.
+ *
+ * Segments and links added before are removed first.
+ *
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int add_topology_edges(struct topology *t)
+{
+        u_int64_t m;
+        int i, w, x, node, segment;
+
+        t->node_num = t->base_num;
+        t->edge_num = 0;
+
+        for (i = 0; i < t->port_num; i++) {
+                if (t->ports[i].attached_num == 0)
+                        continue;
+
+                node = t->ports[i].node;
+                segment = -1;
+                if (t->ports[i].attached_num > 1) {
+                        if ((segment = add_topology_node(t, TOPOLOGY_NODE_SEGMENT, NULL, NULL)) < 0 ||
+                            add_topology_edge(t, node, i, segment, -1) < 0)
+                                return -1;
+                }
+
+                for (w = 0; w < t->words; w++) {
+                        for (m = t->ports[i].attached[w]; m != 0; m &= m - 1) {
+                                x = w * 64 + __builtin_ctzll(m);
+                                if (add_topology_edge(t, segment < 0 ? node : segment, segment < 0 ? i : -1,
+                                        x, t->nodes[x].uplink) < 0)
+                                        return -1;
+                        }
+                }
+        }
+
+        t->edge_generation = t->generation;
+
+        return 0;
+}
+
+/**
+ * @brief Free arrays of a topology, it keeps its database and generation.
+ */
+static void clear_topology(struct topology *t)
+{
+        struct neighbor_db *db = t->db;
+        u_int64_t generation = t->generation;
+
+        free(t->nodes);
+        free(t->ports);
+        free(t->edges);
+        free(t->bits);
+        destroy_macmap(&t->macs);
+        destroy_macmap(&t->chassis);
+
+        memset(t, 0, sizeof(struct topology));
+        t->db = db;
+        t->generation = generation;
+        t->root = -1;
+}
+
+/**
+ * @brief Build a topology in a cleared one.
+ * @return If succeeded, it returns 0. If failed, it returns -1.
+ */
+static int build_topology_r(struct topology *t, struct neighbor_db *db)
+{
+        int i;
+
+        if (init_macmap(&t->macs, 0) < 0 || init_macmap(&t->chassis, 0) < 0)
+                return -1;
+
+        if (add_topology_devices(t, db) < 0 || add_topology_ports(t, db) < 0)
+                return -1;
+
+        /* node indexes are fixed here, segments added later aren't in bitsets */
+        t->base_num = t->node_num;
+        t->words = (t->node_num * 2 + 64) / 64;
+        if ((t->bits = calloc((size_t) (t->port_num * 2 + 2) * t->words, sizeof(u_int64_t))) == NULL) {
+                perror("calloc");
+                return -1;
+        }
+        for (i = 0; i < t->port_num; i++) {
+                t->ports[i].macset = t->bits + (size_t) i * 2 * t->words;
+                t->ports[i].attached = t->ports[i].macset + t->words;
+        }
+        t->switches = t->bits + (size_t) t->port_num * 2 * t->words;
+        t->scratch = t->switches + t->words;
+        for (i = 0; i < t->node_num; i++)
+                if (t->nodes[i].type == TOPOLOGY_NODE_SWITCH)
+                        set_topology_bit(t->switches, i);
+
+        fill_topology_macsets(t, db);
+        if ((t->root = find_topology_root(t)) >= 0)
+                for (i = 0; i < t->node_num; i++)
+                        if (t->nodes[i].type == TOPOLOGY_NODE_SWITCH)
+                                t->nodes[i].uplink = find_topology_uplink(t, i);
+        attach_topology_nodes(t);
+
+        return add_topology_edges(t);
+}
+
+struct topology *build_topology(struct neighbor_db *db)
+{
+        struct topology *t;
+
+        if ((t = malloc(sizeof(struct topology))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        memset(t, 0, sizeof(struct topology));
+        t->root = -1;
+
+        if (build_topology_r(t, db) < 0) {
+                fprintf(stderr, "build_topology() failed.\n");
+                free_topology(t);
+                return NULL;
+        }
+
+        return t;
+}
+
+/**
+ * @brief Add a node for a MAC address only seen in link information.
+ * @return If succeeded, it returns an index of the node. If there's no room in bitsets or failed, it returns -1.
+ */
+static int add_topology_unknown(struct topology *t, const u_int8_t *macaddr)
+{
+        int x;
+
+        if (t->node_num >= t->words * 64)
+                return -1;
+
+        if ((x = add_topology_node(t, TOPOLOGY_NODE_UNKNOWN, NULL, macaddr)) < 0 ||
+            add_macmap(&t->macs, get_fdb_key(macaddr), x) < 0)
+                return -1;
+        t->base_num = t->node_num;
+
+        return x;
+}
+
+/**
+ * @brief Add a new HTIP device without link information in place.
+ *
+ * A node only seen in link information becomes the device.
+ *
+ * @return If succeeded, it returns 0. If the topology must be built again, it returns -1.
+ */
+static int add_topology_device(struct topology *t, const struct neighbor *n)
+{
+        const u_int8_t *chassis_mac, *port_mac, *macaddr;
+        u_int64_t key;
+        int j, x, node;
+
+        chassis_mac = get_topology_id_macaddr(n->chassis_id->data, n->chassis_id->len, CHASSIS_ID_SUBTYPE_MAC_ADDRESS);
+        port_mac = get_topology_id_macaddr(n->port_id->data, n->port_id->len, PORT_ID_SUBTYPE_MAC_ADDRESS);
+        macaddr = chassis_mac ? chassis_mac : port_mac;
+
+        key = get_topology_chassis_key(n);
+        if ((node = find_macmap(&t->chassis, key)) < 0) {
+                if (macaddr != NULL && (node = find_macmap(&t->macs, get_fdb_key(macaddr))) >= 0) {
+                        if (t->nodes[node].type != TOPOLOGY_NODE_UNKNOWN)
+                                return -1;
+                        t->nodes[node].type = TOPOLOGY_NODE_DEVICE;
+                        t->nodes[node].neighbor = n;
+                } else {
+                        if (t->node_num >= t->words * 64 ||
+                            (node = add_topology_node(t, TOPOLOGY_NODE_DEVICE, n, macaddr)) < 0)
+                                return -1;
+                        t->base_num = t->node_num;
+                }
+                if (add_macmap(&t->chassis, key, node) < 0)
+                        return -1;
+        }
+
+        /* a MAC address already known as another node moves nodes in bitsets */
+        for (j = -2; j < n->mac_list.macaddr_num; j++) {
+                macaddr = j == -2 ? chassis_mac : j == -1 ? port_mac : n->mac_list.macaddrs + ETHER_ADDR_LEN * j;
+                if (macaddr == NULL)
+                        continue;
+                if ((x = find_macmap(&t->macs, get_fdb_key(macaddr))) >= 0) {
+                        if (x != node)
+                                return -1;
+                } else if (add_macmap(&t->macs, get_fdb_key(macaddr), node) < 0)
+                        return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Update a port by changed link information in place.
+ *
+ * Switches seen beyond the port before or after the change may move to
+ * another port, so their parents are found again, and the ports they leave
+ * or join are attached again with the port itself and the parent of its
+ * switch.
+ *
+ * @return If succeeded, it returns 0. If the topology must be built again, it returns -1.
+ */
+static int update_topology_port(struct topology *t, int node, const struct neighbor_link *link)
+{
+        struct topology_port *p;
+        struct topology_node *s;
+        const u_int8_t *macaddr;
+        u_int64_t m;
+        int i, k, w, x, old;
+
+        if ((i = find_topology_port(t, node, link->port_no)) < 0)
+                return -1;
+
+        p = t->ports + i;
+        memcpy(t->scratch, p->macset, t->words * sizeof(u_int64_t));
+        memset(p->macset, 0, t->words * sizeof(u_int64_t));
+        for (k = 0; k < link->macset.macaddr_num; k++) {
+                macaddr = link->macset.macaddrs + ETHER_ADDR_LEN * k;
+                if ((x = find_macmap(&t->macs, get_fdb_key(macaddr))) < 0 &&
+                    (x = add_topology_unknown(t, macaddr)) < 0)
+                        return -1;
+                if (x != node)
+                        set_topology_bit(p->macset, x);
+        }
+        p->macset_num = count_topology_bits(p->macset, t->words);
+
+        /*
+         * the root is kept until the topology is built again, any switch gives
+         * the same links, but a new uplink changes which ports are downlinks
+         */
+        if (find_topology_uplink(t, node) != t->nodes[node].uplink)
+                return -1;
+        if (t->nodes[node].uplink == i)
+                return 0;
+
+        for (w = 0; w < t->words; w++) {
+                for (m = (t->scratch[w] | p->macset[w]) & t->switches[w]; m != 0; m &= m - 1) {
+                        s = t->nodes + w * 64 + __builtin_ctzll(m);
+                        old = s->parent;
+                        s->parent = find_topology_parent(t, s - t->nodes);
+                        if (old >= 0 && old != i)
+                                attach_topology_port(t, old);
+                        if (s->parent >= 0 && s->parent != old && s->parent != i)
+                                attach_topology_port(t, s->parent);
+                }
+        }
+
+        attach_topology_port(t, i);
+        if (t->nodes[node].parent >= 0)
+                attach_topology_port(t, t->nodes[node].parent);
+
+        return 0;
+}
+
+/**
+ * @brief A hook called after a neighbor is added or changed.
+ */
+static void update_topology(void *arg, struct neighbor *n, int flags)
+{
+        struct topology *t = arg;
+        int j, node;
+
+        if (t->stale)
+                return;
+
+        t->generation += 1;
+        /* segments are added again with links, new nodes take their place */
+        t->node_num = t->base_num;
+
+        if (flags & NEIGHBOR_ADDED) {
+                if (n->link_num > 0 || add_topology_device(t, n) < 0)
+                        t->stale = 1;
+                return;
+        }
+
+        if (flags & (NEIGHBOR_LINK_ADDED | NEIGHBOR_LINK_REMOVED | NEIGHBOR_MAC_LIST_CHANGED)) {
+                t->stale = 1;
+                return;
+        }
+
+        if (!(flags & NEIGHBOR_LINK_CHANGED))
+                return;
+
+        node = find_macmap(&t->chassis, get_topology_chassis_key(n));
+        if (node < 0 || t->nodes[node].type != TOPOLOGY_NODE_SWITCH) {
+                t->stale = 1;
+                return;
+        }
+
+        for (j = 0; j < n->link_num; j++) {
+                if (n->links[j].macset.changed != t->db->frame)
+                        continue;
+                if (update_topology_port(t, node, n->links + j) < 0) {
+                        t->stale = 1;
+                        return;
+                }
+        }
+}
+
+/**
+ * @brief A hook called before a neighbor is removed.
+ */
+static void remove_topology(void *arg, struct neighbor *n)
+{
+        struct topology *t = arg;
+
+        (void) n;
+
+        /* nodes may point to the neighbor */
+        t->generation += 1;
+        t->stale = 1;
+}
+
+struct topology *alloc_topology(struct neighbor_db *db)
+{
+        struct topology *t;
+        struct neighbor_hook hook;
+
+        if ((t = build_topology(db)) == NULL)
+                return NULL;
+
+        t->db = db;
+        hook.updated = update_topology;
+        hook.removed = remove_topology;
+        hook.arg = t;
+        set_neighbor_hook(db, &hook);
+
+        return t;
+}
+
+int refresh_topology(struct topology *t)
+{
+        if (t->stale) {
+                clear_topology(t);
+                if (build_topology_r(t, t->db) < 0) {
+                        fprintf(stderr, "build_topology_r() failed.\n");
+                        t->stale = 1;
+                        return -1;
+                }
+                return 0;
+        }
+
+        if (t->edge_generation != t->generation && add_topology_edges(t) < 0) {
+                fprintf(stderr, "add_topology_edges() failed.\n");
+                t->stale = 1;
+                return -1;
+        }
+
+        return 0;
+}
+
+void free_topology(struct topology *t)
+{
+        if (t == NULL)
+                return;
+
+        if (t->db != NULL && t->db->hook.arg == t)
+                set_neighbor_hook(t->db, NULL);
+
+        clear_topology(t);
+        free(t);
+}
+
+int find_topology_node(struct topology *t, const u_int8_t macaddr[])
+{
+        return find_macmap(&t->macs, get_fdb_key(macaddr));
+}
+
+void print_topology_node(struct topology *t, int node, int port)
+{
+        const struct topology_node *p = t->nodes + node;
+        char maddr[MAC_BUF_SIZE];
+
+        ether_addr_str(p->macaddr, maddr);
+
+        switch (p->type) {
+        case TOPOLOGY_NODE_SWITCH:
+                printf("switch %s", maddr);
+                break;
+        case TOPOLOGY_NODE_DEVICE:
+                printf("device %s", maddr);
+                break;
+        case TOPOLOGY_NODE_SEGMENT:
+                printf("segment #%d", node);
+                break;
+        default:
+                printf("%s", maddr);
+                break;
+        }
+
+        if (port >= 0)
+                printf(" port %u", t->ports[port].port_no);
+
+        if (p->neighbor != NULL && (p->neighbor->device_category != NULL || p->neighbor->model_name != NULL))
+                printf(" (%.*s, %.*s)", INTERN_STRING_ARG(p->neighbor->device_category),
+                        INTERN_STRING_ARG(p->neighbor->model_name));
+}
+
+void print_topology(struct topology *t)
+{
+        int i;
+
+        if (refresh_topology(t) < 0)
+                return;
+
+        printf("topology: %d nodes, %d ports, %d links, generation: %llu, root: ",
+                t->node_num, t->port_num, t->edge_num, (unsigned long long) t->generation);
+        if (t->root >= 0)
+                print_topology_node(t, t->root, -1);
+        else
+                printf("none");
+        printf("\n");
+
+        for (i = 0; i < t->edge_num; i++) {
+                printf("  ");
+                print_topology_node(t, t->edges[i].node1, t->edges[i].port1);
+                printf(" -- ");
+                print_topology_node(t, t->edges[i].node2, t->edges[i].port2);
+                printf("\n");
+        }
+}
@@ -0,0 +1,214 @@
+/**
+ * @file   txpool.c
+ * @brief A library of worker threads sending frames to ports.
+ *
+ * A source file of a library that split per-port frame encoding and sending
+ * across worker threads, each of which has its own socket.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "datalink.h"
+#include "txpool.h"
+
+/**
+ * @brief A worker thread.
+ */
+struct txpool_worker {
+        /** A pool the worker belongs to */
+        struct txpool *pool;
+        /** A thread */
+        pthread_t thread;
+        /** A socket to send frames, -1 if not available */
+        int sock;
+        /** 1 if the thread was started */
+        int started;
+};
+
+struct txpool {
+        /** Workers */
+        struct txpool_worker *workers;
+        /** A number of workers */
+        int num;
+        /** A lock of the members below */
+        pthread_mutex_t lock;
+        /** Signaled when a cycle starts or the pool stops */
+        pthread_cond_t start;
+        /** Signaled when the last worker finishes a cycle */
+        pthread_cond_t done;
+        /** Incremented for each cycle */
+        u_int64_t generation;
+        /** A job of the current cycle */
+        txpool_job job;
+        /** An argument of job */
+        void *arg;
+        /** A number of ports of the current cycle */
+        int job_num;
+        /** An index of the next port to be handed */
+        int next;
+        /** A number of workers still in the current cycle */
+        int running;
+        /** 1 if any job of the current cycle failed */
+        int failed;
+        /** 1 if workers should exit */
+        int stop;
+};
+
+/**
+ * @brief A main loop of a worker thread.
+ * @param p A pointer to a worker.
+ * @return NULL
+ */
+static void *run_txpool_worker(void *p)
+{
+        struct txpool_worker *w = p;
+        struct txpool *pool = w->pool;
+        u_int64_t seen = 0;
+        int i;
+
+        pthread_mutex_lock(&pool->lock);
+        for (;;) {
+                while (!pool->stop && pool->generation == seen)
+                        pthread_cond_wait(&pool->start, &pool->lock);
+                if (pool->stop)
+                        break;
+                seen = pool->generation;
+
+                /* encoding a frame costs much more than the lock */
+                while (pool->next < pool->job_num) {
+                        i = pool->next++;
+                        pthread_mutex_unlock(&pool->lock);
+                        if (pool->job(pool->arg, i, w->sock) < 0) {
+                                pthread_mutex_lock(&pool->lock);
+                                pool->failed = 1;
+                                continue;
+                        }
+                        pthread_mutex_lock(&pool->lock);
+                }
+
+                if (--pool->running == 0)
+                        pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        return NULL;
+}
+
+struct txpool *alloc_txpool(int num)
+{
+        struct txpool *pool;
+        int i, ret;
+
+        if (num <= 0 || num > TXPOOL_MAX_WORKERS) {
+                fprintf(stderr, "txpool: invalid number of workers: %d\n", num);
+                return NULL;
+        }
+
+        if ((pool = malloc(sizeof(struct txpool))) == NULL) {
+                perror("malloc");
+                return NULL;
+        }
+        memset(pool, 0, sizeof(struct txpool));
+
+        if ((pool->workers = calloc(num, sizeof(struct txpool_worker))) == NULL) {
+                perror("calloc");
+                free(pool);
+                return NULL;
+        }
+
+        pthread_mutex_init(&pool->lock, NULL);
+        pthread_cond_init(&pool->start, NULL);
+        pthread_cond_init(&pool->done, NULL);
+        pool->num = num;
+
+        for (i = 0; i < num; i++) {
+                pool->workers[i].pool = pool;
+                pool->workers[i].sock = -1;
+#ifdef __linux__
+                if ((pool->workers[i].sock = open_frame_socket()) < 0) {
+                        fprintf(stderr, "txpool: open_frame_socket() failed.\n");
+                        free_txpool(pool);
+                        return NULL;
+                }
+#endif /* __linux__ */
+                if ((ret = pthread_create(&pool->workers[i].thread, NULL,
+                        run_txpool_worker, pool->workers + i)) != 0) {
+                        fprintf(stderr, "txpool: pthread_create() failed: %s\n", strerror(ret));
+                        free_txpool(pool);
+                        return NULL;
+                }
+                pool->workers[i].started = 1;
+        }
+
+        return pool;
+}
+
+void free_txpool(struct txpool *pool)
+{
+        int i;
+
+        if (pool == NULL)
+                return;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->stop = 1;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+
+        for (i = 0; i < pool->num; i++) {
+                if (pool->workers[i].started)
+                        pthread_join(pool->workers[i].thread, NULL);
+                if (pool->workers[i].sock >= 0)
+                        close(pool->workers[i].sock);
+        }
+
+        pthread_cond_destroy(&pool->done);
+        pthread_cond_destroy(&pool->start);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->workers);
+        free(pool);
+}
+
+int get_txpool_worker_num(struct txpool *pool)
+{
+        return pool->num;
+}
+
+int run_txpool(struct txpool *pool, int num, txpool_job job, void *arg)
+{
+        int failed;
+
+        if (num <= 0)
+                return 0;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->job = job;
+        pool->arg = arg;
+        pool->job_num = num;
+        pool->next = 0;
+        pool->failed = 0;
+        pool->running = pool->num;
+        pool->generation += 1;
+        pthread_cond_broadcast(&pool->start);
+
+        /* join: every worker has left the cycle, so job and arg may go away */
+        while (pool->running > 0)
+                pthread_cond_wait(&pool->done, &pool->lock);
+        failed = pool->failed;
+        pthread_mutex_unlock(&pool->lock);
+
+        return failed ? -1 : 0;
+}
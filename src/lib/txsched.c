@@ -0,0 +1,186 @@
+/**
+ * @file   txsched.c
+ * @brief A library scheduling frame transmissions.
+ *
+ * A source file of a library that spread transmissions of network interfaces
+ * across an interval with random jitter, and cap frames per second of a host
+ * by a token bucket.
+ *
+ * @author Takashi OKADA
+ * @date 2026.10.18
+ * @version 0.1
+ * @copyright 2017 Takashi OKADA. All rights reserved.
+ *
+ * @par ChangeLog:
+ * - 2026.10.18: Takashi OKADA: Created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "txsched.h"
+
+/** A token is counted in 1/1000, so a token is refilled per 1000 / rate milliseconds */
+#define TXSCHED_TOKEN 1000
+
+/**
+ * @brief Get a random number.
+ * @param sched A pointer to a scheduler.
+ * @param max An upper bound, exclusive.
+ * @return A random number from 0 to max - 1, 0 if max is 0.
+ */
+static u_int64_t get_txsched_random(struct txsched *sched, u_int64_t max)
+{
+        u_int64_t r;
+
+        if (max == 0)
+                return 0;
+
+        /* RAND_MAX may be only 32767 */
+        r = ((u_int64_t) rand_r(&sched->seed) << 32) ^
+                ((u_int64_t) rand_r(&sched->seed) << 16) ^ (u_int64_t) rand_r(&sched->seed);
+
+        return r % max;
+}
+
+int init_txsched(struct txsched *sched, u_int64_t interval, u_int jitter,
+        u_int rate, u_int burst)
+{
+        struct timespec ts;
+
+        if (interval == 0 || jitter > 50 || burst == 0) {
+                fprintf(stderr, "txsched: invalid parameters: interval: %llu, jitter: %u, burst: %u\n",
+                        (unsigned long long) interval, jitter, burst);
+                return -1;
+        }
+
+        memset(sched, 0, sizeof(struct txsched));
+        sched->interval = interval;
+        sched->jitter = interval * jitter / 100;
+        sched->rate = rate;
+        sched->burst = burst;
+        sched->tokens = (u_int64_t) burst * TXSCHED_TOKEN;
+        sched->fast_count = TXSCHED_DEFAULT_FAST_COUNT;
+        sched->fast_interval = TXSCHED_DEFAULT_FAST_INTERVAL;
+        sched->max_interval = interval;
+
+        /* hosts booted together have the same uptime and often the same pid */
+        if (clock_gettime(CLOCK_REALTIME, &ts) == -1)
+                perror("clock_gettime");
+        sched->seed = (unsigned int) (ts.tv_nsec ^ ts.tv_sec ^ ((long) getpid() << 16));
+
+        return 0;
+}
+
+int set_txsched_fast(struct txsched *sched, u_int count, u_int64_t interval)
+{
+        if (count > TXSCHED_MAX_FAST_COUNT || (count > 0 && (interval == 0 || interval >= sched->interval))) {
+                fprintf(stderr, "txsched: invalid fast start: count: %u, interval: %llu\n",
+                        count, (unsigned long long) interval);
+                return -1;
+        }
+
+        sched->fast_count = count;
+        sched->fast_interval = interval;
+
+        return 0;
+}
+
+u_int get_txsched_fast_count(struct txsched *sched)
+{
+        return sched->fast_count;
+}
+
+u_int64_t get_txsched_fast_next(struct txsched *sched, u_int64_t now)
+{
+        u_int64_t jitter;
+
+        /* the same ratio of jitter as the interval */
+        jitter = sched->fast_interval * sched->jitter / sched->interval;
+
+        return now + sched->fast_interval - jitter + get_txsched_random(sched, jitter * 2 + 1);
+}
+
+int set_txsched_max_interval(struct txsched *sched, u_int64_t max_interval)
+{
+        if (max_interval < sched->interval) {
+                fprintf(stderr, "txsched: max interval: %llu is shorter than interval: %llu\n",
+                        (unsigned long long) max_interval, (unsigned long long) sched->interval);
+                return -1;
+        }
+
+        sched->max_interval = max_interval;
+
+        return 0;
+}
+
+u_int64_t get_txsched_interval(struct txsched *sched)
+{
+        return sched->interval;
+}
+
+u_int64_t stretch_txsched_interval(struct txsched *sched, u_int64_t interval)
+{
+        if (interval < sched->interval)
+                return sched->interval;
+
+        if (interval * 2 > sched->max_interval)
+                return sched->max_interval;
+
+        return interval * 2;
+}
+
+u_int64_t get_txsched_first(struct txsched *sched, u_int64_t now)
+{
+        return now + get_txsched_random(sched, sched->interval);
+}
+
+u_int64_t get_txsched_next(struct txsched *sched, u_int64_t prev, u_int64_t now)
+{
+        return get_txsched_next_interval(sched, sched->interval, prev, now);
+}
+
+u_int64_t get_txsched_next_interval(struct txsched *sched, u_int64_t interval,
+        u_int64_t prev, u_int64_t now)
+{
+        u_int64_t next, jitter;
+
+        /* the same ratio of jitter as the base interval */
+        jitter = interval * sched->jitter / sched->interval;
+
+        next = prev + interval - jitter + get_txsched_random(sched, jitter * 2 + 1);
+
+        if (next <= now)
+                return get_txsched_first(sched, now);
+
+        return next;
+}
+
+u_int64_t take_txsched_token(struct txsched *sched, u_int64_t now)
+{
+        u_int64_t max;
+
+        if (sched->rate == 0)
+                return 0;
+
+        max = (u_int64_t) sched->burst * TXSCHED_TOKEN;
+
+        if (now > sched->refilled) {
+                sched->tokens += (now - sched->refilled) * sched->rate;
+                if (sched->tokens > max)
+                        sched->tokens = max;
+                sched->refilled = now;
+        }
+
+        if (sched->tokens >= TXSCHED_TOKEN) {
+                sched->tokens -= TXSCHED_TOKEN;
+                return 0;
+        }
+
+        /* round up, so a caller sleeping for it gets a token */
+        return (TXSCHED_TOKEN - sched->tokens + sched->rate - 1) / sched->rate;
+}